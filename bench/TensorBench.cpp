@@ -0,0 +1,964 @@
+#include <chrono>
+#include <cstddef>
+#include <fmt/core.h>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "Affine.h"
+#include "Discrepancy.h"
+#include "DiscreteDistribution.h"
+#include "DynamicTensor.h"
+#include "Einsum.h"
+#include "Execution.h"
+#include "Factorization.h"
+#include "Matrix.h"
+#include "Parallel.h"
+#include "Quaternion.h"
+#include "Random.h"
+#include "Reduction.h"
+#include "Sample.h"
+#include "Simd.h"
+#include "Spectral.h"
+#include "TabulatedSampler1D.h"
+#include "Tensor.h"
+#include "TensorOperations.h"
+#include "TensorSoA.h"
+#include "ThreadPool.h"
+#include "Vector.h"
+
+// Times a * b + c on fixed size tensors through three evaluation strategies:
+//   broadcast  every operator materializes broadcast copies of its operands and a result tensor
+//   scalar     the fused expression evaluated element by element
+//   packet     the fused expression evaluated with gtk::simd packets, what assignment does
+//
+// Build in Release, with -march=native or /arch:AVX2 to measure the wider instruction sets.
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+// Keeps the compiler from hoisting the work out of the timing loop
+template<typename T>
+static void Clobber(T& value)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+  volatile auto sink = &value;
+  (void)sink;
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "r"(&value) : "memory");
+#endif
+}
+
+template<typename F>
+static double NanosecondsPerCall(F&& f, size_t iterations)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+template<typename TensorType, typename BinaryOp>
+static TensorType MaterializedOperation(const TensorType& a, const TensorType& b, BinaryOp op)
+{
+  using D = typename TensorType::DimensionType;
+  TensorType lhs = Broadcast<D>(a);
+  TensorType rhs = Broadcast<D>(b);
+  TensorType result;
+  for (size_t i = 0; i < D::count; ++i) {
+    result[i] = op(lhs[i], rhs[i]);
+  }
+  return result;
+}
+
+template<typename TensorType>
+static void Run(const char* name, size_t iterations)
+{
+  constexpr size_t count = TensorType::DimensionType::count;
+  TensorType a;
+  TensorType b;
+  TensorType c;
+  TensorType out;
+  for (size_t i = 0; i < count; ++i) {
+    a[i] = 1.0f + 0.001f * static_cast<float>(i);
+    b[i] = 2.0f - 0.001f * static_cast<float>(i);
+    c[i] = 0.5f;
+  }
+
+  double broadcast = NanosecondsPerCall(
+    [&]() {
+      Clobber(a);
+      auto product = MaterializedOperation(a, b, std::multiplies<>{});
+      out = MaterializedOperation(product, c, std::plus<>{});
+      Clobber(out);
+    },
+    iterations
+  );
+
+  double scalar = NanosecondsPerCall(
+    [&]() {
+      Clobber(a);
+      auto expr = a * b + c;
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = expr[i];
+      }
+      Clobber(out);
+    },
+    iterations
+  );
+
+  double packet = NanosecondsPerCall(
+    [&]() {
+      Clobber(a);
+      out = a * b + c;
+      Clobber(out);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "{:<20} broadcast {:8.2f} ns   scalar {:8.2f} ns   packet {:8.2f} ns   ({} wide)\n",
+    name,
+    broadcast,
+    scalar,
+    packet,
+    gtk::simd::PacketForCount<float, count>::width
+  );
+}
+
+// Normalizes arrays of vec3, one at a time, as an AoS batch and as an SoA batch
+static void RunNormalize(size_t count, size_t iterations)
+{
+  std::vector<Vector<float, 3>> v(count);
+  TensorSoA<Vector<float, 3>> soa(count);
+  for (size_t i = 0; i < count; ++i) {
+    float x = static_cast<float>(i);
+    v[i] = Vector<float, 3>(1.0f + x, 2.0f - x, 0.5f * x);
+    soa[i] = v[i];
+  }
+  std::vector<Vector<float, 3>> out(count);
+
+  double single = NanosecondsPerCall(
+    [&]() {
+      Clobber(v);
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = Normalize(v[i]);
+      }
+      Clobber(out);
+    },
+    iterations
+  );
+
+  double aos = NanosecondsPerCall(
+    [&]() {
+      Clobber(v);
+      NormalizeBatch(v.data(), count, out.data());
+      Clobber(out);
+    },
+    iterations
+  );
+
+  double soaTime = NanosecondsPerCall(
+    [&]() {
+      NormalizeBatch(soa);
+      Clobber(soa);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "Normalize {:<10} single {:8.2f} ns   AoS batch {:8.2f} ns   SoA batch {:8.2f} ns"
+    "   per vector\n",
+    count,
+    single / count,
+    aos / count,
+    soaTime / count
+  );
+}
+
+// Multiplies n x n matrices with the naive i-j-k loop and with Mul
+template<size_t n>
+static void RunMul(size_t iterations)
+{
+  // Heap allocated, the largest matrices would overflow the stack
+  auto a = std::make_unique<Matrix<float, n, n>>();
+  auto b = std::make_unique<Matrix<float, n, n>>();
+  auto out = std::make_unique<Matrix<float, n, n>>();
+  for (size_t i = 0; i < n * n; ++i) {
+    (*a)[i] = 1.0f + 0.001f * static_cast<float>(i % 97);
+    (*b)[i] = 2.0f - 0.001f * static_cast<float>(i % 89);
+  }
+
+  double naive = NanosecondsPerCall(
+    [&]() {
+      Clobber(*a);
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+          float sum = 0.0f;
+          for (size_t k = 0; k < n; ++k) {
+            sum += (*a)(i, k) * (*b)(k, j);
+          }
+          (*out)(i, j) = sum;
+        }
+      }
+      Clobber(*out);
+    },
+    iterations
+  );
+
+  double tiled = NanosecondsPerCall(
+    [&]() {
+      Clobber(*a);
+      *out = Mul(*a, *b);
+      Clobber(*out);
+    },
+    iterations
+  );
+
+  double flops = 2.0 * n * n * n;
+  fmt::print(
+    "Mul {:>3}x{:<3}          naive {:10.1f} ns   Mul {:10.1f} ns   ({:.2f} GFLOP/s)\n",
+    n,
+    n,
+    naive,
+    tiled,
+    flops / tiled
+  );
+}
+
+// Transforms a vertex buffer of vec3 one point at a time, as an AoS batch and as an SoA batch
+static void RunTransformPoints(size_t count, size_t iterations)
+{
+  std::vector<Vector<float, 3>> v(count);
+  TensorSoA<Vector<float, 3>> soa(count);
+  for (size_t i = 0; i < count; ++i) {
+    float x = static_cast<float>(i);
+    v[i] = Vector<float, 3>(1.0f + x, 2.0f - x, 0.5f * x);
+    soa[i] = v[i];
+  }
+  std::vector<Vector<float, 3>> out(count);
+  Affine3<float> a(Matrix<float, 3, 4>{0.8f, -0.6f, 0, 1, 0.6f, 0.8f, 0, 2, 0, 0, 1, 3});
+
+  double single = NanosecondsPerCall(
+    [&]() {
+      Clobber(v);
+      for (size_t i = 0; i < count; ++i) {
+        out[i] = TransformPoint(a, v[i]);
+      }
+      Clobber(out);
+    },
+    iterations
+  );
+
+  double aos = NanosecondsPerCall(
+    [&]() {
+      Clobber(v);
+      TransformPoints(a, v.data(), count, out.data());
+      Clobber(out);
+    },
+    iterations
+  );
+
+  double soaTime = NanosecondsPerCall(
+    [&]() {
+      TransformPoints(a, soa);
+      Clobber(soa);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "TransformPoints {:<6} single {:8.2f} ns   AoS batch {:8.2f} ns   SoA batch {:8.2f} ns"
+    "   per point\n",
+    count,
+    single / count,
+    aos / count,
+    soaTime / count
+  );
+}
+
+// Blends two poses of a skeleton joint by joint and rotates one bone vector per joint, with the
+// scalar functions and with the batches
+static void RunQuaternion(size_t count, size_t iterations)
+{
+  std::vector<Quaternion<float>> a(count);
+  std::vector<Quaternion<float>> b(count);
+  std::vector<Vector<float, 3>> bones(count);
+  for (size_t i = 0; i < count; ++i) {
+    float x = static_cast<float>(i);
+    a[i] = Normalize(Quaternion<float>(std::sin(x), std::cos(2 * x), 0.5f, std::cos(x)));
+    b[i] = Normalize(Quaternion<float>(std::cos(3 * x), 0.25f, std::sin(x), std::sin(2 * x)));
+    bones[i] = Vector<float, 3>(1.0f, 0.5f * x, -x);
+  }
+  std::vector<Quaternion<float>> pose(count);
+  std::vector<Vector<float, 3>> out(count);
+
+  auto time = [&](const auto& f) {
+    auto call = [&]() {
+      Clobber(a);
+      f();
+      Clobber(pose);
+      Clobber(out);
+    };
+    return NanosecondsPerCall(call, iterations) / count;
+  };
+  double slerp = time([&]() {
+    for (size_t i = 0; i < count; ++i) {
+      pose[i] = Slerp(a[i], b[i], 0.3f);
+    }
+  });
+  double fastSlerp = time([&]() {
+    for (size_t i = 0; i < count; ++i) {
+      pose[i] = FastSlerp(a[i], b[i], 0.3f);
+    }
+  });
+  double slerpBatch = time([&]() { SlerpBatch(a.data(), b.data(), 0.3f, count, pose.data()); });
+  double nlerpBatch = time([&]() { NlerpBatch(a.data(), b.data(), 0.3f, count, pose.data()); });
+  double rotate = time([&]() {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = Rotate(a[i], bones[i]);
+    }
+  });
+  double rotateBatch = time([&]() { RotateBatch(a.data(), bones.data(), count, out.data()); });
+
+  fmt::print(
+    "Quaternion {:<6} Slerp {:6.2f} ns   FastSlerp {:6.2f} ns   SlerpBatch {:6.2f} ns"
+    "   NlerpBatch {:6.2f} ns   Rotate {:6.2f} ns   RotateBatch {:6.2f} ns   per joint\n",
+    count,
+    slerp,
+    fastSlerp,
+    slerpBatch,
+    nlerpBatch,
+    rotate,
+    rotateBatch
+  );
+}
+
+// Draws uniform doubles and floats one at a time: the mt19937 and uniform_real_distribution that
+// SampleUniform1D used to go through, SampleUniform1D on the thread stream and every engine. Then
+// in bulk with FillUniform.
+static void RunRandom(size_t count, size_t iterations)
+{
+  std::vector<double> doubles(count);
+  std::vector<float> floats(count);
+  auto rate = [&](const auto& fill) {
+    auto call = [&]() {
+      fill();
+      Clobber(doubles);
+      Clobber(floats);
+    };
+    return 1e3 / (NanosecondsPerCall(call, iterations) / count);
+  };
+  auto engineRates = [&](auto engine) {
+    double d = rate([&]() {
+      for (double& x : doubles) {
+        x = UniformDouble(engine);
+      }
+    });
+    double f = rate([&]() {
+      for (float& x : floats) {
+        x = UniformFloat(engine);
+      }
+    });
+    return std::make_pair(d, f);
+  };
+
+  std::mt19937 mt{1};
+  std::uniform_real_distribution<double> distribution(0., 1.);
+  double mtRate = rate([&]() {
+    for (double& x : doubles) {
+      x = distribution(mt);
+    }
+  });
+  double sampleRate = rate([&]() {
+    for (double& x : doubles) {
+      x = SampleUniform1D();
+    }
+  });
+  auto [xoshiroDouble, xoshiroFloat] = engineRates(Xoshiro256PlusPlus(1));
+  auto [pcgDouble, pcgFloat] = engineRates(Pcg32(1));
+  auto [philoxDouble, philoxFloat] = engineRates(Philox4x32(1));
+
+  Xoshiro256PlusPlus rng(1);
+  Xoshiro256PlusPlusLanes<8> lanes(1);
+  double fillDouble = rate([&]() { FillUniform(doubles.data(), count, 0., 1., rng); });
+  double fillFloat = rate([&]() { FillUniform(floats.data(), count, 0.f, 1.f, rng); });
+  double lanesDouble = rate([&]() { FillUniform(doubles.data(), count, 0., 1., lanes); });
+  double lanesFloat = rate([&]() { FillUniform(floats.data(), count, 0.f, 1.f, lanes); });
+
+  fmt::print(
+    "Random     mt19937 {:6.1f}   SampleUniform1D {:6.1f}   Msamples/s\n"
+    "  double   xoshiro256++ {:6.1f}   PCG32 {:6.1f}   Philox4x32 {:6.1f}   Msamples/s\n"
+    "  float    xoshiro256++ {:6.1f}   PCG32 {:6.1f}   Philox4x32 {:6.1f}   Msamples/s\n"
+    "  FillUniform  xoshiro256++ {:6.1f} / {:6.1f}   8 lanes {:6.1f} / {:6.1f}"
+    "   Msamples/s double / float\n",
+    mtRate,
+    sampleRate,
+    xoshiroDouble,
+    pcgDouble,
+    philoxDouble,
+    xoshiroFloat,
+    pcgFloat,
+    philoxFloat,
+    fillDouble,
+    fillFloat,
+    lanesDouble,
+    lanesFloat
+  );
+}
+
+// Picks lights among count emitters of very uneven power with std::discrete_distribution, which
+// bisects a CDF, and with the alias table, and times building the table
+static void RunDiscrete(size_t count, size_t samples, size_t iterations)
+{
+  std::vector<double> power(count);
+  for (size_t i = 0; i < count; ++i) {
+    power[i] = 1.0 + static_cast<double>((i * 7919) % 1000) * (i % 97 == 0 ? 100.0 : 1.0);
+  }
+  std::vector<size_t> picks(samples);
+
+  std::mt19937_64 mt{1};
+  std::discrete_distribution<size_t> cdf(power.begin(), power.end());
+  double cdfTime = NanosecondsPerCall(
+    [&]() {
+      for (size_t& pick : picks) {
+        pick = cdf(mt);
+      }
+      Clobber(picks);
+    },
+    iterations
+  );
+
+  DiscreteDistribution lights(power);
+  Rng rng(1);
+  double aliasTime = NanosecondsPerCall(
+    [&]() {
+      lights.SampleBatch(picks.data(), samples, rng);
+      Clobber(picks);
+    },
+    iterations
+  );
+
+  double rebuildTime = NanosecondsPerCall(
+    [&]() {
+      lights.SetWeight(0, lights.Weight(0) + 1.0);
+      lights.Rebuild();
+    },
+    iterations
+  );
+
+  fmt::print(
+    "Discrete {:<7} std::discrete_distribution {:6.2f} ns   alias table {:6.2f} ns   per sample"
+    "   Rebuild {:8.1f} us\n",
+    count,
+    cdfTime / samples,
+    aliasTime / samples,
+    rebuildTime / 1e3
+  );
+}
+
+// Normal density of deviation sigma on [-1, 1], a peak in a wide domain
+struct PeakDistribution : public ProbabilityDensityFunction1D {
+  explicit PeakDistribution(double sigma)
+      : ProbabilityDensityFunction1D(-1.0, 1.0, 0.0),
+        normal(0.0, sigma)
+  {
+  }
+
+  double operator()(double x) const override { return normal(x); }
+
+  NormalDistribution normal;
+};
+
+// Samples a narrow peak by rejection and from tables of several resolutions, one at a time and in
+// batches from the lanes engine, and times building the tables
+static void RunTabulated(size_t samples, size_t iterations)
+{
+  PeakDistribution peak(0.01);
+  std::vector<double> x(samples);
+  Rng rng(1);
+  Xoshiro256PlusPlusLanes<8> lanes(1);
+
+  double rejection = NanosecondsPerCall(
+    [&]() {
+      for (double& v : x) {
+        v = Sample1D(rng, peak);
+      }
+      Clobber(x);
+    },
+    iterations
+  );
+  fmt::print("Tabulated  RejectionSample1D {:8.2f} ns per sample\n", rejection / samples);
+
+  for (size_t resolution : {256, 4096, 65536}) {
+    double build = NanosecondsPerCall(
+      [&]() {
+        TabulatedSampler1D sampler(peak, resolution);
+        Clobber(sampler);
+      },
+      iterations
+    );
+    TabulatedSampler1D sampler(peak, resolution);
+    double single = NanosecondsPerCall(
+      [&]() {
+        for (double& v : x) {
+          v = sampler.Sample(rng);
+        }
+        Clobber(x);
+      },
+      iterations
+    );
+    double batch = NanosecondsPerCall(
+      [&]() {
+        sampler.SampleBatch(x.data(), samples, lanes);
+        Clobber(x);
+      },
+      iterations
+    );
+    fmt::print(
+      "  {:<6} bins   Sample {:6.2f} ns   SampleBatch {:6.2f} ns   per sample   build {:8.1f} us\n",
+      resolution,
+      single / samples,
+      batch / samples,
+      build / 1e3
+    );
+  }
+}
+
+// Solves n x n systems for k right hand sides, refactoring for every vector and factoring once
+static void RunSolve(size_t n, size_t k, size_t iterations)
+{
+  DynamicTensor<double> a({n, n});
+  DynamicTensor<double> b({n, k});
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      a(i, j) = i == j ? static_cast<double>(n) : 1.0 / static_cast<double>(i + 2 * j + 1);
+    }
+  }
+  for (size_t i = 0; i < b.Count(); ++i) {
+    b[i] = static_cast<double>(i % 13);
+  }
+  DynamicTensor<double> column({n});
+
+  double refactor = NanosecondsPerCall(
+    [&]() {
+      for (size_t c = 0; c < k; ++c) {
+        for (size_t i = 0; i < n; ++i) {
+          column[i] = b(i, c);
+        }
+        DynamicTensor<double> x = LU(a).Solve(column);
+        Clobber(x);
+      }
+    },
+    iterations
+  );
+
+  double batch = NanosecondsPerCall(
+    [&]() {
+      DynamicTensor<double> x = LU(a).Solve(b);
+      Clobber(x);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "LU solve {:>3}x{:<3} {:>5} rhs   refactor {:10.1f} us   factor once {:10.1f} us\n",
+    n,
+    n,
+    k,
+    refactor / 1000.0,
+    batch / 1000.0
+  );
+}
+
+// Decomposes a batch of symmetric 3x3 covariance like matrices
+static void RunSpectral(size_t count, size_t iterations)
+{
+  std::vector<Matrix<float, 3, 3>> m(count);
+  for (size_t i = 0; i < count; ++i) {
+    float x = 0.001f * static_cast<float>(i);
+    m[i] = Matrix<float, 3, 3>(4.0f + x, 1.0f, -x, 1.0f, 3.0f, 0.5f, -x, 0.5f, 5.0f - x);
+  }
+  std::vector<SymmetricEigen3<float>> eigen(count);
+  std::vector<SingularValueDecomposition<float, 3>> svd(count);
+
+  double eigenTime = NanosecondsPerCall(
+    [&]() {
+      EigenBatch(m.data(), count, eigen.data());
+      Clobber(eigen);
+    },
+    iterations
+  );
+
+  double svdTime = NanosecondsPerCall(
+    [&]() {
+      SvdBatch(m.data(), count, svd.data());
+      Clobber(svd);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "Eigen 3x3 {:8.1f} ns ({:.1f} M/s)   Svd 3x3 {:8.1f} ns ({:.1f} M/s)\n",
+    eigenTime / count,
+    1e3 * count / eigenTime,
+    svdTime / count,
+    1e3 * count / svdTime
+  );
+}
+
+// Naive row by row transpose against the recursive tiled one, and AoS to SoA conversion by
+// PushBack against the bulk transpose
+static void RunTranspose(size_t n, size_t count, size_t iterations)
+{
+  DynamicTensor<float> m({n, n});
+  for (size_t i = 0; i < n * n; ++i) {
+    m[i] = static_cast<float>(i);
+  }
+  DynamicTensor<float> t({n, n});
+
+  double naiveTime = NanosecondsPerCall(
+    [&]() {
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+          t[j * n + i] = m[i * n + j];
+        }
+      }
+      Clobber(t);
+    },
+    iterations
+  );
+
+  double tiledTime = NanosecondsPerCall(
+    [&]() {
+      TransposeInto(m.Data(), n, n, n, t.Data(), n);
+      Clobber(t);
+    },
+    iterations
+  );
+
+  double inPlaceTime = NanosecondsPerCall(
+    [&]() {
+      TransposeInPlace(m);
+      Clobber(m);
+    },
+    iterations
+  );
+
+  std::vector<Vector<float, 4>> vertices(count);
+  for (size_t i = 0; i < count; ++i) {
+    vertices[i] = Vector<float, 4>(static_cast<float>(i), 1.0f, 2.0f, 3.0f);
+  }
+
+  double pushTime = NanosecondsPerCall(
+    [&]() {
+      TensorSoA<Vector<float, 4>> soa;
+      soa.Reserve(count);
+      for (const auto& v : vertices) {
+        soa.PushBack(v);
+      }
+      Clobber(soa);
+    },
+    iterations
+  );
+
+  double bulkTime = NanosecondsPerCall(
+    [&]() {
+      TensorSoA<Vector<float, 4>> soa(vertices.data(), count);
+      Clobber(soa);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "Transpose {}x{}  naive {:8.2f} ms  tiled {:8.2f} ms ({:.1f}x)  in place {:8.2f} ms\n",
+    n,
+    n,
+    naiveTime * 1e-6,
+    tiledTime * 1e-6,
+    naiveTime / tiledTime,
+    inPlaceTime * 1e-6
+  );
+  fmt::print(
+    "AoS to SoA {} Vector4  PushBack {:8.2f} ms  transpose {:8.2f} ms ({:.1f}x)\n",
+    count,
+    pushTime * 1e-6,
+    bulkTime * 1e-6,
+    pushTime / bulkTime
+  );
+}
+
+static constexpr char batchMatVec[] = "bij,bj->bi";
+
+// Batch of 4x4 matrix vector products through Einsum against the hand written loops
+template<size_t count>
+static void RunEinsum(size_t iterations)
+{
+  auto m = std::make_unique<Tensor<float, count, 4, 4>>();
+  auto v = std::make_unique<Tensor<float, count, 4>>();
+  auto out = std::make_unique<Tensor<float, count, 4>>();
+  for (size_t i = 0; i < count * 16; ++i) {
+    (*m)[i] = static_cast<float>(i % 7);
+  }
+  for (size_t i = 0; i < count * 4; ++i) {
+    (*v)[i] = static_cast<float>(i % 5);
+  }
+
+  double handTime = NanosecondsPerCall(
+    [&]() {
+      for (size_t b = 0; b < count; ++b) {
+        for (size_t i = 0; i < 4; ++i) {
+          float sum = 0.0f;
+          for (size_t j = 0; j < 4; ++j) {
+            sum += (*m)(b, i, j) * (*v)(b, j);
+          }
+          (*out)(b, i) = sum;
+        }
+      }
+      Clobber(*out);
+    },
+    iterations
+  );
+
+  double einsumTime = NanosecondsPerCall(
+    [&]() {
+      *out = Einsum<batchMatVec>(*m, *v);
+      Clobber(*out);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "Einsum {} bij,bj->bi  hand {:8.2f} us  einsum {:8.2f} us ({:.2f}x)\n",
+    count,
+    handTime * 1e-3,
+    einsumTime * 1e-3,
+    handTime / einsumTime
+  );
+}
+
+// Frame statistics, a running sum against the pairwise one and per column sums of an image
+template<size_t rows, size_t cols>
+static void RunReduce(size_t iterations)
+{
+  auto image = std::make_unique<Tensor<float, rows, cols>>();
+  for (size_t i = 0; i < rows * cols; ++i) {
+    (*image)[i] = static_cast<float>(i % 255) / 255.0f;
+  }
+  float total = 0.0f;
+  Tensor<float, cols> columns;
+
+  double runningTime = NanosecondsPerCall(
+    [&]() {
+      total = std::accumulate(image->begin(), image->end(), 0.0f);
+      Clobber(total);
+    },
+    iterations
+  );
+
+  double pairwiseTime = NanosecondsPerCall(
+    [&]() {
+      total = Sum(*image);
+      Clobber(total);
+    },
+    iterations
+  );
+
+  double columnTime = NanosecondsPerCall(
+    [&]() {
+      columns = Sum<0>(*image);
+      Clobber(columns);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "Sum {}x{}  running {:8.2f} us  pairwise {:8.2f} us ({:.1f}x)  columns {:8.2f} us\n",
+    rows,
+    cols,
+    runningTime * 1e-3,
+    pairwiseTime * 1e-3,
+    runningTime / pairwiseTime,
+    columnTime * 1e-3
+  );
+}
+
+// A post processing pass over a 4K frame and a large product, on the calling thread and on the
+// default thread pool
+static void RunParallel(size_t iterations)
+{
+  DynamicTensor<float> frame({2160, 3840, 4});
+  for (size_t i = 0; i < frame.Count(); ++i) {
+    frame[i] = static_cast<float>(i % 255) / 255.0f;
+  }
+  DynamicTensor<float> exposure({4}, 1.5f);
+  DynamicTensor<float> out(frame.Shape());
+
+  double seqTime = NanosecondsPerCall(
+    [&]() {
+      Assign(gtk::exec::seq, out, frame * exposure + 0.01f);
+      Clobber(out);
+    },
+    iterations
+  );
+
+  double parTime = NanosecondsPerCall(
+    [&]() {
+      Assign(gtk::exec::par, out, frame * exposure + 0.01f);
+      Clobber(out);
+    },
+    iterations
+  );
+
+  DynamicTensor<float> a({1024, 1024}, 0.5f);
+  DynamicTensor<float> c;
+  double mulSeqTime = NanosecondsPerCall(
+    [&]() {
+      c = Mul(gtk::exec::seq, a, a);
+      Clobber(c);
+    },
+    iterations
+  );
+
+  double mulParTime = NanosecondsPerCall(
+    [&]() {
+      c = Mul(gtk::exec::par, a, a);
+      Clobber(c);
+    },
+    iterations
+  );
+
+  fmt::print(
+    "{} threads  frame seq {:8.2f} ms  par {:8.2f} ms ({:.1f}x)  Mul 1024 seq {:8.2f} ms  "
+    "par {:8.2f} ms ({:.1f}x)\n",
+    gtk::ThreadPool::Default().Concurrency(),
+    seqTime * 1e-6,
+    parTime * 1e-6,
+    seqTime / parTime,
+    mulSeqTime * 1e-6,
+    mulParTime * 1e-6,
+    mulSeqTime / mulParTime
+  );
+}
+
+// Scaling of the scheduler from one thread to every hardware thread: a batch of 3x3 eigen
+// decompositions and a van der Corput sequence through ParallelFor, a float sum through
+// ParallelReduce
+static void RunScaling(size_t iterations)
+{
+  std::vector<Matrix<float, 3, 3>> m(1 << 18);
+  for (size_t i = 0; i < m.size(); ++i) {
+    float x = 1e-5f * static_cast<float>(i);
+    m[i] = Matrix<float, 3, 3>(4.0f + x, 1.0f, -x, 1.0f, 3.0f, 0.5f, -x, 0.5f, 5.0f - x);
+  }
+  std::vector<SymmetricEigen3<float>> eigen(m.size());
+  std::vector<double> sequence(1 << 22);
+  std::vector<float> values(1 << 26, 0.5f);
+
+  size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  double eigenBase = 0.0, corputBase = 0.0, sumBase = 0.0;
+  for (size_t threads = 1; threads <= maxThreads; ++threads) {
+    gtk::ThreadPool pool{threads - 1};
+
+    double eigenTime = NanosecondsPerCall(
+      [&]() {
+        gtk::ParallelFor(
+          0,
+          m.size(),
+          1024,
+          [&](size_t first, size_t last) {
+            EigenBatch(m.data() + first, last - first, eigen.data() + first);
+          },
+          pool
+        );
+        Clobber(eigen);
+      },
+      iterations
+    );
+
+    double corputTime = NanosecondsPerCall(
+      [&]() {
+        gtk::ParallelFor(
+          0,
+          sequence.size(),
+          4096,
+          [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+              sequence[i] = Corput(i + 1, 2);
+            }
+          },
+          pool
+        );
+        Clobber(sequence);
+      },
+      iterations
+    );
+
+    float sum = 0.0f;
+    double sumTime = NanosecondsPerCall(
+      [&]() {
+        sum = gtk::ParallelReduce(
+          0,
+          values.size(),
+          1 << 16,
+          0.0f,
+          [&](size_t first, size_t last) {
+            return std::accumulate(values.data() + first, values.data() + last, 0.0f);
+          },
+          std::plus<>{},
+          pool
+        );
+        Clobber(sum);
+      },
+      iterations
+    );
+
+    if (threads == 1) {
+      eigenBase = eigenTime;
+      corputBase = corputTime;
+      sumBase = sumTime;
+    }
+    fmt::print(
+      "{:3} threads  Eigen batch {:8.2f} ms ({:4.1f}x)  Corput {:8.2f} ms ({:4.1f}x)  "
+      "Sum {:8.2f} ms ({:4.1f}x)\n",
+      threads,
+      eigenTime * 1e-6,
+      eigenBase / eigenTime,
+      corputTime * 1e-6,
+      corputBase / corputTime,
+      sumTime * 1e-6,
+      sumBase / sumTime
+    );
+  }
+}
+
+int main()
+{
+  Run<Tensor<float, 4>>("Tensor<float, 4>", 50'000'000);
+  Run<Tensor<float, 4, 4>>("Tensor<float, 4, 4>", 20'000'000);
+  Run<Tensor<float, 1024>>("Tensor<float, 1024>", 500'000);
+  RunNormalize(1 << 16, 2'000);
+  RunMul<4>(20'000'000);
+  RunMul<16>(200'000);
+  RunMul<64>(5'000);
+  RunMul<256>(50);
+  RunTransformPoints(1 << 16, 2'000);
+  RunQuaternion(1 << 15, 1'000);
+  RunRandom(1 << 16, 200);
+  RunDiscrete(100'000, 1 << 20, 10);
+  RunTabulated(1 << 20, 10);
+  RunSolve(64, 4096, 5);
+  RunSpectral(1 << 14, 20);
+  RunTranspose(4096, 1 << 20, 10);
+  RunEinsum<4096>(2'000);
+  RunReduce<1080, 1920>(100);
+  RunParallel(10);
+  RunScaling(10);
+}
\ No newline at end of file
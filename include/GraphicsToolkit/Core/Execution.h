@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+#include "Parallel.h"
+#include "ThreadPool.h"
+
+// Execution policies of the operations on large tensors
+//
+//   seq        runs on the calling thread, exactly like the overload without a policy
+//   par        splits the work in chunks run by ParallelFor on ThreadPool::Default()
+//   par_unseq  same as par, chunks are vectorized with gtk::simd packets under every policy
+//
+// Work smaller than the threshold of a parallel policy runs on the calling thread, scheduling a
+// few microseconds of work costs more than it saves. The threshold counts elements, or multiply
+// adds for products, and defaults to defaultParallelThreshold:
+//   Assign(gtk::exec::par, out, a * b + c);
+//   auto c = Mul(gtk::exec::ParallelPolicy{1 << 20}, a, b);
+
+namespace gtk::exec
+{
+
+inline constexpr size_t defaultParallelThreshold = size_t{1} << 16;
+
+struct SequencedPolicy {
+};
+
+struct ParallelPolicy {
+  size_t threshold = defaultParallelThreshold;
+};
+
+struct ParallelUnsequencedPolicy {
+  size_t threshold = defaultParallelThreshold;
+};
+
+inline constexpr SequencedPolicy seq{};
+inline constexpr ParallelPolicy par{};
+inline constexpr ParallelUnsequencedPolicy par_unseq{};
+
+template<typename T>
+struct IsExecutionPolicy {
+  static constexpr bool value = false;
+};
+
+template<>
+struct IsExecutionPolicy<SequencedPolicy> {
+  static constexpr bool value = true;
+};
+
+template<>
+struct IsExecutionPolicy<ParallelPolicy> {
+  static constexpr bool value = true;
+};
+
+template<>
+struct IsExecutionPolicy<ParallelUnsequencedPolicy> {
+  static constexpr bool value = true;
+};
+
+template<typename T>
+inline constexpr bool IsExecutionPolicyV = IsExecutionPolicy<std::decay_t<T>>::value;
+
+// Chunks per thread, so threads finishing early steal the remaining ones
+inline constexpr size_t chunksPerThread = 4;
+
+// Calls f(first, last) on consecutive ranges covering [0, count), each item costing cost units of
+// the threshold. The ranges are run in parallel unless the policy is seq or the total cost is
+// below the threshold, a single call covers everything then.
+template<typename Policy, typename F>
+void ForEachChunk(const Policy& policy, size_t count, size_t cost, const F& f)
+{
+  static_assert(IsExecutionPolicyV<Policy>, "ForEachChunk requires an execution policy.");
+  if (count == 0) {
+    return;
+  }
+  if constexpr (!std::is_same_v<Policy, SequencedPolicy>) {
+    size_t threshold = std::max<size_t>(policy.threshold, 1);
+    size_t work = count * std::max<size_t>(cost, 1);
+    ThreadPool& pool = ThreadPool::Default();
+    if (work >= threshold && pool.Concurrency() > 1) {
+      // No chunk below the threshold, no more than chunksPerThread per thread
+      size_t chunks = std::min(work / threshold, pool.Concurrency() * chunksPerThread);
+      chunks = std::clamp<size_t>(chunks, 1, count);
+      ParallelFor(0, count, (count + chunks - 1) / chunks, f, pool);
+      return;
+    }
+  }
+  f(size_t{0}, count);
+}
+
+}  // namespace gtk::exec
\ No newline at end of file
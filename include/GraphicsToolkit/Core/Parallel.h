@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// Loops over index ranges on a ThreadPool
+//
+//   ParallelFor     calls f(first, last) on the blocks of grain indices covering a range
+//   ParallelReduce  maps every block to a value and combines the values pairwise
+//
+// Blocks are grain aligned from the start of the range whatever the number of threads, so the
+// blocks and the order ParallelReduce combines them in only depend on the range and the grain:
+// a floating point reduction gives the same result on one core or on sixty four. The grain should
+// hold a few microseconds of work at least, queuing a block costs about a microsecond.
+
+namespace gtk
+{
+
+// Number of blocks of grain indices covering count indices
+inline size_t BlockCount(size_t count, size_t grain)
+{
+  grain = std::max<size_t>(grain, 1);
+  return (count + grain - 1) / grain;
+}
+
+template<typename F>
+void ParallelFor(
+  size_t first,
+  size_t last,
+  size_t grain,
+  const F& f,
+  ThreadPool& pool = ThreadPool::Default()
+)
+{
+  if (first >= last) {
+    return;
+  }
+  grain = std::max<size_t>(grain, 1);
+  auto block = [&](size_t b) {
+    size_t begin = first + b * grain;
+    f(begin, std::min(begin + grain, last));
+  };
+  pool.Run(BlockCount(last - first, grain), block);
+}
+
+// combine(map(block 0), map(block 1)) and so on, in a balanced tree of the block values. Returns
+// identity for an empty range, combine need not accept it otherwise.
+template<typename T, typename Map, typename Combine>
+T ParallelReduce(
+  size_t first,
+  size_t last,
+  size_t grain,
+  const T& identity,
+  const Map& map,
+  const Combine& combine,
+  ThreadPool& pool = ThreadPool::Default()
+)
+{
+  if (first >= last) {
+    return identity;
+  }
+  grain = std::max<size_t>(grain, 1);
+  std::vector<T> values(BlockCount(last - first, grain), identity);
+  pool.Run(values.size(), [&](size_t b) {
+    size_t begin = first + b * grain;
+    values[b] = map(begin, std::min(begin + grain, last));
+  });
+
+  for (size_t step = 1; step < values.size(); step *= 2) {
+    for (size_t i = 0; i + step < values.size(); i += 2 * step) {
+      values[i] = combine(values[i], values[i + step]);
+    }
+  }
+  return values[0];
+}
+
+}  // namespace gtk
\ No newline at end of file
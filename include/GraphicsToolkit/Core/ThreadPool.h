@@ -0,0 +1,364 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+namespace gtk
+{
+
+class TaskGroup;
+
+// Work stealing scheduler, a fixed set of worker threads running the tasks of TaskGroups
+//
+// Every worker owns a Chase-Lev deque. Tasks spawned by a worker go to the bottom of its deque and
+// it takes them back newest first, so it keeps working on the data it just touched; an idle
+// worker steals the oldest task of another deque, usually the largest piece of work left. Tasks
+// spawned by other threads go through a shared injection queue. A thread waiting on a TaskGroup
+// runs queued tasks until the group is done, so tasks may spawn and wait on nested groups without
+// starving the pool. Idle threads sleep until a task is queued.
+class ThreadPool
+{
+public:
+  explicit ThreadPool(size_t workerCount = DefaultWorkerCount())
+  {
+    deques.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+      deques.push_back(std::make_unique<WorkStealingDeque<Task*>>());
+    }
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+      workers.emplace_back([this, i]() { Work(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock{sleepMutex};
+      stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+  }
+
+  // One worker per hardware thread besides the one waiting on the work
+  static size_t DefaultWorkerCount()
+  {
+    unsigned int threads = std::thread::hardware_concurrency();
+    return threads > 1 ? threads - 1 : 0;
+  }
+
+  // Shared by every parallel algorithm of the toolkit, started on first use
+  static ThreadPool& Default()
+  {
+    static ThreadPool pool;
+    return pool;
+  }
+
+  size_t WorkerCount() const { return workers.size(); }
+
+  // Threads running the tasks of a group, the workers and the thread waiting on it
+  size_t Concurrency() const { return workers.size() + 1; }
+
+  // Calls f(i) for i in [0, count) and returns once every call returned. The first exception
+  // thrown by a call is rethrown here after the others finished.
+  template<typename F>
+  void Run(size_t count, const F& f);
+
+private:
+  friend class TaskGroup;
+
+  using Task = std::function<void()>;
+
+  struct CurrentWorker {
+    const ThreadPool* pool = nullptr;
+    size_t index = 0;
+  };
+
+  static CurrentWorker& Current()
+  {
+    static thread_local CurrentWorker current;
+    return current;
+  }
+
+  // Deque of the calling thread, deques.size() for threads that are not workers of this pool
+  size_t Self() const
+  {
+    const CurrentWorker& current = Current();
+    return current.pool == this ? current.index : deques.size();
+  }
+
+  void Submit(Task task)
+  {
+    auto owned = std::make_unique<Task>(std::move(task));
+    // Counted first, so queued never drops below the tasks really queued
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    size_t self = Self();
+    if (self < deques.size()) {
+      deques[self]->Push(owned.release());
+    } else {
+      std::lock_guard<std::mutex> lock{injectionMutex};
+      injection.push_back(owned.release());
+    }
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+      { std::lock_guard<std::mutex> lock{sleepMutex}; }
+      wake.notify_one();
+    }
+  }
+
+  // Newest task of deque self, else the oldest of another deque or of the injection queue
+  Task* Take(size_t self)
+  {
+    Task* task = nullptr;
+    size_t n = deques.size();
+    if (self < n && deques[self]->Pop(task)) {
+      return Taken(task);
+    }
+    for (size_t k = 1; k <= n; ++k) {
+      if (deques[(self + k) % n]->Steal(task)) {
+        return Taken(task);
+      }
+    }
+    std::lock_guard<std::mutex> lock{injectionMutex};
+    if (!injection.empty()) {
+      task = injection.front();
+      injection.pop_front();
+      return Taken(task);
+    }
+    return nullptr;
+  }
+
+  Task* Taken(Task* task)
+  {
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+  }
+
+  // Tasks are wrapped by their group and never throw
+  static void Execute(Task* task)
+  {
+    std::unique_ptr<Task> owned{task};
+    (*owned)();
+  }
+
+  // Sleeps until done() holds, a task is queued or the pool stops
+  template<typename Done>
+  void Park(const Done& done)
+  {
+    std::unique_lock<std::mutex> lock{sleepMutex};
+    sleeping.fetch_add(1, std::memory_order_seq_cst);
+    wake.wait(lock, [&]() {
+      return done() || stopping || queued.load(std::memory_order_seq_cst) > 0;
+    });
+    sleeping.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Wakes the threads parked on a group that just finished
+  void WakeAll()
+  {
+    { std::lock_guard<std::mutex> lock{sleepMutex}; }
+    wake.notify_all();
+  }
+
+  void Work(size_t self)
+  {
+    Current() = {this, self};
+    for (;;) {
+      if (Task* task = Take(self)) {
+        Execute(task);
+        continue;
+      }
+      Park([]() { return false; });
+      std::lock_guard<std::mutex> lock{sleepMutex};
+      if (stopping && queued.load(std::memory_order_relaxed) == 0) {
+        return;
+      }
+    }
+  }
+
+  std::vector<std::unique_ptr<WorkStealingDeque<Task*>>> deques;
+  std::vector<std::thread> workers;
+
+  std::mutex injectionMutex;
+  std::deque<Task*> injection;
+
+  // Tasks queued and not taken yet, idle threads park while there are none
+  std::atomic<size_t> queued{0};
+  std::atomic<size_t> sleeping{0};
+  std::mutex sleepMutex;
+  std::condition_variable wake;
+  bool stopping = false;
+};
+
+// Tasks run by a ThreadPool and waited on together
+//
+// Run queues a task, Wait runs queued tasks on the calling thread until every task of the group
+// finished and rethrows the first exception one of them threw. Then registers a continuation,
+// queued as soon as no task of the group is running, and Wait waits for it too. Tasks may Run
+// more tasks of their group. The destructor waits but drops the exceptions, callers that care
+// call Wait.
+//   TaskGroup group;
+//   group.Run([&]() { x = CorputSequence(n, 2); });
+//   group.Run([&]() { y = CorputSequence(n, 3); });
+//   group.Then([&]() { points = Zip(x, y); });
+//   group.Wait();
+class TaskGroup
+{
+public:
+  explicit TaskGroup(ThreadPool& pool = ThreadPool::Default()) : pool{pool} {}
+
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  ~TaskGroup() { Help(); }
+
+  // f is copied into the task
+  template<typename F>
+  void Run(F&& f)
+  {
+    remaining.fetch_add(1, std::memory_order_relaxed);
+    running.fetch_add(1, std::memory_order_relaxed);
+    pool.Submit([this, task = std::forward<F>(f)]() mutable {
+      Invoke(task);
+      if (running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        Continue();
+      }
+      Release();
+    });
+  }
+
+  // Continuations registered before the running tasks finish run after them, in order
+  template<typename F>
+  void Then(F&& f)
+  {
+    remaining.fetch_add(1, std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock{mutex};
+    continuations.emplace_back(std::forward<F>(f));
+    if (running.load(std::memory_order_acquire) == 0) {
+      lock.unlock();
+      Continue();
+    }
+  }
+
+  void Wait()
+  {
+    Help();
+    std::exception_ptr first;
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      std::swap(first, error);
+    }
+    if (first) {
+      std::rethrow_exception(first);
+    }
+  }
+
+private:
+  template<typename F>
+  void Invoke(F& f)
+  {
+    try {
+      f();
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{mutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  }
+
+  // Queues the registered continuations, they count in remaining since Then
+  void Continue()
+  {
+    std::vector<std::function<void()>> next;
+    {
+      std::lock_guard<std::mutex> lock{mutex};
+      next.swap(continuations);
+    }
+    if (next.empty()) {
+      return;
+    }
+    pool.Submit([this, next = std::move(next)]() mutable {
+      for (auto& continuation : next) {
+        Invoke(continuation);
+        Release();
+      }
+    });
+  }
+
+  void Release()
+  {
+    // The group may be destroyed as soon as remaining drops to zero
+    ThreadPool& owner = pool;
+    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      owner.WakeAll();
+    }
+  }
+
+  // Runs queued tasks, any group's, until this group is done
+  void Help()
+  {
+    size_t self = pool.Self();
+    auto done = [this]() { return remaining.load(std::memory_order_acquire) == 0; };
+    while (!done()) {
+      if (ThreadPool::Task* task = pool.Take(self)) {
+        ThreadPool::Execute(task);
+      } else {
+        pool.Park(done);
+      }
+    }
+  }
+
+  ThreadPool& pool;
+  // Tasks and continuations not finished yet
+  std::atomic<size_t> remaining{0};
+  // Tasks not finished yet, continuations are queued when it drops to zero
+  std::atomic<size_t> running{0};
+  std::mutex mutex;
+  std::vector<std::function<void()>> continuations;
+  std::exception_ptr error;
+};
+
+template<typename F>
+void ThreadPool::Run(size_t count, const F& f)
+{
+  if (workers.empty() || count < 2) {
+    for (size_t i = 0; i < count; ++i) {
+      f(i);
+    }
+    return;
+  }
+
+  // The upper half of a range is queued until single calls remain, thieves take the large halves
+  // and split them further, the caller keeps the lower ones
+  TaskGroup group{*this};
+  auto split = [&group, &f](size_t first, size_t last, const auto& self) -> void {
+    while (last - first > 1) {
+      size_t mid = first + (last - first) / 2;
+      group.Run([mid, last, self]() { self(mid, last, self); });
+      last = mid;
+    }
+    f(first);
+  };
+  group.Run([count, &split]() { split(0, count, split); });
+  group.Wait();
+}
+
+}  // namespace gtk
\ No newline at end of file
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace gtk
+{
+
+// Chase-Lev work stealing deque, with the memory orders of Le, Pop, Cohen and Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models"
+//
+// A single owner thread pushes and pops at the bottom, any number of thieves steal from the top
+// without locks. The buffer is a ring that doubles when full; replaced rings stay alive until the
+// deque is destroyed since a thief may still be reading one. T is copied through std::atomic, so
+// it is meant to be a pointer or a small integer.
+template<typename T>
+class WorkStealingDeque
+{
+  static_assert(std::is_trivially_copyable_v<T>, "WorkStealingDeque requires a trivial type.");
+
+public:
+  explicit WorkStealingDeque(size_t capacity = 64)
+  {
+    size_t size = 1;
+    while (size < capacity) {
+      size *= 2;
+    }
+    rings.push_back(std::make_unique<Ring>(size));
+    ring.store(rings.back().get(), std::memory_order_relaxed);
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Owner only
+  void Push(T value)
+  {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Ring* r = ring.load(std::memory_order_relaxed);
+    if (b - t > static_cast<int64_t>(r->mask)) {
+      r = Grow(r, t, b);
+    }
+    r->Store(b, value);
+    // Publishes the value to the thieves reading bottom
+    bottom.store(b + 1, std::memory_order_release);
+  }
+
+  // Owner only, takes the newest value. Returns false when the deque is empty or a thief took the
+  // last value first.
+  bool Pop(T& value)
+  {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring* r = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    value = r->Load(b);
+    if (t == b) {
+      // Last value, the owner races the thieves for it
+      bool won = top.compare_exchange_strong(
+        t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+      );
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  // Any thread, takes the oldest value. Returns false when the deque is empty or another thread
+  // took that value first.
+  bool Steal(T& value)
+  {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+      return false;
+    }
+    Ring* r = ring.load(std::memory_order_acquire);
+    T stolen = r->Load(t);
+    if (!top.compare_exchange_strong(
+          t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed
+        )) {
+      return false;
+    }
+    value = stolen;
+    return true;
+  }
+
+  // Approximate unless called by the owner with no thief running
+  size_t Size() const
+  {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_relaxed);
+    return b > t ? static_cast<size_t>(b - t) : 0;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  size_t Capacity() const { return ring.load(std::memory_order_relaxed)->mask + 1; }
+
+private:
+  struct Ring {
+    explicit Ring(size_t size) : mask{size - 1}, slots{new std::atomic<T>[size]} {}
+
+    T Load(int64_t i) const
+    {
+      return slots[static_cast<size_t>(i) & mask].load(std::memory_order_relaxed);
+    }
+
+    void Store(int64_t i, T value)
+    {
+      slots[static_cast<size_t>(i) & mask].store(value, std::memory_order_relaxed);
+    }
+
+    size_t mask;
+    std::unique_ptr<std::atomic<T>[]> slots;
+  };
+
+  Ring* Grow(Ring* r, int64_t t, int64_t b)
+  {
+    auto grown = std::make_unique<Ring>(2 * (r->mask + 1));
+    for (int64_t i = t; i < b; ++i) {
+      grown->Store(i, r->Load(i));
+    }
+    rings.push_back(std::move(grown));
+    Ring* next = rings.back().get();
+    ring.store(next, std::memory_order_release);
+    return next;
+  }
+
+  // Top and bottom on their own cache lines, thieves hammer top while the owner moves bottom
+  alignas(64) std::atomic<int64_t> top{0};
+  alignas(64) std::atomic<int64_t> bottom{0};
+  alignas(64) std::atomic<Ring*> ring{nullptr};
+  // Every ring ever used, owner only
+  std::vector<std::unique_ptr<Ring>> rings;
+};
+
+}  // namespace gtk
\ No newline at end of file
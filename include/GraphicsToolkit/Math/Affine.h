@@ -0,0 +1,290 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+#include "Matrix.h"
+#include "Simd.h"
+#include "Tensor.h"
+#include "TensorSoA.h"
+#include "Vector.h"
+
+// Affine transforms of 3D space, a 4x4 matrix whose last row is always (0, 0, 0, 1). Only the
+// top 3x4 block is stored: the linear part in the first three columns and the translation in the
+// last, so points transform with the translation and directions without it.
+
+template<typename Scalar>
+class Affine3
+{
+  static_assert(std::is_floating_point_v<Scalar>, "Affine3 requires floating point scalars.");
+
+public:
+  using ScalarType = Scalar;
+  using MatrixType = Matrix<Scalar, 3, 4>;
+  using LinearType = Matrix<Scalar, 3, 3>;
+  using VectorType = Vector<Scalar, 3>;
+
+  // Constructors
+
+  // Identity
+  constexpr Affine3() : m{1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0} {}
+
+  constexpr explicit Affine3(const MatrixType& matrix) : m{matrix} {}
+
+  constexpr Affine3(const LinearType& linear, const VectorType& translation) : m{}
+  {
+    for (size_t i = 0; i < 3; ++i) {
+      for (size_t j = 0; j < 3; ++j) {
+        m(i, j) = linear(i, j);
+      }
+      m(i, 3) = translation[i];
+    }
+  }
+
+  // Drops the last row of a 4x4 matrix, which must be (0, 0, 0, 1)
+  constexpr explicit Affine3(const Matrix<Scalar, 4, 4>& m4) : m{m4} {}
+
+  static constexpr Affine3 Translation(const VectorType& t)
+  {
+    return Affine3(LinearType{1, 0, 0, 0, 1, 0, 0, 0, 1}, t);
+  }
+
+  static constexpr Affine3 Scaling(const VectorType& s)
+  {
+    return Affine3(LinearType{s[0], 0, 0, 0, s[1], 0, 0, 0, s[2]}, VectorType{});
+  }
+
+  // Accessors
+
+  constexpr Scalar& operator()(size_t i, size_t j) { return m(i, j); }
+  constexpr const Scalar& operator()(size_t i, size_t j) const { return m(i, j); }
+
+  constexpr LinearType Linear() const
+  {
+    LinearType linear{};
+    for (size_t i = 0; i < 3; ++i) {
+      for (size_t j = 0; j < 3; ++j) {
+        linear(i, j) = m(i, j);
+      }
+    }
+    return linear;
+  }
+
+  constexpr VectorType Translation() const { return VectorType{m(0, 3), m(1, 3), m(2, 3)}; }
+
+  constexpr const MatrixType& AsMatrix() const { return m; }
+
+  constexpr Matrix<Scalar, 4, 4> ToMatrix4() const
+  {
+    Matrix<Scalar, 4, 4> m4{};
+    for (size_t i = 0; i < 12; ++i) {
+      m4[i] = m[i];
+    }
+    m4(3, 3) = 1;
+    return m4;
+  }
+
+private:
+  MatrixType m;
+};
+
+template<typename Scalar>
+constexpr bool operator==(const Affine3<Scalar>& lhs, const Affine3<Scalar>& rhs)
+{
+  return lhs.AsMatrix() == rhs.AsMatrix();
+}
+
+template<typename Scalar>
+constexpr bool operator!=(const Affine3<Scalar>& lhs, const Affine3<Scalar>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+// Composition, the transform applying rhs first and then lhs
+template<typename Scalar>
+constexpr Affine3<Scalar> Mul(const Affine3<Scalar>& lhs, const Affine3<Scalar>& rhs)
+{
+  Affine3<Scalar> result;
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      Scalar sum = j == 3 ? lhs(i, 3) : Scalar{};
+      for (size_t k = 0; k < 3; ++k) {
+        sum += lhs(i, k) * rhs(k, j);
+      }
+      result(i, j) = sum;
+    }
+  }
+  return result;
+}
+
+template<typename Scalar>
+constexpr Affine3<Scalar> operator*(const Affine3<Scalar>& lhs, const Affine3<Scalar>& rhs)
+{
+  return Mul(lhs, rhs);
+}
+
+template<typename Scalar, typename Storage>
+constexpr Vector<Scalar, 3>
+TransformPoint(const Affine3<Scalar>& a, const BasicTensor<Scalar, Storage, 3>& p)
+{
+  return Vector<Scalar, 3>{
+    a(0, 0) * p[0] + a(0, 1) * p[1] + a(0, 2) * p[2] + a(0, 3),
+    a(1, 0) * p[0] + a(1, 1) * p[1] + a(1, 2) * p[2] + a(1, 3),
+    a(2, 0) * p[0] + a(2, 1) * p[1] + a(2, 2) * p[2] + a(2, 3)
+  };
+}
+
+template<typename Scalar, typename Storage>
+constexpr Vector<Scalar, 3>
+TransformDirection(const Affine3<Scalar>& a, const BasicTensor<Scalar, Storage, 3>& d)
+{
+  return Vector<Scalar, 3>{
+    a(0, 0) * d[0] + a(0, 1) * d[1] + a(0, 2) * d[2],
+    a(1, 0) * d[0] + a(1, 1) * d[1] + a(1, 2) * d[2],
+    a(2, 0) * d[0] + a(2, 1) * d[1] + a(2, 2) * d[2]
+  };
+}
+
+// Inverse of any invertible transform. Singular transforms have no inverse, their elements
+// become infinite or NaN.
+template<typename Scalar>
+constexpr Affine3<Scalar> Inverse(const Affine3<Scalar>& a)
+{
+  Affine3<Scalar> result(Inverse(a.Linear()), Vector<Scalar, 3>{});
+  Vector<Scalar, 3> t = TransformDirection(result, a.Translation());
+  for (size_t i = 0; i < 3; ++i) {
+    result(i, 3) = -t[i];
+  }
+  return result;
+}
+
+// Inverse of a rotation followed by a translation, the transposed rotation and the translation
+// rotated back. Only valid when the linear part is orthonormal, no scale or shear.
+template<typename Scalar>
+constexpr Affine3<Scalar> RigidInverse(const Affine3<Scalar>& a)
+{
+  Affine3<Scalar> result;
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 3; ++j) {
+      result(i, j) = a(j, i);
+    }
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    result(i, 3) = -(result(i, 0) * a(0, 3) + result(i, 1) * a(1, 3) + result(i, 2) * a(2, 3));
+  }
+  return result;
+}
+
+// Transforms normals so they stay perpendicular to transformed surfaces, the inverse transpose of
+// the linear part
+template<typename Scalar>
+constexpr Matrix<Scalar, 3, 3> NormalMatrix(const Affine3<Scalar>& a)
+{
+  return InverseTransposed(a.Linear());
+}
+
+
+// Batch transforms
+//
+// The elements of the transform are broadcast once and the components of a packet of vectors
+// are transformed together. Arrays of vectors go through blocks transposed into lanes like the
+// batch functions in Vector.h, TensorSoA batches are transformed on their own lanes in place.
+// Outputs may alias inputs.
+
+// Transforms n vectors given by their component lanes, with the translation when isPoint
+template<bool isPoint, typename Scalar>
+void TransformLanes(
+  const Affine3<Scalar>& a,
+  const Scalar* const lanes[3],
+  Scalar* const out[3],
+  size_t n
+)
+{
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    Packet e[3][4];
+    for (size_t r = 0; r < 3; ++r) {
+      for (size_t c = 0; c < 4; ++c) {
+        e[r][c] = Packet::Broadcast(a(r, c));
+      }
+    }
+    for (; i + Packet::width <= n; i += Packet::width) {
+      Packet x = Packet::Load(lanes[0] + i);
+      Packet y = Packet::Load(lanes[1] + i);
+      Packet z = Packet::Load(lanes[2] + i);
+      for (size_t r = 0; r < 3; ++r) {
+        Packet sum = e[r][0] * x + e[r][1] * y + e[r][2] * z;
+        if constexpr (isPoint) {
+          sum = sum + e[r][3];
+        }
+        sum.Store(out[r] + i);
+      }
+    }
+  }
+  for (; i < n; ++i) {
+    Vector<Scalar, 3> v{lanes[0][i], lanes[1][i], lanes[2][i]};
+    Vector<Scalar, 3> t = isPoint ? TransformPoint(a, v) : TransformDirection(a, v);
+    for (size_t r = 0; r < 3; ++r) {
+      out[r][i] = t[r];
+    }
+  }
+}
+
+template<bool isPoint, typename Scalar, typename Storage>
+void TransformVectors(
+  const Affine3<Scalar>& a,
+  const BasicTensor<Scalar, Storage, 3>* v,
+  size_t count,
+  BasicTensor<Scalar, Storage, 3>* out
+)
+{
+  using VectorType = BasicTensor<Scalar, Storage, 3>;
+  VectorBlock<VectorType> block;
+  Scalar* const lanes[3] = {block.lanes[0], block.lanes[1], block.lanes[2]};
+  for (size_t i = 0; i < count; i += VectorBlock<VectorType>::size) {
+    size_t n = std::min(VectorBlock<VectorType>::size, count - i);
+    block.Load(v + i, n);
+    TransformLanes<isPoint>(a, lanes, lanes, n);
+    block.Store(out + i, n);
+  }
+}
+
+template<typename Scalar, typename Storage>
+void TransformPoints(
+  const Affine3<Scalar>& a,
+  const BasicTensor<Scalar, Storage, 3>* points,
+  size_t count,
+  BasicTensor<Scalar, Storage, 3>* out
+)
+{
+  TransformVectors<true>(a, points, count, out);
+}
+
+template<typename Scalar, typename Storage>
+void TransformDirections(
+  const Affine3<Scalar>& a,
+  const BasicTensor<Scalar, Storage, 3>* directions,
+  size_t count,
+  BasicTensor<Scalar, Storage, 3>* out
+)
+{
+  TransformVectors<false>(a, directions, count, out);
+}
+
+template<typename Scalar, typename Storage>
+void TransformPoints(const Affine3<Scalar>& a, TensorSoA<BasicTensor<Scalar, Storage, 3>>& points)
+{
+  Scalar* const lanes[3] = {points.Lane(0), points.Lane(1), points.Lane(2)};
+  TransformLanes<true>(a, lanes, lanes, points.Size());
+}
+
+template<typename Scalar, typename Storage>
+void TransformDirections(
+  const Affine3<Scalar>& a,
+  TensorSoA<BasicTensor<Scalar, Storage, 3>>& directions
+)
+{
+  Scalar* const lanes[3] = {directions.Lane(0), directions.Lane(1), directions.Lane(2)};
+  TransformLanes<false>(a, lanes, lanes, directions.Size());
+}
\ No newline at end of file
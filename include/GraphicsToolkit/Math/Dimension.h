@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 // #include <numeric>
 
 #include "Tuple.h"
@@ -59,6 +60,8 @@ struct TDimension {
   static constexpr bool isMatrix = (rank == 2);
   static constexpr bool isTensor = (rank > 2);
 
+  static constexpr std::array<size_t, rank> extents = {dims...};
+
   template<typename IndexSeq, typename Dim, size_t currentIndex, size_t tailProduct, size_t result>
   struct FlattenedIndexHelper;
 
@@ -131,7 +134,7 @@ struct TDimension {
   static constexpr size_t FlattenedIndex(const gtk::Tuple<E...>& index)
   {
     std::array<size_t, rank> tailProducts = TailProducts();
-    std::array<size_t, rank> indices;
+    std::array<size_t, rank> indices{};
     for (size_t i = 0; i < rank; ++i) {
       indices[i] = gtk::Get(index, i);
     }
@@ -151,6 +154,17 @@ struct TDimension {
     flatIndex /= dimensions[0];
     return index;
   }
+
+  // Same as UnflattenedIndex, as an array for runtime loops over the axes
+  static constexpr std::array<size_t, rank> MultiIndex(size_t flatIndex)
+  {
+    std::array<size_t, rank> index{};
+    for (size_t i = rank - 1; i < rank; --i) {
+      index[i] = flatIndex % extents[i];
+      flatIndex /= extents[i];
+    }
+    return index;
+  }
 };
 
 // Specialization for scalar dimensions (rank 0)
@@ -164,6 +178,8 @@ struct TDimension<> {
   static constexpr bool isMatrix = false;
   static constexpr bool isTensor = false;
 
+  static constexpr std::array<size_t, 0> extents{};
+
   // TailProducts for scalar - return empty array (can't use std::array<size_t, 0>)
   // Instead, we'll make it a no-op since it's not used for scalars
   static constexpr void TailProducts()
@@ -192,6 +208,8 @@ struct TDimension<> {
 
   // UnflattenedIndex for scalar returns empty tuple
   static constexpr gtk::Tuple<> UnflattenedIndex(size_t) { return {}; }
+
+  static constexpr std::array<size_t, 0> MultiIndex(size_t) { return {}; }
 };
 
 template<typename D>
@@ -285,6 +303,41 @@ public:
   static constexpr bool value = CanBroadcastHelper<FromDimPadded, ToDim>::value;
 };
 
+// Strides for reading a FromDim tensor in place as if it were broadcast to ToDim.
+// Broadcast axes get a zero stride, so nothing has to be copied or clamped per element.
+template<typename FromDim, typename ToDim>
+struct BroadcastStrides {
+private:
+  static_assert(CanBroadcast<FromDim, ToDim>::value);
+
+  using FromDimPadded = typename PadDim<FromDim, ToDim>::D1Padded;
+
+  static constexpr std::array<size_t, ToDim::rank> Compute()
+  {
+    std::array<size_t, ToDim::rank> strides{};
+    if constexpr (ToDim::rank > 0) {
+      constexpr auto fromExtents = FromDimPadded::extents;
+      constexpr auto tailProducts = FromDimPadded::TailProducts();
+      for (size_t i = 0; i < ToDim::rank; ++i) {
+        strides[i] = (fromExtents[i] == 1) ? 0 : tailProducts[i];
+      }
+    }
+    return strides;
+  }
+
+public:
+  static constexpr std::array<size_t, ToDim::rank> value = Compute();
+};
+
+template<typename FromDim, typename ToDim>
+inline constexpr auto BroadcastStridesV = BroadcastStrides<FromDim, ToDim>::value;
+
+template<typename FromDim, typename ToDim>
+constexpr size_t BroadcastOffset(const std::array<size_t, ToDim::rank>& index)
+{
+  return InnerProduct(BroadcastStridesV<FromDim, ToDim>, index);
+}
+
 template<typename D, size_t popFrontCount, size_t popBackCount>
 struct DimPopFrontAndBack {
   // First pop all front elements, then pop all back elements
@@ -403,3 +456,29 @@ private:
 public:
   static constexpr bool value = isDowncast && found && (restIsEmpty || restAreAllOnes);
 };
+
+
+namespace
+{
+template<typename D, size_t axis, typename F>
+constexpr void ForEachMultiIndexHelper(std::array<size_t, D::rank>& index, size_t& flatIndex, F& f)
+{
+  if constexpr (axis == D::rank) {
+    f(flatIndex++, static_cast<const std::array<size_t, D::rank>&>(index));
+  } else {
+    for (index[axis] = 0; index[axis] < DimGet<D, axis>; ++index[axis]) {
+      ForEachMultiIndexHelper<D, axis + 1>(index, flatIndex, f);
+    }
+  }
+}
+}  // namespace
+
+// Visits every element of D in memory order as f(flatIndex, multiIndex), using one nested loop
+// per axis instead of unflattening each index
+template<typename D, typename F>
+constexpr void ForEachMultiIndex(F&& f)
+{
+  std::array<size_t, D::rank> index{};
+  size_t flatIndex = 0;
+  ForEachMultiIndexHelper<D, 0>(index, flatIndex, f);
+}
\ No newline at end of file
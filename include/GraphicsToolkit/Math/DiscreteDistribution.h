@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "Execution.h"
+#include "Random.h"
+#include "Sample.h"
+
+// Distribution over the indices [0, n) with probabilities proportional to weights, sampled with
+// Vose's alias method ("A Linear Algorithm For Generating Random Numbers With a Given
+// Distribution")
+//
+// The table splits the probabilities into n columns of equal height 1 / n, column i holding index
+// i up to a threshold and one other index, its alias, above it. Building takes O(n), a sample
+// O(1): one random number picks a column with its high half and compares its low half with the
+// threshold, one cache line read whatever n. Thresholds and column picks have 32 bits, the
+// probabilities are exact to 2^-32.
+//
+// Weights may change between samples: SetWeight is O(1) and Rebuild refreshes the table in O(n)
+// in the buffers it already has, so a scene updating its lights every frame does not allocate.
+// Samples drawn before Rebuild follow the previous weights.
+//   DiscreteDistribution lights(power);
+//   size_t light = lights.Sample(rng);
+//   double pdf = lights.Probability(light);
+class DiscreteDistribution
+{
+public:
+  DiscreteDistribution() = default;
+
+  // Weights must be finite, non negative and not all zero, there may be at most 2^32 of them
+  explicit DiscreteDistribution(std::vector<double> weights);
+
+  // Accessors
+
+  size_t Size() const { return weights.size(); }
+
+  double Weight(size_t i) const { return weights[i]; }
+
+  // Sum of the weights as of the last Rebuild
+  double TotalWeight() const { return total; }
+
+  // Probability of sampling i, once Rebuild took in the changed weights
+  double Probability(size_t i) const { return weights[i] / total; }
+
+  // True after SetWeight until Rebuild
+  bool Stale() const { return stale; }
+
+  // Updates
+
+  // The table keeps sampling the previous weights until Rebuild
+  void SetWeight(size_t i, double weight);
+
+  // Rebuilds the table from the current weights in O(n) without allocating
+  void Rebuild();
+
+  // Sampling
+
+  template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+  size_t Sample(Engine& rng) const
+  {
+    uint64_t bits;
+    if constexpr (sizeof(typename Engine::result_type) == 8) {
+      bits = rng();
+    } else {
+      bits = (uint64_t{rng()} << 32) | rng();
+    }
+    // Lemire's multiply and shift maps the high half to a column, biased by at most n / 2^32
+    uint64_t column = ((bits >> 32) * columns.size()) >> 32;
+    const Column& c = columns[column];
+    return static_cast<uint32_t>(bits) < c.threshold ? column : c.alias;
+  }
+
+  // out[i] = Sample(rng) for i in [0, count)
+  template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+  void SampleBatch(size_t* out, size_t count, Engine& rng) const
+  {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = Sample(rng);
+    }
+  }
+
+  // Under an execution policy, from the streams of seed like the FillUniform of Sample.h
+  template<typename Policy, typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+  void SampleBatch(const Policy& policy, size_t* out, size_t count, uint64_t seed) const
+  {
+    ForEachSampleBlock(policy, count, seed, [&](size_t first, size_t last, auto& rng) {
+      SampleBatch(out + first, last - first, rng);
+    });
+  }
+
+private:
+  struct Column {
+    // Samples of the low 32 bits below it stay on the column, full columns alias themselves
+    uint32_t threshold;
+    uint32_t alias;
+  };
+
+  std::vector<double> weights;
+  double total = 0;
+  bool stale = false;
+  std::vector<Column> columns;
+  // Buffers of Rebuild: probabilities scaled by n, and the small and large worklists sharing one
+  // array from both ends
+  std::vector<double> scaled;
+  std::vector<uint32_t> work;
+};
\ No newline at end of file
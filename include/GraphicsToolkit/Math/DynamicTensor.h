@@ -0,0 +1,575 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Execution.h"
+#include "Tensor.h"
+#include "TensorExpression.h"
+
+// Tensors whose shape is only known at runtime, for data too large for the stack (framebuffers,
+// sample buffers, lookup tables). Storage is heap allocated and aligned to a cache line.
+//
+// Broadcasting follows the same rules as the fixed size tensors, checked at runtime instead of
+// compile time, and componentwise operators build lazy DynamicTensorExpr nodes that are evaluated
+// in one pass when assigned to a DynamicTensor.
+
+using DynamicShape = std::vector<size_t>;
+
+inline constexpr size_t dynamicTensorAlignment = 64;
+
+template<typename T>
+struct IsDynamicTensorClass {
+  static constexpr bool value = false;
+};
+
+template<typename T>
+static constexpr bool IsDynamicTensorClassV = IsDynamicTensorClass<T>::value;
+
+template<typename T>
+struct IsDynamicTensorExprClass {
+  static constexpr bool value = false;
+};
+
+template<typename T>
+static constexpr bool IsDynamicTensorExprClassV = IsDynamicTensorExprClass<T>::value;
+
+template<typename T>
+inline constexpr bool IsDynamicOperandV =
+  IsDynamicTensorClassV<std::decay_t<T>> || IsDynamicTensorExprClassV<std::decay_t<T>>;
+
+inline size_t ShapeCount(const DynamicShape& shape)
+{
+  size_t count = 1;
+  for (size_t dim : shape) {
+    count *= dim;
+  }
+  return count;
+}
+
+inline DynamicShape ShapeTailProducts(const DynamicShape& shape)
+{
+  DynamicShape products(shape.size());
+  size_t product = 1;
+  for (size_t i = shape.size() - 1; i < shape.size(); --i) {
+    products[i] = product;
+    product *= shape[i];
+  }
+  return products;
+}
+
+// Runtime counterpart of CanBroadcast
+inline bool CanBroadcastShape(const DynamicShape& from, const DynamicShape& to)
+{
+  if (from.size() > to.size()) {
+    return false;
+  }
+  size_t padRank = to.size() - from.size();
+  for (size_t i = 0; i < from.size(); ++i) {
+    if (from[i] != to[padRank + i] && from[i] != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Runtime counterpart of BroadcastDimension
+inline DynamicShape BroadcastShape(const DynamicShape& s1, const DynamicShape& s2)
+{
+  if (CanBroadcastShape(s2, s1)) {
+    return s1;
+  }
+  if (CanBroadcastShape(s1, s2)) {
+    return s2;
+  }
+  throw std::invalid_argument{
+    "Cannot perform componentwise operation: shapes are not compatible for broadcasting."
+  };
+}
+
+// Runtime counterpart of BroadcastStrides, zero along the broadcast axes
+inline DynamicShape BroadcastShapeStrides(const DynamicShape& from, const DynamicShape& to)
+{
+  DynamicShape strides(to.size(), 0);
+  DynamicShape tailProducts = ShapeTailProducts(from);
+  size_t padRank = to.size() - from.size();
+  for (size_t i = 0; i < from.size(); ++i) {
+    strides[padRank + i] = (from[i] == 1) ? 0 : tailProducts[i];
+  }
+  return strides;
+}
+
+template<typename T>
+DynamicShape ShapeOf(const T& t)
+{
+  if constexpr (IsTensorClassV<T>) {
+    constexpr auto extents = T::DimensionType::extents;
+    return DynamicShape(extents.begin(), extents.end());
+  } else {
+    return t.Shape();
+  }
+}
+
+// Walks the elements of one operand along the axes of the evaluated shape
+template<typename Scalar>
+struct DynamicLeafCursor {
+  Scalar Get() const { return data[offset]; }
+
+  // Innermost strides are 0 for broadcast operands and 1 otherwise
+  template<typename Packet>
+  Packet GetPacket(size_t axis) const
+  {
+    using PacketScalar = typename Packet::ScalarType;
+    if constexpr (std::is_same_v<Scalar, PacketScalar>) {
+      if (strides[axis] != 0) {
+        return Packet::Load(data + offset);
+      }
+    }
+    return Packet::Broadcast(static_cast<PacketScalar>(data[offset]));
+  }
+
+  void Advance(size_t axis, size_t steps = 1) { offset += strides[axis] * steps; }
+  void Rewind(size_t axis, size_t steps) { offset -= strides[axis] * steps; }
+
+  const Scalar* data;
+  DynamicShape strides;
+  size_t offset = 0;
+};
+
+template<typename T>
+auto MakeDynamicCursor(const T& t, const DynamicShape& shape, bool flat)
+{
+  if constexpr (IsDynamicTensorExprClassV<T>) {
+    return t.MakeCursor(shape, flat);
+  } else {
+    using Scalar = typename T::ScalarType;
+    DynamicShape operandShape = ShapeOf(t);
+    DynamicShape strides;
+    if (flat) {
+      // Single elements are repeated, anything else walks the storage as is
+      strides = {ShapeCount(operandShape) == 1 ? size_t{0} : size_t{1}};
+    } else {
+      strides = BroadcastShapeStrides(operandShape, shape);
+    }
+    return DynamicLeafCursor<Scalar>{&t[0], std::move(strides)};
+  }
+}
+
+// Evaluates elements [first, last) of expr into out. Operands that are not broadcast are walked
+// as one flat array, otherwise the innermost axis is a tight loop and each operand only bumps an
+// offset, first and last are then multiples of the innermost extent.
+template<typename Scalar, typename Expr>
+void EvaluateDynamicRange(Scalar* out, const Expr& expr, size_t first, size_t last)
+{
+  if (first == last) {
+    return;
+  }
+  const DynamicShape& shape = expr.Shape();
+  bool flat = expr.IsFlat() || shape.empty();
+  DynamicShape loopShape = flat ? DynamicShape{expr.Count()} : shape;
+
+  auto cursor = expr.MakeCursor(loopShape, flat);
+  size_t rank = loopShape.size();
+  size_t inner = flat ? last - first : loopShape[rank - 1];
+  DynamicShape index(rank, 0);
+
+  // Every operand starts at element first
+  size_t start = first;
+  for (size_t axis = rank; axis-- > 0;) {
+    index[axis] = start % loopShape[axis];
+    start /= loopShape[axis];
+    cursor.Advance(axis, index[axis]);
+  }
+
+  for (size_t i = first; i < last; i += inner) {
+    size_t j = 0;
+    if constexpr (IsVectorizableV<Expr, Scalar> && gtk::simd::HasNativePacketV<Scalar>) {
+      using Packet = gtk::simd::NativePacketT<Scalar>;
+      for (; j + Packet::width <= inner; j += Packet::width) {
+        cursor.template GetPacket<Packet>(rank - 1).Store(out + i + j);
+        cursor.Advance(rank - 1, Packet::width);
+      }
+    }
+    for (; j < inner; ++j) {
+      out[i + j] = static_cast<Scalar>(cursor.Get());
+      cursor.Advance(rank - 1);
+    }
+    cursor.Rewind(rank - 1, inner);
+
+    for (size_t axis = rank - 1; axis-- > 0;) {
+      cursor.Advance(axis);
+      if (++index[axis] < loopShape[axis]) {
+        break;
+      }
+      cursor.Rewind(axis, loopShape[axis]);
+      index[axis] = 0;
+    }
+  }
+}
+
+// Evaluates expr into out with a single pass
+template<typename Scalar, typename Expr>
+void EvaluateDynamic(Scalar* out, const Expr& expr)
+{
+  EvaluateDynamicRange(out, expr, 0, expr.Count());
+}
+
+// Same in chunks run under policy, whole rows of the innermost axis unless the evaluation is flat
+template<typename Policy, typename Scalar, typename Expr>
+void EvaluateDynamic(const Policy& policy, Scalar* out, const Expr& expr)
+{
+  const DynamicShape& shape = expr.Shape();
+  bool flat = expr.IsFlat() || shape.empty();
+  size_t inner = flat ? 1 : shape.back();
+  size_t rows = inner == 0 ? 0 : expr.Count() / inner;
+  gtk::exec::ForEachChunk(policy, rows, inner, [&](size_t first, size_t last) {
+    EvaluateDynamicRange(out, expr, first * inner, last * inner);
+  });
+}
+
+template<typename Scalar>
+class DynamicTensor
+{
+  static_assert(std::is_arithmetic_v<Scalar>, "DynamicTensor only holds arithmetic scalars.");
+
+public:
+  using ScalarType = Scalar;
+
+  // Constructors
+
+  DynamicTensor() : DynamicTensor(DynamicShape{0}) {}
+
+  explicit DynamicTensor(DynamicShape shape, Scalar value = Scalar{}) : shape{std::move(shape)}
+  {
+    Allocate();
+    std::fill_n(data.get(), count, value);
+  }
+
+  // Conversion from a fixed size tensor
+  template<typename OtherScalar, typename Storage, size_t... dims>
+  explicit DynamicTensor(const BasicTensor<OtherScalar, Storage, dims...>& other)
+      : DynamicTensor(ShapeOf(other))
+  {
+    std::copy(other.begin(), other.end(), data.get());
+  }
+
+  // Evaluation of a componentwise expression, all operators fused into a single pass
+  template<typename Expr, typename = std::enable_if_t<IsDynamicTensorExprClassV<Expr>>>
+  DynamicTensor(const Expr& expr) : shape{expr.Shape()}
+  {
+    Allocate();
+    EvaluateDynamic(data.get(), expr);
+  }
+
+  DynamicTensor(const DynamicTensor& other) : shape{other.shape}
+  {
+    Allocate();
+    std::copy(other.begin(), other.end(), data.get());
+  }
+
+  DynamicTensor(DynamicTensor&& other) noexcept
+      : shape{std::move(other.shape)},
+        strides{std::move(other.strides)},
+        count{std::exchange(other.count, 0)},
+        data{std::move(other.data)}
+  {
+  }
+
+  DynamicTensor& operator=(const DynamicTensor& other)
+  {
+    if (this != &other) {
+      Reshape(other.shape);
+      std::copy(other.begin(), other.end(), data.get());
+    }
+    return *this;
+  }
+
+  DynamicTensor& operator=(DynamicTensor&& other) noexcept
+  {
+    shape = std::move(other.shape);
+    strides = std::move(other.strides);
+    count = std::exchange(other.count, 0);
+    data = std::move(other.data);
+    return *this;
+  }
+
+  // Evaluates in place when the shape is unchanged, otherwise reallocates first
+  template<typename Expr, typename = std::enable_if_t<IsDynamicTensorExprClassV<Expr>>>
+  DynamicTensor& operator=(const Expr& expr)
+  {
+    if (expr.Shape() != shape) {
+      DynamicTensor result{expr};
+      return *this = std::move(result);
+    }
+    EvaluateDynamic(data.get(), expr);
+    return *this;
+  }
+
+  // Shape
+
+  size_t Rank() const { return shape.size(); }
+  size_t Count() const { return count; }
+  const DynamicShape& Shape() const { return shape; }
+  const DynamicShape& Strides() const { return strides; }
+  bool IsFlat() const { return true; }
+
+  // Accessors
+  // operator[] for flattened index access
+  // operator() for multi-dimensional access
+
+  Scalar& operator[](size_t i) { return data[i]; }
+  const Scalar& operator[](size_t i) const { return data[i]; }
+
+  template<typename... Ts>
+  Scalar& operator()(const Ts... indices)
+  {
+    return data[FlattenedIndex(indices...)];
+  }
+
+  template<typename... Ts>
+  const Scalar& operator()(const Ts... indices) const
+  {
+    return data[FlattenedIndex(indices...)];
+  }
+
+  Scalar* Data() { return data.get(); }
+  const Scalar* Data() const { return data.get(); }
+
+  void Fill(Scalar value) { std::fill_n(data.get(), count, value); }
+
+  // Iterators for range-based for loops
+  Scalar* begin() { return data.get(); }
+  Scalar* end() { return data.get() + count; }
+  const Scalar* begin() const { return data.get(); }
+  const Scalar* end() const { return data.get() + count; }
+  const Scalar* cbegin() const { return data.get(); }
+  const Scalar* cend() const { return data.get() + count; }
+
+private:
+  struct AlignedDelete {
+    void operator()(Scalar* p) const
+    {
+      ::operator delete[](p, std::align_val_t{dynamicTensorAlignment});
+    }
+  };
+
+  void Allocate()
+  {
+    count = ShapeCount(shape);
+    strides = ShapeTailProducts(shape);
+    void* p = ::operator new[](count * sizeof(Scalar), std::align_val_t{dynamicTensorAlignment});
+    data.reset(static_cast<Scalar*>(p));
+  }
+
+  void Reshape(const DynamicShape& newShape)
+  {
+    if (newShape != shape) {
+      shape = newShape;
+      Allocate();
+    }
+  }
+
+  template<typename... Ts>
+  size_t FlattenedIndex(const Ts... indices) const
+  {
+    std::array<size_t, sizeof...(Ts)> index = {static_cast<size_t>(indices)...};
+    size_t flatIndex = 0;
+    for (size_t i = 0; i < index.size(); ++i) {
+      flatIndex += strides[i] * index[i];
+    }
+    return flatIndex;
+  }
+
+  DynamicShape shape;
+  DynamicShape strides;
+  size_t count = 0;
+  std::unique_ptr<Scalar[], AlignedDelete> data;
+};
+
+template<typename Scalar>
+struct IsDynamicTensorClass<DynamicTensor<Scalar>> {
+  static constexpr bool value = true;
+};
+
+template<typename S, typename Scalar>
+struct IsVectorizable<DynamicTensor<S>, Scalar> {
+  static constexpr bool value = std::is_same_v<S, Scalar>;
+};
+
+template<typename S1, typename S2>
+bool operator==(const DynamicTensor<S1>& lhs, const DynamicTensor<S2>& rhs)
+{
+  return std::is_same_v<S1, S2> && lhs.Shape() == rhs.Shape() &&
+         std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template<typename S1, typename S2>
+bool operator!=(const DynamicTensor<S1>& lhs, const DynamicTensor<S2>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+template<
+  typename T,
+  typename U = std::decay_t<T>,
+  bool isTensorOperand = IsDynamicOperandV<U> || IsTensorClassV<U>,
+  bool isLazyTensor = IsLazyTensorClassV<U>>
+struct DynamicExprOperand {
+  // Plain scalars behave like single element tensors
+  using Type = Tensor<U, 1>;
+};
+
+template<typename T, typename U>
+struct DynamicExprOperand<T, U, true, false> {
+  static constexpr bool isNamed = !IsDynamicTensorExprClassV<U> && std::is_lvalue_reference_v<T>;
+  using Type = std::conditional_t<isNamed, const U&, U>;
+};
+
+// Fixed size expressions and views are small, they are materialized once
+template<typename T, typename U>
+struct DynamicExprOperand<T, U, false, true> {
+  using Type = MakeTensorFromDimensionT<typename U::ScalarType, typename U::DimensionType>;
+};
+
+// Storage type of an operand passed as T&& to an operator on dynamic tensors
+template<typename T>
+using DynamicExprOperandT = typename DynamicExprOperand<T>::Type;
+
+template<typename BinaryOp, typename LhsCursor, typename RhsCursor>
+struct DynamicExprCursor {
+  auto Get() const { return (*op)(lhs.Get(), rhs.Get()); }
+
+  template<typename Packet>
+  Packet GetPacket(size_t axis) const
+  {
+    return (*op)(lhs.template GetPacket<Packet>(axis), rhs.template GetPacket<Packet>(axis));
+  }
+
+  void Advance(size_t axis, size_t steps = 1)
+  {
+    lhs.Advance(axis, steps);
+    rhs.Advance(axis, steps);
+  }
+
+  void Rewind(size_t axis, size_t steps)
+  {
+    lhs.Rewind(axis, steps);
+    rhs.Rewind(axis, steps);
+  }
+
+  LhsCursor lhs;
+  RhsCursor rhs;
+  const BinaryOp* op;
+};
+
+template<typename BinaryOp, typename Lhs, typename Rhs>
+class DynamicTensorExpr
+{
+  using LhsType = std::decay_t<Lhs>;
+  using RhsType = std::decay_t<Rhs>;
+
+public:
+  using ScalarType = std::decay_t<decltype(std::declval<const BinaryOp&>()(
+    std::declval<typename LhsType::ScalarType>(), std::declval<typename RhsType::ScalarType>()
+  ))>;
+
+  DynamicTensorExpr(Lhs lhs, Rhs rhs, BinaryOp op)
+      : lhs{std::move(lhs)},
+        rhs{std::move(rhs)},
+        op{std::move(op)}
+  {
+    DynamicShape lhsShape = ShapeOf(this->lhs);
+    DynamicShape rhsShape = ShapeOf(this->rhs);
+    shape = BroadcastShape(lhsShape, rhsShape);
+    count = ShapeCount(shape);
+    isFlat = IsFlatOperand(this->lhs, lhsShape) && IsFlatOperand(this->rhs, rhsShape);
+  }
+
+  const DynamicShape& Shape() const { return shape; }
+  size_t Count() const { return count; }
+  size_t Rank() const { return shape.size(); }
+
+  // No operand is broadcast anywhere in the tree, element i only depends on operand elements i
+  bool IsFlat() const { return isFlat; }
+
+  // Flattened index access, prefer evaluating the whole expression into a DynamicTensor
+  ScalarType operator[](size_t i) const
+  {
+    bool flat = isFlat || shape.empty();
+    DynamicShape loopShape = flat ? DynamicShape{count} : shape;
+    DynamicShape tailProducts = ShapeTailProducts(loopShape);
+    auto cursor = MakeCursor(loopShape, flat);
+    for (size_t axis = 0; axis < loopShape.size(); ++axis) {
+      cursor.Advance(axis, i / tailProducts[axis]);
+      i %= tailProducts[axis];
+    }
+    return cursor.Get();
+  }
+
+  auto MakeCursor(const DynamicShape& loopShape, bool flat) const
+  {
+    using LhsCursor = decltype(MakeDynamicCursor(lhs, loopShape, flat));
+    using RhsCursor = decltype(MakeDynamicCursor(rhs, loopShape, flat));
+    return DynamicExprCursor<BinaryOp, LhsCursor, RhsCursor>{
+      MakeDynamicCursor(lhs, loopShape, flat), MakeDynamicCursor(rhs, loopShape, flat), &op
+    };
+  }
+
+  DynamicTensor<ScalarType> Eval() const { return DynamicTensor<ScalarType>{*this}; }
+
+private:
+  template<typename T>
+  bool IsFlatOperand(const T& t, const DynamicShape& operandShape) const
+  {
+    size_t operandCount = ShapeCount(operandShape);
+    if constexpr (IsDynamicTensorExprClassV<T>) {
+      return (operandCount == count) && t.IsFlat();
+    } else {
+      return (operandCount == count) || (operandCount == 1);
+    }
+  }
+
+  Lhs lhs;
+  Rhs rhs;
+  BinaryOp op;
+  DynamicShape shape;
+  size_t count = 0;
+  bool isFlat = false;
+};
+
+template<typename BinaryOp, typename Lhs, typename Rhs>
+struct IsDynamicTensorExprClass<DynamicTensorExpr<BinaryOp, Lhs, Rhs>> {
+  static constexpr bool value = true;
+};
+
+// Broadcasting is resolved by the cursors, any operand tree of matching scalars qualifies
+template<typename BinaryOp, typename Lhs, typename Rhs, typename Scalar>
+struct IsVectorizable<DynamicTensorExpr<BinaryOp, Lhs, Rhs>, Scalar> {
+  using ExprType = DynamicTensorExpr<BinaryOp, Lhs, Rhs>;
+  static constexpr bool value = std::is_same_v<typename ExprType::ScalarType, Scalar> &&
+                                gtk::simd::IsPacketOpV<BinaryOp, Scalar> &&
+                                IsVectorizableV<std::decay_t<Lhs>, Scalar> &&
+                                IsVectorizableV<std::decay_t<Rhs>, Scalar>;
+};
+
+// Evaluates expr into out under an execution policy, out is reallocated when the shapes differ
+template<
+  typename Policy,
+  typename Scalar,
+  typename Expr,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void Assign(const Policy& policy, DynamicTensor<Scalar>& out, const Expr& expr)
+{
+  static_assert(
+    IsDynamicTensorExprClassV<Expr>, "Assign evaluates expressions of dynamic tensors."
+  );
+  if (out.Shape() != expr.Shape()) {
+    out = DynamicTensor<Scalar>(expr.Shape());
+  }
+  EvaluateDynamic(policy, out.Data(), expr);
+}
\ No newline at end of file
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+#include "Dimension.h"
+#include "IntegerSequence.h"
+#include "Tensor.h"
+#include "TensorView.h"
+
+// Tensor contractions
+//
+// Einsum<subscripts>(ts...) sums products of elements of its operands over the labels missing
+// from the output, like numpy.einsum: "ij,jk->ik" is a matrix product, "bij,bj->bi" a batch of
+// matrix vector products, "i,ij,j->" a bilinear form and "ii->" a trace. Without "->" the output
+// holds the labels appearing once, in alphabetical order. Contract<AxesA, AxesB>(a, b) sums over
+// pairs of axes of a and b, the output axes are the remaining ones of a followed by those of b.
+//
+// The labels are checked against the operand dimensions and turned into a loop nest at compile
+// time, one loop per label advancing every operand by its stride along the label. Loops run from
+// the largest strides outside to the smallest inside, so the innermost loop walks contiguous
+// elements. Operands are tensors or views, the result is a tensor, or a scalar when every label
+// is summed.
+//
+// C++17 has no string template arguments, the subscripts are a constexpr char array with static
+// storage duration:
+//   static constexpr char matmul[] = "ij,jk->ik";
+//   auto c = Einsum<matmul>(a, b);
+
+template<size_t... axes>
+using Axes = gtk::IndexSequence<axes...>;
+
+inline constexpr size_t contractionMaxAxes = 32;
+
+// Axes of all operands in order labelled 0, 1, ... by first appearance, and the output labels
+struct ContractionLabels {
+  std::array<size_t, contractionMaxAxes> input{};
+  std::array<size_t, contractionMaxAxes> ranks{};
+  std::array<size_t, contractionMaxAxes> output{};
+  size_t inputCount = 0;
+  size_t operandCount = 0;
+  size_t outputCount = 0;
+  size_t labelCount = 0;
+  bool valid = true;
+};
+
+constexpr bool IsEinsumLabel(char c)
+{
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+// Labels of subscripts like "ij,jk->ik", valid is false for malformed subscripts
+constexpr ContractionLabels ParseEinsum(const char* subscripts)
+{
+  ContractionLabels labels;
+  char inputNames[contractionMaxAxes] = {};
+  char outputNames[contractionMaxAxes] = {};
+  size_t rank = 0;
+  bool hasOutput = false;
+  for (size_t i = 0; subscripts[i] != '\0' && labels.valid; ++i) {
+    char c = subscripts[i];
+    if (IsEinsumLabel(c)) {
+      size_t& n = hasOutput ? labels.outputCount : labels.inputCount;
+      if (n == contractionMaxAxes) {
+        labels.valid = false;
+      } else {
+        (hasOutput ? outputNames : inputNames)[n++] = c;
+        rank += hasOutput ? 0 : 1;
+      }
+    } else if (c == ',' && !hasOutput && labels.operandCount + 1 < contractionMaxAxes) {
+      labels.ranks[labels.operandCount++] = rank;
+      rank = 0;
+    } else if (c == '-' && subscripts[i + 1] == '>' && !hasOutput) {
+      hasOutput = true;
+      ++i;
+    } else if (c != ' ') {
+      labels.valid = false;
+    }
+  }
+  labels.ranks[labels.operandCount++] = rank;
+
+  char names[contractionMaxAxes] = {};
+  auto labelOf = [&](char c) {
+    size_t label = 0;
+    while (label < labels.labelCount && names[label] != c) {
+      ++label;
+    }
+    return label;
+  };
+  for (size_t a = 0; a < labels.inputCount; ++a) {
+    size_t label = labelOf(inputNames[a]);
+    if (label == labels.labelCount) {
+      names[labels.labelCount++] = inputNames[a];
+    }
+    labels.input[a] = label;
+  }
+
+  // Implicit output, the labels appearing once
+  if (!hasOutput) {
+    for (char c = 'A'; c <= 'z'; ++c) {
+      size_t occurrences = 0;
+      for (size_t a = 0; a < labels.inputCount; ++a) {
+        occurrences += inputNames[a] == c ? 1 : 0;
+      }
+      if (IsEinsumLabel(c) && occurrences == 1) {
+        outputNames[labels.outputCount++] = c;
+      }
+    }
+  }
+
+  // Output labels must be input labels, each at most once
+  for (size_t o = 0; o < labels.outputCount; ++o) {
+    labels.output[o] = labelOf(outputNames[o]);
+    for (size_t p = 0; p < o; ++p) {
+      labels.valid = labels.valid && outputNames[p] != outputNames[o];
+    }
+    labels.valid = labels.valid && labels.output[o] < labels.labelCount;
+  }
+  return labels;
+}
+
+// Labels of a contraction of axesA of a with axesB of b
+template<size_t... axesA, size_t... axesB>
+constexpr ContractionLabels
+ContractAxesLabels(size_t rankA, size_t rankB, Axes<axesA...>, Axes<axesB...>)
+{
+  constexpr size_t pairs = sizeof...(axesA);
+  constexpr std::array<size_t, pairs> a = {axesA...};
+  constexpr std::array<size_t, sizeof...(axesB)> b = {axesB...};
+
+  ContractionLabels labels;
+  labels.valid = sizeof...(axesA) == sizeof...(axesB) && rankA + rankB <= contractionMaxAxes;
+  labels.operandCount = 2;
+  labels.ranks[0] = rankA;
+  labels.ranks[1] = rankB;
+  labels.inputCount = rankA + rankB;
+  labels.labelCount = rankA;
+  for (size_t i = 0; i < rankA && labels.valid; ++i) {
+    labels.input[i] = i;
+  }
+
+  // Axes of b take the label of the axis of a they are paired with, or a new one
+  for (size_t j = 0; j < rankB && labels.valid; ++j) {
+    size_t pair = 0;
+    while (pair < pairs && b[pair] != j) {
+      ++pair;
+    }
+    labels.input[rankA + j] = pair < pairs ? a[pair] : labels.labelCount++;
+  }
+
+  for (size_t p = 0; p < pairs; ++p) {
+    labels.valid = labels.valid && a[p] < rankA && b[p] < rankB;
+    for (size_t q = 0; q < p; ++q) {
+      labels.valid = labels.valid && a[p] != a[q] && b[p] != b[q];
+    }
+  }
+
+  // The output is every label that is not paired, in order
+  for (size_t label = 0; label < labels.labelCount && labels.valid; ++label) {
+    bool paired = false;
+    for (size_t p = 0; p < pairs; ++p) {
+      paired = paired || a[p] == label;
+    }
+    if (!paired) {
+      labels.output[labels.outputCount++] = label;
+    }
+  }
+  return labels;
+}
+
+// Loop l runs over extents[l] values, advancing operand k by strides[k][l] and the output by
+// outputStrides[l]. consistent is false when axes sharing a label have different extents.
+template<size_t labelCount, size_t operandCount, size_t outputRank>
+struct ContractionPlan {
+  std::array<size_t, labelCount> extents{};
+  std::array<std::array<size_t, labelCount>, operandCount> strides{};
+  std::array<size_t, labelCount> outputStrides{};
+  std::array<size_t, outputRank> outputExtents{};
+  bool consistent = true;
+};
+
+template<size_t labelCount, size_t operandCount, size_t outputRank, size_t axes>
+constexpr ContractionPlan<labelCount, operandCount, outputRank> PlanContraction(
+  const ContractionLabels& labels,
+  const std::array<size_t, axes>& axisExtents,
+  const std::array<size_t, axes>& axisStrides
+)
+{
+  // Strides by label, repeated labels within an operand walk its diagonal
+  ContractionPlan<labelCount, operandCount, outputRank> byLabel;
+  size_t axis = 0;
+  for (size_t k = 0; k < operandCount; ++k) {
+    for (size_t r = 0; r < labels.ranks[k]; ++r, ++axis) {
+      size_t label = labels.input[axis];
+      size_t& extent = byLabel.extents[label];
+      byLabel.consistent = byLabel.consistent && (extent == 0 || extent == axisExtents[axis]);
+      extent = axisExtents[axis];
+      byLabel.strides[k][label] += axisStrides[axis];
+    }
+  }
+
+  // The output is row major
+  size_t product = 1;
+  for (size_t o = outputRank; o-- > 0;) {
+    size_t label = labels.output[o];
+    byLabel.outputExtents[o] = byLabel.extents[label];
+    byLabel.outputStrides[label] = product;
+    product *= byLabel.extents[label];
+  }
+
+  // Stable insertion sort of the labels by the sum of their strides, largest first
+  std::array<size_t, labelCount> weight{};
+  std::array<size_t, labelCount> order{};
+  for (size_t l = 0; l < labelCount; ++l) {
+    weight[l] = byLabel.outputStrides[l];
+    for (size_t k = 0; k < operandCount; ++k) {
+      weight[l] += byLabel.strides[k][l];
+    }
+    size_t i = l;
+    for (; i > 0 && weight[order[i - 1]] < weight[l]; --i) {
+      order[i] = order[i - 1];
+    }
+    order[i] = l;
+  }
+
+  ContractionPlan<labelCount, operandCount, outputRank> plan = byLabel;
+  for (size_t l = 0; l < labelCount; ++l) {
+    plan.extents[l] = byLabel.extents[order[l]];
+    plan.outputStrides[l] = byLabel.outputStrides[order[l]];
+    for (size_t k = 0; k < operandCount; ++k) {
+      plan.strides[k][l] = byLabel.strides[k][order[l]];
+    }
+  }
+  return plan;
+}
+
+// Operands are tensors, read through their flat layout, or views, read through their strides
+template<typename T>
+constexpr std::array<size_t, T::DimensionType::rank> ContractionStrides()
+{
+  if constexpr (IsTensorClassV<T>) {
+    return T::DimensionType::TailProducts();
+  } else {
+    return T::strides;
+  }
+}
+
+template<typename T>
+constexpr auto ContractionData(const T& t)
+{
+  if constexpr (IsTensorClassV<T>) {
+    return &t[0];
+  } else {
+    return static_cast<const typename T::ScalarType*>(t.Data());
+  }
+}
+
+// Extents, or strides, of the axes of all operands in order
+template<bool extents, typename... Ts>
+constexpr auto ConcatOperandAxes()
+{
+  std::array<size_t, (Ts::DimensionType::rank + ...)> all{};
+  size_t i = 0;
+  auto append = [&](const auto& values) {
+    for (size_t value : values) {
+      all[i++] = value;
+    }
+  };
+  if constexpr (extents) {
+    (append(Ts::DimensionType::extents), ...);
+  } else {
+    (append(ContractionStrides<Ts>()), ...);
+  }
+  return all;
+}
+
+template<typename Labels, typename... Ts>
+struct ContractionPlanOf {
+  static constexpr ContractionLabels labels = Labels::value;
+  static constexpr auto value =
+    PlanContraction<labels.labelCount, sizeof...(Ts), labels.outputCount>(
+      labels, ConcatOperandAxes<true, Ts...>(), ConcatOperandAxes<false, Ts...>()
+    );
+};
+
+template<typename Plan, typename Seq = std::make_index_sequence<Plan::labels.outputCount>>
+struct ContractionDimension;
+
+template<typename Plan, size_t... os>
+struct ContractionDimension<Plan, std::index_sequence<os...>> {
+  using Type = TDimension<Plan::value.outputExtents[os]...>;
+};
+
+// The loops of plan from level inward, out and ps... at the first element of the level
+template<typename Plan, size_t level, typename R, size_t... ks, typename... Ss>
+constexpr void ContractLoops(R* out, std::index_sequence<ks...> operands, const Ss*... ps)
+{
+  constexpr auto& plan = Plan::value;
+  if constexpr (level == plan.extents.size()) {
+    *out += (*ps * ...);
+  } else {
+    for (size_t i = 0; i < plan.extents[level]; ++i) {
+      ContractLoops<Plan, level + 1>(
+        out + i * plan.outputStrides[level], operands, (ps + i * plan.strides[ks][level])...
+      );
+    }
+  }
+}
+
+template<typename Labels, typename... Ts>
+constexpr auto ContractOperands(const Ts&... ts)
+{
+  static_assert(
+    ((IsTensorClassV<Ts> || IsStridedViewClassV<Ts>) && ...),
+    "Contractions take tensors and tensor views."
+  );
+  using Plan = ContractionPlanOf<Labels, Ts...>;
+  static_assert(Plan::value.consistent, "Axes sharing a label must have the same extent.");
+
+  using Scalar = std::decay_t<decltype((std::declval<typename Ts::ScalarType>() * ...))>;
+  if constexpr (Plan::labels.outputCount == 0) {
+    Scalar result{};
+    ContractLoops<Plan, 0>(&result, std::index_sequence_for<Ts...>{}, ContractionData(ts)...);
+    return result;
+  } else {
+    MakeTensorFromDimensionT<Scalar, typename ContractionDimension<Plan>::Type> result{};
+    ContractLoops<Plan, 0>(&result[0], std::index_sequence_for<Ts...>{}, ContractionData(ts)...);
+    return result;
+  }
+}
+
+template<const char* subscripts>
+struct EinsumLabels {
+  static constexpr ContractionLabels value = ParseEinsum(subscripts);
+};
+
+template<typename... Ts>
+constexpr bool EinsumRanksMatch(const ContractionLabels& labels)
+{
+  constexpr std::array<size_t, sizeof...(Ts)> ranks = {Ts::DimensionType::rank...};
+  for (size_t k = 0; k < ranks.size(); ++k) {
+    if (labels.ranks[k] != ranks[k]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<const char* subscripts, typename... Ts>
+constexpr auto Einsum(const Ts&... ts)
+{
+  constexpr ContractionLabels labels = EinsumLabels<subscripts>::value;
+  static_assert(labels.valid, "Einsum subscripts must be labels a-z A-Z, commas and one ->.");
+  static_assert(labels.operandCount == sizeof...(Ts), "Einsum takes an operand per subscript.");
+
+  static_assert(
+    EinsumRanksMatch<Ts...>(labels),
+    "Einsum subscripts must have a label per axis of their operand."
+  );
+
+  return ContractOperands<EinsumLabels<subscripts>>(ts...);
+}
+
+template<typename AxesA, typename AxesB, size_t rankA, size_t rankB>
+struct ContractLabels {
+  static constexpr ContractionLabels value = ContractAxesLabels(rankA, rankB, AxesA{}, AxesB{});
+};
+
+template<typename AxesA, typename AxesB, typename TA, typename TB>
+constexpr auto Contract(const TA& a, const TB& b)
+{
+  using Labels = ContractLabels<AxesA, AxesB, TA::DimensionType::rank, TB::DimensionType::rank>;
+  static_assert(
+    Labels::value.valid, "Contract takes as many distinct axes of a as of b, within their ranks."
+  );
+  return ContractOperands<Labels>(a, b);
+}
\ No newline at end of file
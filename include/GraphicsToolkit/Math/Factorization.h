@@ -0,0 +1,504 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "DynamicTensor.h"
+#include "Matrix.h"
+#include "Simd.h"
+#include "Tensor.h"
+#include "TensorSoA.h"
+
+// Matrix factorizations that are computed once and then solve any number of right hand sides
+//   LU         PA = LU with partial pivoting, square systems
+//   Cholesky   A = L L^T, symmetric positive definite systems
+//   QR         A = QR with Householder reflections, least squares for m >= n
+//
+// Each factors a fixed size Matrix or a rank 2 DynamicTensor. Solve takes a vector, a matrix
+// whose columns are right hand sides or a TensorSoA of vectors, and returns the same kind of
+// tensor. Right hand sides are solved together: every step of a substitution is a row operation
+// across all of them, and large batches are split into column blocks that stay in cache while
+// the factor is streamed past them.
+//
+// Failure to factor is not an error, IsSingular, IsPositiveDefinite and IsFullRank report it and
+// solving then produces infinite or NaN elements. Mismatched shapes throw.
+
+// y[0, n) -= a x[0, n)
+template<typename Scalar>
+void SubtractScaledRow(Scalar* y, const Scalar* x, Scalar a, size_t n)
+{
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    Packet p = Packet::Broadcast(a);
+    for (; i + Packet::width <= n; i += Packet::width) {
+      (Packet::Load(y + i) - p * Packet::Load(x + i)).Store(y + i);
+    }
+  }
+  for (; i < n; ++i) {
+    y[i] -= a * x[i];
+  }
+}
+
+// Columns of right hand sides solved per block, so a block of an n row system stays in L2
+template<typename Scalar>
+size_t SolveBlockColumns(size_t rows)
+{
+  constexpr size_t budget = (256 * 1024) / sizeof(Scalar);
+  constexpr size_t minimum = 64 / sizeof(Scalar);
+  return std::max(minimum, budget / std::max<size_t>(rows, 1) / minimum * minimum);
+}
+
+// Substitutions on a row major system x with k columns and leading dimension ldx, in place
+
+// Solves L x = x for a unit lower triangular L in the n x n row major lu
+template<typename Scalar>
+void SolveUnitLower(const Scalar* lu, size_t n, Scalar* x, size_t ldx, size_t k)
+{
+  for (size_t i = 1; i < n; ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      SubtractScaledRow(x + i * ldx, x + j * ldx, lu[i * n + j], k);
+    }
+  }
+}
+
+// Solves U x = x for U on and above the diagonal of the row major r, whose rows are ldr apart
+template<typename Scalar>
+void SolveUpper(const Scalar* r, size_t ldr, size_t n, Scalar* x, size_t ldx, size_t k)
+{
+  for (size_t i = n; i-- > 0;) {
+    for (size_t j = i + 1; j < n; ++j) {
+      SubtractScaledRow(x + i * ldx, x + j * ldx, r[i * ldr + j], k);
+    }
+    Scalar inv = Scalar{1} / r[i * ldr + i];
+    for (size_t c = 0; c < k; ++c) {
+      x[i * ldx + c] *= inv;
+    }
+  }
+}
+
+// Solves L x = x for L on and below the diagonal of the n x n row major l
+template<typename Scalar>
+void SolveLower(const Scalar* l, size_t n, Scalar* x, size_t ldx, size_t k)
+{
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < i; ++j) {
+      SubtractScaledRow(x + i * ldx, x + j * ldx, l[i * n + j], k);
+    }
+    Scalar inv = Scalar{1} / l[i * n + i];
+    for (size_t c = 0; c < k; ++c) {
+      x[i * ldx + c] *= inv;
+    }
+  }
+}
+
+// Solves L^T x = x, row i of L updates every row above it once x_i is known
+template<typename Scalar>
+void SolveLowerTransposed(const Scalar* l, size_t n, Scalar* x, size_t ldx, size_t k)
+{
+  for (size_t i = n; i-- > 0;) {
+    Scalar inv = Scalar{1} / l[i * n + i];
+    for (size_t c = 0; c < k; ++c) {
+      x[i * ldx + c] *= inv;
+    }
+    for (size_t j = 0; j < i; ++j) {
+      SubtractScaledRow(x + j * ldx, x + i * ldx, l[i * n + j], k);
+    }
+  }
+}
+
+// Factors the row major n x n symmetric a in place into L L^T, L on and below the diagonal.
+// Only the lower triangle of a is read. Returns false when a is not positive definite.
+template<typename Scalar>
+bool CholeskyFactor(Scalar* a, size_t n)
+{
+  for (size_t j = 0; j < n; ++j) {
+    Scalar* rowJ = a + j * n;
+    Scalar d = rowJ[j];
+    for (size_t k = 0; k < j; ++k) {
+      d -= rowJ[k] * rowJ[k];
+    }
+    if (!(d > Scalar{})) {
+      return false;
+    }
+    rowJ[j] = std::sqrt(d);
+    Scalar inv = Scalar{1} / rowJ[j];
+    for (size_t i = j + 1; i < n; ++i) {
+      Scalar* rowI = a + i * n;
+      Scalar sum = rowI[j];
+      for (size_t k = 0; k < j; ++k) {
+        sum -= rowI[k] * rowJ[k];
+      }
+      rowI[j] = sum * inv;
+    }
+    for (size_t k = j + 1; k < n; ++k) {
+      rowJ[k] = Scalar{};
+    }
+  }
+  return true;
+}
+
+// Applies the reflection I - tau v v^T to the rows [j, m) of x, v[j] = 1 implied and v[i] stored
+// in column j of the row major qr below the diagonal. w holds the k columns of v^T x.
+template<typename Scalar>
+void ApplyReflection(
+  const Scalar* qr,
+  size_t n,
+  size_t m,
+  size_t j,
+  Scalar tau,
+  Scalar* x,
+  size_t ldx,
+  size_t k,
+  Scalar* w
+)
+{
+  if (tau == Scalar{}) {
+    return;
+  }
+  std::copy(x + j * ldx, x + j * ldx + k, w);
+  for (size_t i = j + 1; i < m; ++i) {
+    SubtractScaledRow(w, x + i * ldx, -qr[i * n + j], k);
+  }
+  SubtractScaledRow(x + j * ldx, w, tau, k);
+  for (size_t i = j + 1; i < m; ++i) {
+    SubtractScaledRow(x + i * ldx, w, tau * qr[i * n + j], k);
+  }
+}
+
+// Factors the row major m x n a, m >= n, in place with Householder reflections: R on and above
+// the diagonal, the reflection vectors below it and their scales in tau
+template<typename Scalar>
+void QrFactor(Scalar* a, size_t m, size_t n, Scalar* tau)
+{
+  std::vector<Scalar> w(n);
+  for (size_t j = 0; j < n; ++j) {
+    Scalar alpha = a[j * n + j];
+    Scalar tail = 0;
+    for (size_t i = j + 1; i < m; ++i) {
+      tail += a[i * n + j] * a[i * n + j];
+    }
+    if (tail == Scalar{}) {
+      tau[j] = Scalar{};
+      continue;
+    }
+
+    Scalar norm = std::sqrt(alpha * alpha + tail);
+    Scalar beta = alpha >= Scalar{} ? -norm : norm;
+    tau[j] = (beta - alpha) / beta;
+    Scalar scale = Scalar{1} / (alpha - beta);
+    for (size_t i = j + 1; i < m; ++i) {
+      a[i * n + j] *= scale;
+    }
+    a[j * n + j] = beta;
+
+    // The remaining columns, as the rows [j, m) of the sub matrix starting at column j + 1
+    ApplyReflection(a, n, m, j, tau[j], a + j + 1, n, n - j - 1, w.data());
+  }
+}
+
+// Shapes and storage of the matrices a factorization accepts
+
+template<typename MatrixType>
+struct FactorTraits;
+
+template<typename S, typename Storage, size_t r, size_t c>
+struct FactorTraits<BasicTensor<S, Storage, r, c>> {
+  using ScalarType = S;
+  using StorageType = Matrix<S, r, c>;
+  using RowIndices = std::array<size_t, r>;
+  using ColumnScalars = std::array<S, c>;
+
+  static StorageType Copy(const BasicTensor<S, Storage, r, c>& m) { return StorageType(m); }
+  static size_t Rows(const StorageType&) { return r; }
+  static size_t Cols(const StorageType&) { return c; }
+  static RowIndices MakeRowIndices(size_t) { return {}; }
+  static ColumnScalars MakeColumnScalars(size_t) { return {}; }
+  static S* Data(StorageType& m) { return &m[0]; }
+  static const S* Data(const StorageType& m) { return &m[0]; }
+
+  // Solutions have one row per column of the factored matrix
+  template<typename S2, typename St2, size_t m, size_t... k>
+  static Tensor<S, c, k...> MakeSolution(const BasicTensor<S2, St2, m, k...>&)
+  {
+    static_assert(m == r, "Right hand sides must have as many rows as the factored matrix.");
+    static_assert(std::is_same_v<S, S2>, "Right hand sides must have the scalar of the matrix.");
+    return {};
+  }
+};
+
+template<typename S>
+struct FactorTraits<DynamicTensor<S>> {
+  using ScalarType = S;
+  using StorageType = DynamicTensor<S>;
+  using RowIndices = std::vector<size_t>;
+  using ColumnScalars = std::vector<S>;
+
+  static StorageType Copy(const DynamicTensor<S>& m)
+  {
+    if (m.Rank() != 2) {
+      throw std::invalid_argument("Factorizations require matrices.");
+    }
+    return m;
+  }
+  static size_t Rows(const StorageType& m) { return m.Shape()[0]; }
+  static size_t Cols(const StorageType& m) { return m.Shape()[1]; }
+  static RowIndices MakeRowIndices(size_t rows) { return RowIndices(rows); }
+  static ColumnScalars MakeColumnScalars(size_t cols) { return ColumnScalars(cols); }
+  static S* Data(StorageType& m) { return m.Data(); }
+  static const S* Data(const StorageType& m) { return m.Data(); }
+
+  static DynamicTensor<S> MakeSolution(const DynamicTensor<S>& b, size_t rows, size_t cols)
+  {
+    if (b.Rank() < 1 || b.Rank() > 2 || b.Shape()[0] != rows) {
+      throw std::invalid_argument(
+        "Right hand sides must have as many rows as the factored matrix."
+      );
+    }
+    DynamicShape shape = b.Shape();
+    shape[0] = cols;
+    return DynamicTensor<S>(shape);
+  }
+};
+
+// Runs solve(x, ldx, k, scratch) over the right hand sides b, m rows of them, written to the
+// first rows of x, n rows of solution, a block of columns at a time. The scratch vector is kept
+// across blocks, solves size it as they need.
+template<typename Scalar, typename Solve>
+void SolveBlocks(
+  const Scalar* b,
+  size_t ldb,
+  size_t m,
+  Scalar* x,
+  size_t ldx,
+  size_t n,
+  size_t k,
+  const Solve& solve
+)
+{
+  size_t block = SolveBlockColumns<Scalar>(std::max(m, n));
+  std::vector<Scalar> scratch;
+  std::vector<Scalar> solveScratch;
+  for (size_t c = 0; c < k; c += block) {
+    size_t kb = std::min(block, k - c);
+
+    // Systems with more equations than unknowns need the extra rows while solving
+    Scalar* work = x + c;
+    size_t ldw = ldx;
+    if (m > n) {
+      scratch.resize(m * kb);
+      work = scratch.data();
+      ldw = kb;
+    }
+    for (size_t i = 0; i < m; ++i) {
+      std::copy(b + i * ldb + c, b + i * ldb + c + kb, work + i * ldw);
+    }
+    solve(work, ldw, kb, solveScratch);
+    if (m > n) {
+      for (size_t i = 0; i < n; ++i) {
+        std::copy(work + i * ldw, work + i * ldw + kb, x + i * ldx + c);
+      }
+    }
+  }
+}
+
+// Shared by the factorizations: the factored matrix, its shape and Solve over every kind of right
+// hand side through Derived::SolveInPlace(x, ldx, k, scratch), which turns m rows of right hand
+// sides into n rows of solutions
+template<typename Derived, typename MatrixType>
+class Factorization
+{
+protected:
+  using Traits = FactorTraits<MatrixType>;
+
+public:
+  using ScalarType = typename Traits::ScalarType;
+
+  static_assert(
+    std::is_floating_point_v<ScalarType>, "Factorizations require floating point matrices."
+  );
+
+  size_t Rows() const { return Traits::Rows(factor); }
+  size_t Cols() const { return Traits::Cols(factor); }
+
+  template<typename Rhs>
+  auto Solve(const Rhs& b) const
+  {
+    if constexpr (IsTensorSoAClassV<Rhs>) {
+      using VectorType = typename Rhs::ElementType;
+      static_assert(VectorType::rank == 1, "Batches of right hand sides must hold vectors.");
+      if (VectorType::count != Rows()) {
+        throw std::invalid_argument(
+          "Right hand sides must have as many rows as the factored matrix."
+        );
+      }
+      if constexpr (std::is_same_v<MatrixType, DynamicTensor<ScalarType>>) {
+        static_assert(!sizeof(Rhs), "Batches solve against fixed size factorizations.");
+      } else {
+        constexpr size_t cols = DimGet<typename MatrixType::DimensionType, 1>;
+        TensorSoA<Vector<ScalarType, cols>> x(b.Size());
+        SolveInto(b.Lane(0), b.Capacity(), x.Lane(0), x.Capacity(), b.Size());
+        return x;
+      }
+    } else {
+      if constexpr (IsTensorClassV<Rhs>) {
+        auto x = Traits::MakeSolution(b);
+        size_t k = Rhs::count / Rows();
+        SolveInto(&b[0], k, &x[0], k, k);
+        return x;
+      } else {
+        DynamicTensor<ScalarType> x = Traits::MakeSolution(b, Rows(), Cols());
+        size_t k = b.Count() / Rows();
+        SolveInto(b.Data(), k, x.Data(), k, k);
+        return x;
+      }
+    }
+  }
+
+protected:
+  explicit Factorization(const MatrixType& a) : factor{Traits::Copy(a)} {}
+
+  void SolveInto(const ScalarType* b, size_t ldb, ScalarType* x, size_t ldx, size_t k) const
+  {
+    auto solve = [this](ScalarType* w, size_t ldw, size_t kb, std::vector<ScalarType>& scratch) {
+      static_cast<const Derived*>(this)->SolveInPlace(w, ldw, kb, scratch);
+    };
+    SolveBlocks(b, ldb, Rows(), x, ldx, Cols(), k, solve);
+  }
+
+  const ScalarType* Data() const { return Traits::Data(factor); }
+
+  typename Traits::StorageType factor;
+};
+
+template<typename MatrixType>
+class LU : public Factorization<LU<MatrixType>, MatrixType>
+{
+  using Base = Factorization<LU<MatrixType>, MatrixType>;
+  using Traits = typename Base::Traits;
+  friend Base;
+
+public:
+  using ScalarType = typename Base::ScalarType;
+
+  explicit LU(const MatrixType& a) : Base{a}, perm{Traits::MakeRowIndices(this->Rows())}
+  {
+    if (this->Rows() != this->Cols()) {
+      throw std::invalid_argument("LU requires a square matrix.");
+    }
+    sign = LuFactor(Traits::Data(this->factor), this->Rows(), perm.data());
+  }
+
+  bool IsSingular() const { return sign == 0; }
+
+  ScalarType Det() const
+  {
+    ScalarType det = static_cast<ScalarType>(sign);
+    for (size_t i = 0; i < this->Rows(); ++i) {
+      det *= this->Data()[i * this->Rows() + i];
+    }
+    return det;
+  }
+
+private:
+  void SolveInPlace(ScalarType* x, size_t ldx, size_t k, std::vector<ScalarType>& scratch) const
+  {
+    size_t n = this->Rows();
+
+    // Apply the row permutation through a copy of the k columns of the block
+    scratch.resize(n * k);
+    for (size_t i = 0; i < n; ++i) {
+      std::copy_n(x + i * ldx, k, scratch.data() + i * k);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      std::copy_n(scratch.data() + perm[i] * k, k, x + i * ldx);
+    }
+    SolveUnitLower(this->Data(), n, x, ldx, k);
+    SolveUpper(this->Data(), n, n, x, ldx, k);
+  }
+
+  typename Traits::RowIndices perm;
+  int sign = 0;
+};
+
+template<typename MatrixType>
+class Cholesky : public Factorization<Cholesky<MatrixType>, MatrixType>
+{
+  using Base = Factorization<Cholesky<MatrixType>, MatrixType>;
+  using Traits = typename Base::Traits;
+  friend Base;
+
+public:
+  using ScalarType = typename Base::ScalarType;
+
+  explicit Cholesky(const MatrixType& a) : Base{a}
+  {
+    if (this->Rows() != this->Cols()) {
+      throw std::invalid_argument("Cholesky requires a square matrix.");
+    }
+    positiveDefinite = CholeskyFactor(Traits::Data(this->factor), this->Rows());
+  }
+
+  bool IsPositiveDefinite() const { return positiveDefinite; }
+
+  // The lower triangular factor
+  const typename Traits::StorageType& L() const { return this->factor; }
+
+private:
+  void SolveInPlace(ScalarType* x, size_t ldx, size_t k, std::vector<ScalarType>&) const
+  {
+    SolveLower(this->Data(), this->Rows(), x, ldx, k);
+    SolveLowerTransposed(this->Data(), this->Rows(), x, ldx, k);
+  }
+
+  bool positiveDefinite = false;
+};
+
+// Solve returns the least squares solution, minimizing |A x - b|
+template<typename MatrixType>
+class QR : public Factorization<QR<MatrixType>, MatrixType>
+{
+  using Base = Factorization<QR<MatrixType>, MatrixType>;
+  using Traits = typename Base::Traits;
+  friend Base;
+
+public:
+  using ScalarType = typename Base::ScalarType;
+
+  explicit QR(const MatrixType& a) : Base{a}, tau{Traits::MakeColumnScalars(this->Cols())}
+  {
+    if (this->Rows() < this->Cols()) {
+      throw std::invalid_argument("QR requires at least as many rows as columns.");
+    }
+    QrFactor(Traits::Data(this->factor), this->Rows(), this->Cols(), tau.data());
+  }
+
+  bool IsFullRank() const
+  {
+    for (size_t i = 0; i < this->Cols(); ++i) {
+      if (this->Data()[i * this->Cols() + i] == ScalarType{}) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  void SolveInPlace(ScalarType* x, size_t ldx, size_t k, std::vector<ScalarType>& scratch) const
+  {
+    size_t m = this->Rows();
+    size_t n = this->Cols();
+    scratch.resize(k);
+    for (size_t j = 0; j < n; ++j) {
+      ApplyReflection(this->Data(), n, m, j, tau[j], x, ldx, k, scratch.data());
+    }
+    SolveUpper(this->Data(), n, n, x, ldx, k);
+  }
+
+  typename Traits::ColumnScalars tau;
+};
\ No newline at end of file
@@ -1,56 +1,932 @@
 #pragma once
 
-#include <Tensor.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "DynamicTensor.h"
+#include "Execution.h"
+#include "Simd.h"
+#include "Tensor.h"
+#include "TensorView.h"
 
 template<typename Scalar, size_t row, size_t col>
 using Matrix = Tensor<Scalar, row, col>;
 
-template<typename S1, typename S2, size_t r1, size_t c1r2, size_t c2>
-constexpr auto Mul(const Matrix<S1, r1, c1r2>& lhs, const Matrix<S2, c1r2, c2>& rhs)
+
+// Matrix multiplication
+//
+// Up to 4x4 the products are unrolled, each row of the result a sum of broadcast lhs elements
+// times rhs rows when a row fits a packet. Larger products, fixed or dynamic, run a register tiled
+// microkernel over cache sized blocks of the operands, all matrices row major.
+
+// C[rows x n] += A[rows x depth] * B[depth x n] for a tile of rows x packets * width elements of C
+// held in registers, the operands read in place through their leading dimensions
+template<typename Packet, size_t rows, size_t packets, typename Scalar>
+void MulTile(
+  const Scalar* a,
+  size_t lda,
+  const Scalar* b,
+  size_t ldb,
+  Scalar* c,
+  size_t ldc,
+  size_t depth
+)
+{
+  Packet acc[rows][packets];
+  for (size_t r = 0; r < rows; ++r) {
+    for (size_t q = 0; q < packets; ++q) {
+      acc[r][q] = Packet::Load(c + r * ldc + q * Packet::width);
+    }
+  }
+  for (size_t p = 0; p < depth; ++p) {
+    Packet row[packets];
+    for (size_t q = 0; q < packets; ++q) {
+      row[q] = Packet::Load(b + p * ldb + q * Packet::width);
+    }
+    for (size_t r = 0; r < rows; ++r) {
+      Packet x = Packet::Broadcast(a[r * lda + p]);
+      for (size_t q = 0; q < packets; ++q) {
+        acc[r][q] = acc[r][q] + x * row[q];
+      }
+    }
+  }
+  for (size_t r = 0; r < rows; ++r) {
+    for (size_t q = 0; q < packets; ++q) {
+      acc[r][q].Store(c + r * ldc + q * Packet::width);
+    }
+  }
+}
+
+// C[m x n] += A[m x depth] * B[depth x n] over a block of A and B small enough to stay cached
+template<typename Packet, typename Scalar>
+void MulBlock(
+  const Scalar* a,
+  size_t lda,
+  const Scalar* b,
+  size_t ldb,
+  Scalar* c,
+  size_t ldc,
+  size_t m,
+  size_t n,
+  size_t depth
+)
+{
+  constexpr size_t mr = 4;
+  constexpr size_t width = Packet::width;
+  size_t nWide = n - n % (2 * width);
+  size_t nPackets = n - n % width;
+
+  // Every tile of a strip of rows reuses the strip of A from L1
+  auto strip = [&](auto rowCount, size_t i) {
+    constexpr size_t rows = decltype(rowCount)::value;
+    const Scalar* ai = a + i * lda;
+    Scalar* ci = c + i * ldc;
+    size_t j = 0;
+    for (; j < nWide; j += 2 * width) {
+      MulTile<Packet, rows, 2>(ai, lda, b + j, ldb, ci + j, ldc, depth);
+    }
+    if (j < nPackets) {
+      MulTile<Packet, rows, 1>(ai, lda, b + j, ldb, ci + j, ldc, depth);
+      j += width;
+    }
+    for (; j < n; ++j) {
+      for (size_t r = 0; r < rows; ++r) {
+        Scalar sum = ci[r * ldc + j];
+        for (size_t p = 0; p < depth; ++p) {
+          sum += ai[r * lda + p] * b[p * ldb + j];
+        }
+        ci[r * ldc + j] = sum;
+      }
+    }
+  };
+
+  size_t i = 0;
+  for (; i + mr <= m; i += mr) {
+    strip(std::integral_constant<size_t, mr>{}, i);
+  }
+  for (; i < m; ++i) {
+    strip(std::integral_constant<size_t, 1>{}, i);
+  }
+}
+
+// C[m x n] = A[m x depth] * B[depth x n], the rows of A and B lda and ldb elements apart. C must
+// not alias A or B.
+template<typename S1, typename S2, typename R>
+void MulInto(
+  const S1* a,
+  size_t lda,
+  const S2* b,
+  size_t ldb,
+  R* c,
+  size_t m,
+  size_t depth,
+  size_t n
+)
+{
+  std::fill_n(c, m * n, R{});
+
+  if constexpr (std::is_same_v<S1, R> && std::is_same_v<S2, R> && gtk::simd::HasNativePacketV<R>) {
+    using Packet = gtk::simd::NativePacketT<R>;
+
+    // A block of B, kc x nc, stays in L2 while strips of A stream past it
+    constexpr size_t kc = 128;
+    constexpr size_t nc = 512;
+    for (size_t p = 0; p < depth; p += kc) {
+      size_t kb = std::min(kc, depth - p);
+      for (size_t j = 0; j < n; j += nc) {
+        size_t nb = std::min(nc, n - j);
+        MulBlock<Packet>(a + p, lda, b + p * ldb + j, ldb, c + j, n, m, nb, kb);
+      }
+    }
+  } else {
+    for (size_t i = 0; i < m; ++i) {
+      for (size_t p = 0; p < depth; ++p) {
+        auto x = a[i * lda + p];
+        for (size_t j = 0; j < n; ++j) {
+          c[i * n + j] += x * b[p * ldb + j];
+        }
+      }
+    }
+  }
+}
+
+template<typename S1, typename S2, typename R>
+void MulInto(const S1* a, const S2* b, R* c, size_t m, size_t depth, size_t n)
 {
-  using ResultType = Matrix<decltype(S1{} * S2{}), r1, c2>;
+  MulInto(a, depth, b, n, c, m, depth, n);
+}
+
+// Same product under an execution policy, chunks of rows of C are computed in parallel
+template<
+  typename Policy,
+  typename S1,
+  typename S2,
+  typename R,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void MulInto(
+  const Policy& policy,
+  const S1* a,
+  size_t lda,
+  const S2* b,
+  size_t ldb,
+  R* c,
+  size_t m,
+  size_t depth,
+  size_t n
+)
+{
+  gtk::exec::ForEachChunk(policy, m, depth * n, [&](size_t first, size_t last) {
+    MulInto(a + first * lda, lda, b, ldb, c + first * n, last - first, depth, n);
+  });
+}
+
+template<size_t i, size_t j, typename Lhs, typename Rhs, size_t... ks>
+constexpr auto MulEntry(const Lhs& lhs, const Rhs& rhs, std::index_sequence<ks...>)
+{
+  return ((lhs(i, ks) * rhs(ks, j)) + ...);
+}
+
+// Every element of the result as one expression, for matrices too small to fill packet rows
+template<size_t depth, size_t n, typename R, typename Lhs, typename Rhs, size_t... ijs>
+constexpr void MulUnrolled(R& result, const Lhs& lhs, const Rhs& rhs, std::index_sequence<ijs...>)
+{
+  ((result[ijs] = MulEntry<ijs / n, ijs % n>(lhs, rhs, std::make_index_sequence<depth>{})), ...);
+}
+
+// Row i of the result is the sum of lhs(i, k) times row k of rhs, a row per packet
+template<typename Packet, size_t depth, typename R, typename Lhs, size_t... rows>
+void MulRows(R* result, const Lhs& lhs, const R* rhs, std::index_sequence<rows...>)
+{
+  auto row = [&](size_t i) {
+    Packet sum = Packet::Broadcast(lhs(i, 0)) * Packet::Load(rhs);
+    for (size_t k = 1; k < depth; ++k) {
+      sum = sum + Packet::Broadcast(lhs(i, k)) * Packet::Load(rhs + k * Packet::width);
+    }
+    sum.Store(result + i * Packet::width);
+  };
+  (row(rows), ...);
+}
+
+template<typename S1, typename St1, typename S2, typename St2, size_t r1, size_t c1r2, size_t c2>
+constexpr auto
+Mul(const BasicTensor<S1, St1, r1, c1r2>& lhs, const BasicTensor<S2, St2, c1r2, c2>& rhs)
+{
+  using Scalar = decltype(S1{} * S2{});
+  using ResultType = Matrix<Scalar, r1, c2>;
   ResultType result{};
-  for (size_t i = 0; i < r1; ++i) {
-    for (size_t j = 0; j < c2; ++j) {
+
+  if constexpr (r1 <= 4 && c1r2 <= 4 && c2 <= 4) {
+    using Packet = gtk::simd::Packet<Scalar, c2>;
+    if constexpr (Packet::supported && std::is_same_v<S2, Scalar>) {
+      if (!gtk::simd::IsConstantEvaluated()) {
+        MulRows<Packet, c1r2>(&result[0], lhs, &rhs[0], std::make_index_sequence<r1>{});
+        return result;
+      }
+    }
+    MulUnrolled<c1r2, c2>(result, lhs, rhs, std::make_index_sequence<r1 * c2>{});
+  } else {
+    if (!gtk::simd::IsConstantEvaluated()) {
+      MulInto(&lhs[0], &rhs[0], &result[0], r1, c1r2, c2);
+      return result;
+    }
+    for (size_t i = 0; i < r1; ++i) {
       for (size_t k = 0; k < c1r2; ++k) {
-        result[i][j] += lhs[i][k] * rhs[k][j];
+        for (size_t j = 0; j < c2; ++j) {
+          result(i, j) += lhs(i, k) * rhs(k, j);
+        }
       }
     }
   }
   return result;
 }
 
-template<typename M1, typename M2, typename... Ms>
-constexpr auto Mul(const M1& m1, const M2& m2, const Ms&... ms)
+// Distance between the rows of a matrix operand whose rows are contiguous, 0 for other operands
+template<typename T>
+constexpr size_t MulLeadingDimension()
 {
-  auto m12 = Mul(m1, m2);
-  if constexpr (sizeof...(Ms) == 0) {
-    return m12;
+  if constexpr (IsTensorClassV<T>) {
+    return DimGet<typename T::DimensionType, 1>;
+  } else if constexpr (IsStridedViewClassV<T>) {
+    return T::strides[1] == 1 ? T::strides[0] : 0;
   } else {
-    return Mul(m12, ms...);
+    return 0;
   }
 }
 
-template<typename S, size_t r, size_t c>
-constexpr auto Transposed(const Matrix<S, r, c>& m)
+template<typename Lhs, typename Rhs>
+inline constexpr bool IsMulViewOperandsV =
+  (IsTensorViewClassV<Lhs> || IsTensorViewClassV<Rhs>) &&
+  (IsTensorClassV<Lhs> || IsTensorViewClassV<Lhs>) &&
+  (IsTensorClassV<Rhs> || IsTensorViewClassV<Rhs>);
+
+// Products with matrix views. The unrolled products read views in place, as does the blocked one
+// when the rows of both operands are contiguous, other views are copied to matrices first.
+template<typename Lhs, typename Rhs, typename = std::enable_if_t<IsMulViewOperandsV<Lhs, Rhs>>>
+constexpr auto Mul(const Lhs& lhs, const Rhs& rhs)
 {
-  using ResultType = Matrix<S, c, r>;
-  ResultType result{};
+  using D1 = typename Lhs::DimensionType;
+  using D2 = typename Rhs::DimensionType;
+  static_assert(D1::rank == 2 && D2::rank == 2, "Mul requires matrices.");
+  static_assert(DimGet<D1, 1> == DimGet<D2, 0>, "Inner dimensions of the matrices must match.");
+  constexpr size_t r1 = DimGet<D1, 0>;
+  constexpr size_t depth = DimGet<D1, 1>;
+  constexpr size_t c2 = DimGet<D2, 1>;
+  using S1 = typename Lhs::ScalarType;
+  using S2 = typename Rhs::ScalarType;
+
+  if constexpr (r1 <= 4 && depth <= 4 && c2 <= 4) {
+    Matrix<decltype(S1{} * S2{}), r1, c2> result{};
+    MulUnrolled<depth, c2>(result, lhs, rhs, std::make_index_sequence<r1 * c2>{});
+    return result;
+  } else {
+    constexpr size_t lda = MulLeadingDimension<Lhs>();
+    constexpr size_t ldb = MulLeadingDimension<Rhs>();
+    if constexpr (lda > 0 && ldb > 0) {
+      if (!gtk::simd::IsConstantEvaluated()) {
+        Matrix<decltype(S1{} * S2{}), r1, c2> result{};
+        MulInto(&lhs(0, 0), lda, &rhs(0, 0), ldb, &result[0], r1, depth, c2);
+        return result;
+      }
+    }
+    return Mul(Matrix<S1, r1, depth>(lhs), Matrix<S2, depth, c2>(rhs));
+  }
+}
+
+// Dynamic matrices, throws when either operand is not a matrix or their shapes do not match
+template<typename S1, typename S2>
+auto Mul(const DynamicTensor<S1>& lhs, const DynamicTensor<S2>& rhs)
+{
+  if (lhs.Rank() != 2 || rhs.Rank() != 2) {
+    throw std::invalid_argument("Mul requires matrices.");
+  }
+  if (lhs.Shape()[1] != rhs.Shape()[0]) {
+    throw std::invalid_argument("Inner dimensions of the matrices must match.");
+  }
+
+  size_t m = lhs.Shape()[0];
+  size_t depth = lhs.Shape()[1];
+  size_t n = rhs.Shape()[1];
+  DynamicTensor<decltype(S1{} * S2{})> result({m, n});
+  MulInto(lhs.Data(), rhs.Data(), result.Data(), m, depth, n);
+  return result;
+}
+
+// Products of large matrices under an execution policy
+template<
+  typename Policy,
+  typename S1,
+  typename St1,
+  typename S2,
+  typename St2,
+  size_t r1,
+  size_t c1r2,
+  size_t c2,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+auto Mul(
+  const Policy& policy,
+  const BasicTensor<S1, St1, r1, c1r2>& lhs,
+  const BasicTensor<S2, St2, c1r2, c2>& rhs
+)
+{
+  Matrix<decltype(S1{} * S2{}), r1, c2> result;
+  MulInto(policy, &lhs[0], c1r2, &rhs[0], c2, &result[0], r1, c1r2, c2);
+  return result;
+}
+
+template<
+  typename Policy,
+  typename S1,
+  typename S2,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+auto Mul(const Policy& policy, const DynamicTensor<S1>& lhs, const DynamicTensor<S2>& rhs)
+{
+  if (lhs.Rank() != 2 || rhs.Rank() != 2) {
+    throw std::invalid_argument("Mul requires matrices.");
+  }
+  if (lhs.Shape()[1] != rhs.Shape()[0]) {
+    throw std::invalid_argument("Inner dimensions of the matrices must match.");
+  }
+
+  size_t m = lhs.Shape()[0];
+  size_t depth = lhs.Shape()[1];
+  size_t n = rhs.Shape()[1];
+  DynamicTensor<decltype(S1{} * S2{})> result({m, n});
+  MulInto(policy, lhs.Data(), depth, rhs.Data(), n, result.Data(), m, depth, n);
+  return result;
+}
+
+// Matrix chain ordering
+//
+// The products of a chain are associative but their cost is not, (A B) v for a 4x1000 A, 1000x4 B
+// and 4x1 v takes 16016 multiplications where A (B v) takes 8000. The dimensions of fixed size
+// matrices are template parameters, so the cheapest parenthesization is found by the classic
+// O(n^3) dynamic program at compile time.
+
+// Chain of n matrices where matrix i has dims[i] rows and dims[i + 1] columns
+template<size_t n>
+struct MulChainPlan {
+  // Scalar multiplications of the cheapest product of matrices [i, j], and its last split
+  std::array<std::array<size_t, n>, n> cost{};
+  std::array<std::array<size_t, n>, n> split{};
+};
+
+template<size_t n>
+constexpr MulChainPlan<n> PlanMulChain(const std::array<size_t, n + 1>& dims)
+{
+  MulChainPlan<n> plan{};
+  for (size_t length = 2; length <= n; ++length) {
+    for (size_t i = 0; i + length <= n; ++i) {
+      size_t j = i + length - 1;
+      plan.cost[i][j] = std::numeric_limits<size_t>::max();
+      for (size_t k = i; k < j; ++k) {
+        size_t cost = plan.cost[i][k] + plan.cost[k + 1][j] + dims[i] * dims[k + 1] * dims[j + 1];
+        if (cost < plan.cost[i][j]) {
+          plan.cost[i][j] = cost;
+          plan.split[i][j] = k;
+        }
+      }
+    }
+  }
+  return plan;
+}
+
+template<typename M1, typename... Ms>
+struct MulChain {
+  static constexpr size_t length = sizeof...(Ms) + 1;
+
+  static constexpr std::array<size_t, length + 1> dims = {
+    DimGet<typename M1::DimensionType, 0>,
+    DimGet<typename M1::DimensionType, 1>,
+    DimGet<typename Ms::DimensionType, 1>...
+  };
+
+  static constexpr MulChainPlan<length> plan = PlanMulChain<length>(dims);
+
+  // Scalar multiplications of the chosen order
+  static constexpr size_t cost = plan.cost[0][length - 1];
+};
+
+template<typename... Ms>
+inline constexpr size_t MulChainCostV = MulChain<Ms...>::cost;
+
+// Product of matrices [i, j] of the chain, split where the plan says
+template<typename Chain, size_t i, size_t j, typename Tuple>
+constexpr decltype(auto) MulChainRange(const Tuple& ms)
+{
+  if constexpr (i == j) {
+    return std::get<i>(ms);
+  } else {
+    constexpr size_t k = Chain::plan.split[i][j];
+    return Mul(MulChainRange<Chain, i, k>(ms), MulChainRange<Chain, k + 1, j>(ms));
+  }
+}
+
+// Fixed size chains are multiplied in the cheapest order, dynamic ones left to right
+template<typename M1, typename M2, typename M3, typename... Ms>
+constexpr auto Mul(const M1& m1, const M2& m2, const M3& m3, const Ms&... ms)
+{
+  if constexpr (IsTensorClassV<M1> && IsTensorClassV<M2> && IsTensorClassV<M3> &&
+                (IsTensorClassV<Ms> && ...)) {
+    using Chain = MulChain<M1, M2, M3, Ms...>;
+    return MulChainRange<Chain, 0, Chain::length - 1>(std::tie(m1, m2, m3, ms...));
+  } else {
+    auto m12 = Mul(m1, m2);
+    return Mul(m12, m3, ms...);
+  }
+}
+
+// Transpose
+//
+// Square tiles are transposed in registers by the packet shuffles, a tile of each operand loaded,
+// transposed and stored in one piece. Large matrices are split in halves along their longer side
+// until a block of the source and of the destination both stay cached, so neither the row reads
+// nor the column writes miss on every element, whatever the cache sizes are. Square matrices are
+// transposed in place by the same recursion, swapping the blocks above the diagonal with the
+// transposes of those below.
+
+// Sides of the blocks the recursion stops at
+inline constexpr size_t transposeBlockSize = 32;
+
+// Both halves stay multiples of the widest register tile
+inline size_t TransposeSplit(size_t n)
+{
+  size_t half = n / 2 / 8 * 8;
+  return half > 0 ? half : n / 2;
+}
+
+template<typename Packet, typename Scalar>
+void TransposeTile(const Scalar* src, size_t lds, Scalar* dst, size_t ldd)
+{
+  Packet rows[Packet::width];
+  for (size_t i = 0; i < Packet::width; ++i) {
+    rows[i] = Packet::Load(src + i * lds);
+  }
+  Packet::Transpose(rows);
+  for (size_t i = 0; i < Packet::width; ++i) {
+    rows[i].Store(dst + i * ldd);
+  }
+}
+
+// Exchanges the tile at a with the transpose of the tile at b
+template<typename Packet, typename Scalar>
+void TransposeSwapTile(Scalar* a, Scalar* b, size_t ld)
+{
+  Packet rowsA[Packet::width];
+  Packet rowsB[Packet::width];
+  for (size_t i = 0; i < Packet::width; ++i) {
+    rowsA[i] = Packet::Load(a + i * ld);
+    rowsB[i] = Packet::Load(b + i * ld);
+  }
+  Packet::Transpose(rowsA);
+  Packet::Transpose(rowsB);
+  for (size_t i = 0; i < Packet::width; ++i) {
+    rowsA[i].Store(b + i * ld);
+    rowsB[i].Store(a + i * ld);
+  }
+}
+
+// Widest register tile fitting a rows x cols block, void when the block is narrower than any
+template<typename Scalar, typename F>
+void WithTransposeTile(size_t rows, size_t cols, const F& f)
+{
+  using Wide = gtk::simd::TransposePacketT<Scalar>;
+  using Narrow = gtk::simd::TransposePacketT<Scalar, 4>;
+  size_t side = std::min(rows, cols);
+  if constexpr (!std::is_void_v<Wide>) {
+    if (side >= Wide::width) {
+      return f(static_cast<Wide*>(nullptr));
+    }
+  }
+  if constexpr (!std::is_void_v<Narrow> && !std::is_same_v<Narrow, Wide>) {
+    if (side >= Narrow::width) {
+      return f(static_cast<Narrow*>(nullptr));
+    }
+  }
+  f(static_cast<void*>(nullptr));
+}
+
+template<typename Scalar>
+void TransposeBlock(
+  const Scalar* src,
+  size_t rows,
+  size_t cols,
+  size_t lds,
+  Scalar* dst,
+  size_t ldd
+)
+{
+  WithTransposeTile<Scalar>(rows, cols, [&](auto* tile) {
+    using Packet = std::remove_pointer_t<decltype(tile)>;
+    size_t tiledRows = 0;
+    size_t tiledCols = 0;
+    if constexpr (!std::is_void_v<Packet>) {
+      tiledRows = rows / Packet::width * Packet::width;
+      tiledCols = cols / Packet::width * Packet::width;
+      for (size_t i = 0; i < tiledRows; i += Packet::width) {
+        for (size_t j = 0; j < tiledCols; j += Packet::width) {
+          TransposeTile<Packet>(src + i * lds + j, lds, dst + j * ldd + i, ldd);
+        }
+      }
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      for (size_t j = i < tiledRows ? tiledCols : 0; j < cols; ++j) {
+        dst[j * ldd + i] = src[i * lds + j];
+      }
+    }
+  });
+}
+
+template<typename Scalar>
+void TransposeSwapBlock(Scalar* a, Scalar* b, size_t rows, size_t cols, size_t ld)
+{
+  WithTransposeTile<Scalar>(rows, cols, [&](auto* tile) {
+    using Packet = std::remove_pointer_t<decltype(tile)>;
+    size_t tiledRows = 0;
+    size_t tiledCols = 0;
+    if constexpr (!std::is_void_v<Packet>) {
+      tiledRows = rows / Packet::width * Packet::width;
+      tiledCols = cols / Packet::width * Packet::width;
+      for (size_t i = 0; i < tiledRows; i += Packet::width) {
+        for (size_t j = 0; j < tiledCols; j += Packet::width) {
+          TransposeSwapTile<Packet>(a + i * ld + j, b + j * ld + i, ld);
+        }
+      }
+    }
+    for (size_t i = 0; i < rows; ++i) {
+      for (size_t j = i < tiledRows ? tiledCols : 0; j < cols; ++j) {
+        std::swap(a[i * ld + j], b[j * ld + i]);
+      }
+    }
+  });
+}
+
+// dst[cols x rows] = src[rows x cols]^T, both read and written through their leading dimensions.
+// dst must not alias src.
+template<typename Scalar>
+void TransposeInto(
+  const Scalar* src,
+  size_t rows,
+  size_t cols,
+  size_t lds,
+  Scalar* dst,
+  size_t ldd
+)
+{
+  if (rows <= transposeBlockSize && cols <= transposeBlockSize) {
+    TransposeBlock(src, rows, cols, lds, dst, ldd);
+  } else if (rows >= cols) {
+    size_t half = TransposeSplit(rows);
+    TransposeInto(src, half, cols, lds, dst, ldd);
+    TransposeInto(src + half * lds, rows - half, cols, lds, dst + half, ldd);
+  } else {
+    size_t half = TransposeSplit(cols);
+    TransposeInto(src, rows, half, lds, dst, ldd);
+    TransposeInto(src + half, rows, cols - half, lds, dst + half * ldd, ldd);
+  }
+}
+
+// Exchanges a[rows x cols] with the transpose of b[cols x rows], the two blocks must not overlap
+template<typename Scalar>
+void TransposeSwap(Scalar* a, Scalar* b, size_t rows, size_t cols, size_t ld)
+{
+  if (rows <= transposeBlockSize && cols <= transposeBlockSize) {
+    TransposeSwapBlock(a, b, rows, cols, ld);
+  } else if (rows >= cols) {
+    size_t half = TransposeSplit(rows);
+    TransposeSwap(a, b, half, cols, ld);
+    TransposeSwap(a + half * ld, b + half, rows - half, cols, ld);
+  } else {
+    size_t half = TransposeSplit(cols);
+    TransposeSwap(a, b, rows, half, ld);
+    TransposeSwap(a + half, b + half * ld, rows, cols - half, ld);
+  }
+}
+
+// Transposes the n x n matrix a in place
+template<typename Scalar>
+void TransposeSquare(Scalar* a, size_t n, size_t ld)
+{
+  if (n <= transposeBlockSize) {
+    size_t i = 0;
+    using Packet = gtk::simd::TransposePacketT<Scalar>;
+    if constexpr (!std::is_void_v<Packet>) {
+      for (; i + Packet::width <= n; i += Packet::width) {
+        TransposeTile<Packet>(a + i * ld + i, ld, a + i * ld + i, ld);
+        Scalar* right = a + i * ld + i + Packet::width;
+        Scalar* below = a + (i + Packet::width) * ld + i;
+        TransposeSwapBlock(right, below, Packet::width, n - i - Packet::width, ld);
+      }
+    }
+    for (; i < n; ++i) {
+      for (size_t j = i + 1; j < n; ++j) {
+        std::swap(a[i * ld + j], a[j * ld + i]);
+      }
+    }
+    return;
+  }
+
+  size_t half = TransposeSplit(n);
+  TransposeSquare(a, half, ld);
+  TransposeSquare(a + half * ld + half, n - half, ld);
+  TransposeSwap(a + half, a + half * ld, half, n - half, ld);
+}
+
+template<typename S, typename Storage, size_t r, size_t c>
+constexpr Matrix<S, c, r> Transposed(const BasicTensor<S, Storage, r, c>& m)
+{
+  Matrix<S, c, r> result{};
+  if (!gtk::simd::IsConstantEvaluated()) {
+    TransposeInto(&m[0], r, c, c, &result[0], r);
+    return result;
+  }
   for (size_t i = 0; i < r; ++i) {
     for (size_t j = 0; j < c; ++j) {
-      result[j][i] = m[i][j];
+      result(j, i) = m(i, j);
     }
   }
   return result;
 }
 
+template<typename S, typename Storage, size_t n>
+constexpr void TransposeInPlace(BasicTensor<S, Storage, n, n>& m)
+{
+  if (!gtk::simd::IsConstantEvaluated()) {
+    TransposeSquare(&m[0], n, n);
+    return;
+  }
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = i + 1; j < n; ++j) {
+      S t = m(i, j);
+      m(i, j) = m(j, i);
+      m(j, i) = t;
+    }
+  }
+}
+
+// Dynamic matrices, throws when m is not a matrix
 template<typename S>
-constexpr S Det(const Matrix<S, 1, 1>& m)
+DynamicTensor<S> Transposed(const DynamicTensor<S>& m)
 {
-  return m[0];
+  if (m.Rank() != 2) {
+    throw std::invalid_argument("Transposed requires a matrix.");
+  }
+  size_t rows = m.Shape()[0];
+  size_t cols = m.Shape()[1];
+  DynamicTensor<S> result({cols, rows});
+  TransposeInto(m.Data(), rows, cols, cols, result.Data(), rows);
+  return result;
 }
 
-template<typename S, size_t r>
-constexpr S Det(const Matrix<S, r, r>& m)
+// Chunks of rows of m are transposed in parallel under par and par_unseq
+template<
+  typename Policy,
+  typename S,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+DynamicTensor<S> Transposed(const Policy& policy, const DynamicTensor<S>& m)
 {
+  if (m.Rank() != 2) {
+    throw std::invalid_argument("Transposed requires a matrix.");
+  }
+  size_t rows = m.Shape()[0];
+  size_t cols = m.Shape()[1];
+  DynamicTensor<S> result({cols, rows});
+  gtk::exec::ForEachChunk(policy, rows, cols, [&](size_t first, size_t last) {
+    TransposeInto(m.Data() + first * cols, last - first, cols, cols, result.Data() + first, rows);
+  });
+  return result;
+}
+
+// Throws when m is not a square matrix, other shapes cannot be transposed in place
+template<typename S>
+void TransposeInPlace(DynamicTensor<S>& m)
+{
+  if (m.Rank() != 2 || m.Shape()[0] != m.Shape()[1]) {
+    throw std::invalid_argument("TransposeInPlace requires a square matrix.");
+  }
+  TransposeSquare(m.Data(), m.Shape()[0], m.Shape()[1]);
+}
+
+// Determinant, adjugate and inverse
+//
+// Up to 4x4 these are closed form cofactor expansions, the 4x4 ones sharing the twelve 2x2
+// determinants of its top and bottom row pairs. Larger matrices are factored with LU and partial
+// pivoting. Singular matrices have no inverse: the closed forms divide by a zero determinant and
+// give infinite or NaN elements, the LU inverse is all NaN.
+
+// Factors the row major n x n matrix a in place into PA = LU, L below the diagonal with an
+// implied unit diagonal and U on and above it, perm[i] the row of A moved to row i. Returns the
+// sign of the permutation, 0 when a is singular.
+template<typename S>
+constexpr int LuFactor(S* a, size_t n, size_t* perm)
+{
+  static_assert(std::is_floating_point_v<S>, "LU factorization requires floating point matrices.");
+
+  int sign = 1;
+  for (size_t i = 0; i < n; ++i) {
+    perm[i] = i;
+  }
+  for (size_t k = 0; k < n; ++k) {
+    S* rowK = a + k * n;
+    size_t pivot = k;
+    S largest = rowK[k] < 0 ? -rowK[k] : rowK[k];
+    for (size_t i = k + 1; i < n; ++i) {
+      S x = a[i * n + k] < 0 ? -a[i * n + k] : a[i * n + k];
+      if (x > largest) {
+        largest = x;
+        pivot = i;
+      }
+    }
+    if (largest == S{}) {
+      return 0;
+    }
+    if (pivot != k) {
+      S* rowPivot = a + pivot * n;
+      for (size_t j = 0; j < n; ++j) {
+        S t = rowK[j];
+        rowK[j] = rowPivot[j];
+        rowPivot[j] = t;
+      }
+      size_t t = perm[k];
+      perm[k] = perm[pivot];
+      perm[pivot] = t;
+      sign = -sign;
+    }
+    for (size_t i = k + 1; i < n; ++i) {
+      S* rowI = a + i * n;
+      S l = rowI[k] / rowK[k];
+      rowI[k] = l;
+      for (size_t j = k + 1; j < n; ++j) {
+        rowI[j] -= l * rowK[j];
+      }
+    }
+  }
+  return sign;
+}
+
+template<typename S, typename Storage, size_t n>
+constexpr int LuDecompose(BasicTensor<S, Storage, n, n>& m, std::array<size_t, n>& perm)
+{
+  return LuFactor(&m[0], n, perm.data());
+}
+
+template<typename S, typename Storage, size_t n>
+constexpr S Det(const BasicTensor<S, Storage, n, n>& m)
+{
+  if constexpr (n == 1) {
+    return m[0];
+  } else if constexpr (n == 2) {
+    return m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+  } else if constexpr (n == 3) {
+    return m(0, 0) * (m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1)) +
+           m(0, 1) * (m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2)) +
+           m(0, 2) * (m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0));
+  } else if constexpr (n == 4) {
+    S s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+    S s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+    S s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+    S s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+    S s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+    S s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+    S c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+    S c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+    S c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+    S c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+    S c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+    S c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  } else {
+    Matrix<S, n, n> lu(m);
+    std::array<size_t, n> perm{};
+    S det = static_cast<S>(LuDecompose(lu, perm));
+    for (size_t i = 0; i < n; ++i) {
+      det *= lu(i, i);
+    }
+    return det;
+  }
+}
+
+// Transposed matrix of cofactors, m Adjugate(m) = Det(m) I
+template<typename S, typename Storage, size_t n>
+constexpr Matrix<S, n, n> Adjugate(const BasicTensor<S, Storage, n, n>& m)
+{
+  static_assert(n >= 1 && n <= 4, "Adjugate is only provided up to 4x4.");
+
+  if constexpr (n == 1) {
+    return Matrix<S, 1, 1>{S{1}};
+  } else if constexpr (n == 2) {
+    return Matrix<S, 2, 2>{m(1, 1), -m(0, 1), -m(1, 0), m(0, 0)};
+  } else if constexpr (n == 3) {
+    return Matrix<S, 3, 3>{
+      m(1, 1) * m(2, 2) - m(1, 2) * m(2, 1),
+      m(0, 2) * m(2, 1) - m(0, 1) * m(2, 2),
+      m(0, 1) * m(1, 2) - m(0, 2) * m(1, 1),
+      m(1, 2) * m(2, 0) - m(1, 0) * m(2, 2),
+      m(0, 0) * m(2, 2) - m(0, 2) * m(2, 0),
+      m(0, 2) * m(1, 0) - m(0, 0) * m(1, 2),
+      m(1, 0) * m(2, 1) - m(1, 1) * m(2, 0),
+      m(0, 1) * m(2, 0) - m(0, 0) * m(2, 1),
+      m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0)
+    };
+  } else {
+    S s0 = m(0, 0) * m(1, 1) - m(1, 0) * m(0, 1);
+    S s1 = m(0, 0) * m(1, 2) - m(1, 0) * m(0, 2);
+    S s2 = m(0, 0) * m(1, 3) - m(1, 0) * m(0, 3);
+    S s3 = m(0, 1) * m(1, 2) - m(1, 1) * m(0, 2);
+    S s4 = m(0, 1) * m(1, 3) - m(1, 1) * m(0, 3);
+    S s5 = m(0, 2) * m(1, 3) - m(1, 2) * m(0, 3);
+    S c0 = m(2, 0) * m(3, 1) - m(3, 0) * m(2, 1);
+    S c1 = m(2, 0) * m(3, 2) - m(3, 0) * m(2, 2);
+    S c2 = m(2, 0) * m(3, 3) - m(3, 0) * m(2, 3);
+    S c3 = m(2, 1) * m(3, 2) - m(3, 1) * m(2, 2);
+    S c4 = m(2, 1) * m(3, 3) - m(3, 1) * m(2, 3);
+    S c5 = m(2, 2) * m(3, 3) - m(3, 2) * m(2, 3);
+    return Matrix<S, 4, 4>{
+      m(1, 1) * c5 - m(1, 2) * c4 + m(1, 3) * c3,
+      -m(0, 1) * c5 + m(0, 2) * c4 - m(0, 3) * c3,
+      m(3, 1) * s5 - m(3, 2) * s4 + m(3, 3) * s3,
+      -m(2, 1) * s5 + m(2, 2) * s4 - m(2, 3) * s3,
+      -m(1, 0) * c5 + m(1, 2) * c2 - m(1, 3) * c1,
+      m(0, 0) * c5 - m(0, 2) * c2 + m(0, 3) * c1,
+      -m(3, 0) * s5 + m(3, 2) * s2 - m(3, 3) * s1,
+      m(2, 0) * s5 - m(2, 2) * s2 + m(2, 3) * s1,
+      m(1, 0) * c4 - m(1, 1) * c2 + m(1, 3) * c0,
+      -m(0, 0) * c4 + m(0, 1) * c2 - m(0, 3) * c0,
+      m(3, 0) * s4 - m(3, 1) * s2 + m(3, 3) * s0,
+      -m(2, 0) * s4 + m(2, 1) * s2 - m(2, 3) * s0,
+      -m(1, 0) * c3 + m(1, 1) * c1 - m(1, 2) * c0,
+      m(0, 0) * c3 - m(0, 1) * c1 + m(0, 2) * c0,
+      -m(3, 0) * s3 + m(3, 1) * s1 - m(3, 2) * s0,
+      m(2, 0) * s3 - m(2, 1) * s1 + m(2, 2) * s0
+    };
+  }
+}
+
+template<typename S, typename Storage, size_t n>
+constexpr Matrix<S, n, n> Inverse(const BasicTensor<S, Storage, n, n>& m)
+{
+  static_assert(std::is_floating_point_v<S>, "Inverse requires floating point matrices.");
+
+  if constexpr (n <= 4) {
+    Matrix<S, n, n> adjugate = Adjugate(m);
+
+    // Expanding along the first row reuses the cofactors in the first column of the adjugate
+    S det{};
+    for (size_t j = 0; j < n; ++j) {
+      det += m(0, j) * adjugate(j, 0);
+    }
+    S invDet = S{1} / det;
+    for (size_t i = 0; i < n * n; ++i) {
+      adjugate[i] *= invDet;
+    }
+    return adjugate;
+  } else {
+    Matrix<S, n, n> lu(m);
+    std::array<size_t, n> perm{};
+    Matrix<S, n, n> inverse{};
+    if (LuDecompose(lu, perm) == 0) {
+      for (size_t i = 0; i < n * n; ++i) {
+        inverse[i] = std::numeric_limits<S>::quiet_NaN();
+      }
+      return inverse;
+    }
+
+    // Column j of the inverse solves L U x = P e_j
+    for (size_t j = 0; j < n; ++j) {
+      for (size_t i = 0; i < n; ++i) {
+        S x = perm[i] == j ? S{1} : S{};
+        for (size_t k = 0; k < i; ++k) {
+          x -= lu(i, k) * inverse(k, j);
+        }
+        inverse(i, j) = x;
+      }
+      for (size_t i = n; i-- > 0;) {
+        S x = inverse(i, j);
+        for (size_t k = i + 1; k < n; ++k) {
+          x -= lu(i, k) * inverse(k, j);
+        }
+        inverse(i, j) = x / lu(i, i);
+      }
+    }
+    return inverse;
+  }
+}
+
+// Transpose of the inverse, the matrix transforming normals
+template<typename S, typename Storage, size_t n>
+constexpr Matrix<S, n, n> InverseTransposed(const BasicTensor<S, Storage, n, n>& m)
+{
+  Matrix<S, n, n> inverse = Inverse(m);
+  Matrix<S, n, n> result{};
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      result(i, j) = inverse(j, i);
+    }
+  }
+  return result;
 }
\ No newline at end of file
@@ -0,0 +1,486 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "Affine.h"
+#include "Matrix.h"
+#include "Simd.h"
+#include "Tensor.h"
+#include "TensorSoA.h"
+#include "Vector.h"
+
+// Rotations of 3D space as unit quaternions, 4 scalars stored (x, y, z, w) with w the real part.
+// Composing two rotations costs 16 multiplies against 27 for 3x3 matrices, and blending stays on
+// the unit sphere instead of shearing. Functions that rotate or convert assume unit quaternions,
+// Normalize the result of long chains of products to stop the length from drifting.
+//
+//   Nlerp      normalized linear interpolation, cheapest, constant speed only for small angles
+//   Slerp      constant speed interpolation along the great arc, with acos and sin
+//   FastSlerp  Slerp as a polynomial of the cosine, Eberly's "A Fast and Accurate Algorithm for
+//              Computing SLERP", free of branches. Within 1e-8 of Slerp for rotations less than
+//              90 degrees apart, the error grows to 4e-5 for opposite ones.
+//
+// All three take the shortest arc, they interpolate towards -b when a and b are more than 180
+// degrees apart since both represent the same rotation.
+
+template<typename Scalar>
+class Quaternion
+{
+  static_assert(std::is_floating_point_v<Scalar>, "Quaternion requires floating point scalars.");
+
+public:
+  using ScalarType = Scalar;
+  using CoefficientsType = Tensor<Scalar, 4>;
+  using VectorType = Vector<Scalar, 3>;
+  using MatrixType = Matrix<Scalar, 3, 3>;
+
+  static constexpr size_t count = 4;
+
+  // Constructors
+
+  // Identity
+  constexpr Quaternion() : q{0, 0, 0, 1} {}
+
+  constexpr Quaternion(Scalar x, Scalar y, Scalar z, Scalar w) : q{x, y, z, w} {}
+
+  constexpr explicit Quaternion(const CoefficientsType& coefficients) : q{coefficients} {}
+
+  // Rotation by angle radians around the unit axis, counterclockwise looking down the axis
+  static Quaternion AxisAngle(const VectorType& axis, Scalar angle)
+  {
+    Scalar s = std::sin(angle / 2);
+    return Quaternion(axis[0] * s, axis[1] * s, axis[2] * s, std::cos(angle / 2));
+  }
+
+  // Rotation of an orthonormal matrix with determinant 1, Shepperd's method: the largest of the
+  // four diagonal combinations is the divisor so it never comes close to zero
+  static Quaternion FromMatrix(const MatrixType& m)
+  {
+    Scalar trace = m(0, 0) + m(1, 1) + m(2, 2);
+    if (trace > 0) {
+      Scalar s = std::sqrt(trace + 1) * 2;
+      return Quaternion(
+        (m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s, (m(1, 0) - m(0, 1)) / s, s / 4
+      );
+    } else if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2)) {
+      Scalar s = std::sqrt(1 + m(0, 0) - m(1, 1) - m(2, 2)) * 2;
+      return Quaternion(
+        s / 4, (m(0, 1) + m(1, 0)) / s, (m(0, 2) + m(2, 0)) / s, (m(2, 1) - m(1, 2)) / s
+      );
+    } else if (m(1, 1) > m(2, 2)) {
+      Scalar s = std::sqrt(1 + m(1, 1) - m(0, 0) - m(2, 2)) * 2;
+      return Quaternion(
+        (m(0, 1) + m(1, 0)) / s, s / 4, (m(1, 2) + m(2, 1)) / s, (m(0, 2) - m(2, 0)) / s
+      );
+    }
+    Scalar s = std::sqrt(1 + m(2, 2) - m(0, 0) - m(1, 1)) * 2;
+    return Quaternion(
+      (m(0, 2) + m(2, 0)) / s, (m(1, 2) + m(2, 1)) / s, s / 4, (m(1, 0) - m(0, 1)) / s
+    );
+  }
+
+  // Accessors
+
+  constexpr Scalar& operator[](size_t i) { return q[i]; }
+  constexpr const Scalar& operator[](size_t i) const { return q[i]; }
+
+  constexpr Scalar X() const { return q[0]; }
+  constexpr Scalar Y() const { return q[1]; }
+  constexpr Scalar Z() const { return q[2]; }
+  constexpr Scalar W() const { return q[3]; }
+
+  // Imaginary part
+  constexpr VectorType Vec() const { return VectorType{q[0], q[1], q[2]}; }
+
+  constexpr const CoefficientsType& Coefficients() const { return q; }
+
+private:
+  CoefficientsType q;
+};
+
+template<typename Scalar>
+constexpr bool operator==(const Quaternion<Scalar>& lhs, const Quaternion<Scalar>& rhs)
+{
+  return lhs.Coefficients() == rhs.Coefficients();
+}
+
+template<typename Scalar>
+constexpr bool operator!=(const Quaternion<Scalar>& lhs, const Quaternion<Scalar>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+// Composition, the rotation applying rhs first and then lhs
+template<typename Scalar>
+constexpr Quaternion<Scalar> Mul(const Quaternion<Scalar>& lhs, const Quaternion<Scalar>& rhs)
+{
+  Scalar ax = lhs[0], ay = lhs[1], az = lhs[2], aw = lhs[3];
+  Scalar bx = rhs[0], by = rhs[1], bz = rhs[2], bw = rhs[3];
+  return Quaternion<Scalar>(
+    aw * bx + ax * bw + ay * bz - az * by,
+    aw * by - ax * bz + ay * bw + az * bx,
+    aw * bz + ax * by - ay * bx + az * bw,
+    aw * bw - ax * bx - ay * by - az * bz
+  );
+}
+
+template<typename Scalar>
+constexpr Quaternion<Scalar>
+operator*(const Quaternion<Scalar>& lhs, const Quaternion<Scalar>& rhs)
+{
+  return Mul(lhs, rhs);
+}
+
+// The inverse rotation of a unit quaternion
+template<typename Scalar>
+constexpr Quaternion<Scalar> Conjugate(const Quaternion<Scalar>& q)
+{
+  return Quaternion<Scalar>(-q[0], -q[1], -q[2], q[3]);
+}
+
+template<typename Scalar>
+constexpr Scalar Dot(const Quaternion<Scalar>& lhs, const Quaternion<Scalar>& rhs)
+{
+  return lhs[0] * rhs[0] + lhs[1] * rhs[1] + lhs[2] * rhs[2] + lhs[3] * rhs[3];
+}
+
+template<typename Scalar>
+Scalar Length(const Quaternion<Scalar>& q)
+{
+  return std::sqrt(Dot(q, q));
+}
+
+// The zero quaternion is no rotation, its components become NaN
+template<typename Scalar>
+Quaternion<Scalar> Normalize(const Quaternion<Scalar>& q)
+{
+  Scalar inv = Scalar{1} / Length(q);
+  return Quaternion<Scalar>(q[0] * inv, q[1] * inv, q[2] * inv, q[3] * inv);
+}
+
+// Inverse of any non zero quaternion, the conjugate for unit ones
+template<typename Scalar>
+constexpr Quaternion<Scalar> Inverse(const Quaternion<Scalar>& q)
+{
+  Scalar inv = Scalar{1} / Dot(q, q);
+  return Quaternion<Scalar>(-q[0] * inv, -q[1] * inv, -q[2] * inv, q[3] * inv);
+}
+
+// q v q^-1 as v + w t + u x t with t = 2 u x v, u the imaginary part, 15 multiplies
+template<typename Scalar, typename Storage>
+constexpr Vector<Scalar, 3>
+Rotate(const Quaternion<Scalar>& q, const BasicTensor<Scalar, Storage, 3>& v)
+{
+  Scalar tx = 2 * (q[1] * v[2] - q[2] * v[1]);
+  Scalar ty = 2 * (q[2] * v[0] - q[0] * v[2]);
+  Scalar tz = 2 * (q[0] * v[1] - q[1] * v[0]);
+  return Vector<Scalar, 3>{
+    v[0] + q[3] * tx + (q[1] * tz - q[2] * ty),
+    v[1] + q[3] * ty + (q[2] * tx - q[0] * tz),
+    v[2] + q[3] * tz + (q[0] * ty - q[1] * tx)
+  };
+}
+
+template<typename Scalar>
+constexpr Matrix<Scalar, 3, 3> ToMatrix(const Quaternion<Scalar>& q)
+{
+  Scalar x = q[0], y = q[1], z = q[2], w = q[3];
+  return Matrix<Scalar, 3, 3>{
+    1 - 2 * (y * y + z * z), 2 * (x * y - w * z),     2 * (x * z + w * y),
+    2 * (x * y + w * z),     1 - 2 * (x * x + z * z), 2 * (y * z - w * x),
+    2 * (x * z - w * y),     2 * (y * z + w * x),     1 - 2 * (x * x + y * y)
+  };
+}
+
+// Interpolation, a at t = 0 and b at t = 1
+
+template<typename Scalar>
+Quaternion<Scalar> Nlerp(const Quaternion<Scalar>& a, const Quaternion<Scalar>& b, Scalar t)
+{
+  Scalar bt = Dot(a, b) < 0 ? -t : t;
+  Scalar at = 1 - t;
+  return Normalize(Quaternion<Scalar>(
+    a[0] * at + b[0] * bt, a[1] * at + b[1] * bt, a[2] * at + b[2] * bt, a[3] * at + b[3] * bt
+  ));
+}
+
+template<typename Scalar>
+Quaternion<Scalar> Slerp(const Quaternion<Scalar>& a, const Quaternion<Scalar>& b, Scalar t)
+{
+  Scalar cosine = Dot(a, b);
+  Scalar sign = cosine < 0 ? Scalar{-1} : Scalar{1};
+  cosine *= sign;
+  // Nearly equal rotations, sin(angle) would lose every digit
+  if (cosine > Scalar{1} - 16 * std::numeric_limits<Scalar>::epsilon()) {
+    return Nlerp(a, b, t);
+  }
+  Scalar angle = std::acos(cosine);
+  Scalar inv = Scalar{1} / std::sin(angle);
+  Scalar at = std::sin((1 - t) * angle) * inv;
+  Scalar bt = std::sin(t * angle) * inv * sign;
+  return Quaternion<Scalar>(
+    a[0] * at + b[0] * bt, a[1] * at + b[1] * bt, a[2] * at + b[2] * bt, a[3] * at + b[3] * bt
+  );
+}
+
+// A scalar, or the packet with every element equal to it
+template<typename T, typename Scalar>
+T Splat(Scalar value)
+{
+  if constexpr (std::is_arithmetic_v<T>) {
+    return static_cast<T>(value);
+  } else {
+    return T::Broadcast(value);
+  }
+}
+
+// Weight of the end point of FastSlerp at t, sin(t angle) / sin(angle) as a polynomial of
+// xm1 = cos(angle) - 1, for scalars and packets of Scalar alike
+template<typename Scalar, typename T>
+T FastSlerpWeight(T t, T xm1)
+{
+  // u[i] = 1 / (i (2 i + 1)), v[i] = i / (2 i + 1), the last pair corrected by mu to bound the
+  // error of the truncated series
+  constexpr Scalar mu = Scalar(1.85298109240830);
+  constexpr Scalar u[8] = {
+    Scalar(1) / (1 * 3), Scalar(1) / (2 * 5),  Scalar(1) / (3 * 7),  Scalar(1) / (4 * 9),
+    Scalar(1) / (5 * 11), Scalar(1) / (6 * 13), Scalar(1) / (7 * 15), mu / (8 * 17)
+  };
+  constexpr Scalar v[8] = {
+    Scalar(1) / 3,  Scalar(2) / 5,  Scalar(3) / 7,  Scalar(4) / 9,
+    Scalar(5) / 11, Scalar(6) / 13, Scalar(7) / 15, mu * 8 / 17
+  };
+  T one = Splat<T>(Scalar{1});
+  T squared = t * t;
+  T sum = one;
+  for (size_t i = 8; i-- > 0;) {
+    sum = one + (Splat<T>(u[i]) * squared - Splat<T>(v[i])) * xm1 * sum;
+  }
+  return t * sum;
+}
+
+template<typename Scalar>
+Quaternion<Scalar> FastSlerp(const Quaternion<Scalar>& a, const Quaternion<Scalar>& b, Scalar t)
+{
+  Scalar cosine = Dot(a, b);
+  Scalar sign = cosine < 0 ? Scalar{-1} : Scalar{1};
+  Scalar xm1 = cosine * sign - 1;
+  Scalar at = FastSlerpWeight<Scalar>(1 - t, xm1);
+  Scalar bt = FastSlerpWeight<Scalar>(t, xm1) * sign;
+  return Quaternion<Scalar>(
+    a[0] * at + b[0] * bt, a[1] * at + b[1] * bt, a[2] * at + b[2] * bt, a[3] * at + b[3] * bt
+  );
+}
+
+
+// Batch operations
+//
+// Arrays of quaternions and vectors are transposed into lanes by blocks like the batch functions
+// in Vector.h, so every packet holds one component of several quaternions. A single rotation of
+// many vectors goes through its matrix, 9 multiplies a vector instead of 15. Outputs may alias
+// inputs.
+
+template<typename Scalar, typename Storage>
+void Rotate(
+  const Quaternion<Scalar>& q,
+  const BasicTensor<Scalar, Storage, 3>* v,
+  size_t count,
+  BasicTensor<Scalar, Storage, 3>* out
+)
+{
+  TransformDirections(Affine3<Scalar>(ToMatrix(q), Vector<Scalar, 3>{}), v, count, out);
+}
+
+template<typename Scalar, typename Storage>
+void Rotate(const Quaternion<Scalar>& q, TensorSoA<BasicTensor<Scalar, Storage, 3>>& v)
+{
+  TransformDirections(Affine3<Scalar>(ToMatrix(q), Vector<Scalar, 3>{}), v);
+}
+
+// out[i] = q[i] rotating v[i]
+template<typename Scalar, typename Storage>
+void RotateBatch(
+  const Quaternion<Scalar>* q,
+  const BasicTensor<Scalar, Storage, 3>* v,
+  size_t count,
+  BasicTensor<Scalar, Storage, 3>* out
+)
+{
+  using VectorType = BasicTensor<Scalar, Storage, 3>;
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    VectorBlock<Quaternion<Scalar>> a;
+    VectorBlock<VectorType> b;
+    for (size_t n; (n = NextVectorBlock<Packet, VectorType>(i, count)) > 0; i += n) {
+      a.Load(q + i, n);
+      b.Load(v + i, n);
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet x = a.template PacketAt<Packet>(0, k);
+        Packet y = a.template PacketAt<Packet>(1, k);
+        Packet z = a.template PacketAt<Packet>(2, k);
+        Packet w = a.template PacketAt<Packet>(3, k);
+        Packet v0 = b.template PacketAt<Packet>(0, k);
+        Packet v1 = b.template PacketAt<Packet>(1, k);
+        Packet v2 = b.template PacketAt<Packet>(2, k);
+        Packet tx = y * v2 - z * v1;
+        Packet ty = z * v0 - x * v2;
+        Packet tz = x * v1 - y * v0;
+        tx = tx + tx;
+        ty = ty + ty;
+        tz = tz + tz;
+        b.StorePacket(0, k, v0 + w * tx + (y * tz - z * ty));
+        b.StorePacket(1, k, v1 + w * ty + (z * tx - x * tz));
+        b.StorePacket(2, k, v2 + w * tz + (x * ty - y * tx));
+      }
+      b.Store(out + i, n);
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = Rotate(q[i], v[i]);
+  }
+}
+
+// out[i] = lhs[i] * rhs[i]
+template<typename Scalar>
+void MulBatch(
+  const Quaternion<Scalar>* lhs,
+  const Quaternion<Scalar>* rhs,
+  size_t count,
+  Quaternion<Scalar>* out
+)
+{
+  using QuaternionType = Quaternion<Scalar>;
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    VectorBlock<QuaternionType> a;
+    VectorBlock<QuaternionType> b;
+    for (size_t n; (n = NextVectorBlock<Packet, QuaternionType>(i, count)) > 0; i += n) {
+      a.Load(lhs + i, n);
+      b.Load(rhs + i, n);
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet ax = a.template PacketAt<Packet>(0, k);
+        Packet ay = a.template PacketAt<Packet>(1, k);
+        Packet az = a.template PacketAt<Packet>(2, k);
+        Packet aw = a.template PacketAt<Packet>(3, k);
+        Packet bx = b.template PacketAt<Packet>(0, k);
+        Packet by = b.template PacketAt<Packet>(1, k);
+        Packet bz = b.template PacketAt<Packet>(2, k);
+        Packet bw = b.template PacketAt<Packet>(3, k);
+        a.StorePacket(0, k, aw * bx + ax * bw + ay * bz - az * by);
+        a.StorePacket(1, k, aw * by - ax * bz + ay * bw + az * bx);
+        a.StorePacket(2, k, aw * bz + ax * by - ay * bx + az * bw);
+        a.StorePacket(3, k, aw * bw - ax * bx - ay * by - az * bz);
+      }
+      a.Store(out + i, n);
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = Mul(lhs[i], rhs[i]);
+  }
+}
+
+// Blends of two poses, out[i] between a[i] and b[i] at the same t. Fast selects FastSlerp,
+// otherwise Nlerp.
+template<bool fast, typename Scalar>
+void InterpolateBatch(
+  const Quaternion<Scalar>* a,
+  const Quaternion<Scalar>* b,
+  Scalar t,
+  size_t count,
+  Quaternion<Scalar>* out
+)
+{
+  using QuaternionType = Quaternion<Scalar>;
+  size_t i = 0;
+  if constexpr (gtk::simd::HasPacketSqrtV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    using Block = VectorBlock<QuaternionType>;
+    Block qa;
+    Block qb;
+    alignas(64) Scalar dots[Block::size];
+    alignas(64) Scalar signs[Block::size];
+    Packet pt = Packet::Broadcast(t);
+    Packet ps = Packet::Broadcast(1 - t);
+    Packet one = Packet::Broadcast(1);
+    for (size_t n; (n = NextVectorBlock<Packet, QuaternionType>(i, count)) > 0; i += n) {
+      qa.Load(a + i, n);
+      qb.Load(b + i, n);
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet dot = qa.template PacketAt<Packet>(0, k) * qb.template PacketAt<Packet>(0, k);
+        for (size_t c = 1; c < 4; ++c) {
+          dot = dot + qa.template PacketAt<Packet>(c, k) * qb.template PacketAt<Packet>(c, k);
+        }
+        dot.Store(dots + k);
+      }
+      // The shortest arc, the compiler turns this into a packet select
+      for (size_t k = 0; k < n; ++k) {
+        signs[k] = dots[k] < 0 ? Scalar{-1} : Scalar{1};
+      }
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet sign = Packet::Load(signs + k);
+        Packet at;
+        Packet bt;
+        if constexpr (fast) {
+          Packet xm1 = Packet::Load(dots + k) * sign - one;
+          at = FastSlerpWeight<Scalar>(ps, xm1);
+          bt = FastSlerpWeight<Scalar>(pt, xm1) * sign;
+        } else {
+          at = ps;
+          bt = pt * sign;
+        }
+        Packet r[4];
+        for (size_t c = 0; c < 4; ++c) {
+          r[c] = qa.template PacketAt<Packet>(c, k) * at + qb.template PacketAt<Packet>(c, k) * bt;
+        }
+        if constexpr (!fast) {
+          Packet squared = r[0] * r[0];
+          for (size_t c = 1; c < 4; ++c) {
+            squared = squared + r[c] * r[c];
+          }
+          Packet length = Sqrt(squared);
+          for (size_t c = 0; c < 4; ++c) {
+            r[c] = r[c] / length;
+          }
+        }
+        for (size_t c = 0; c < 4; ++c) {
+          qa.StorePacket(c, k, r[c]);
+        }
+      }
+      qa.Store(out + i, n);
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = fast ? FastSlerp(a[i], b[i], t) : Nlerp(a[i], b[i], t);
+  }
+}
+
+template<typename Scalar>
+void NlerpBatch(
+  const Quaternion<Scalar>* a,
+  const Quaternion<Scalar>* b,
+  Scalar t,
+  size_t count,
+  Quaternion<Scalar>* out
+)
+{
+  InterpolateBatch<false>(a, b, t, count, out);
+}
+
+// FastSlerp of every pair
+template<typename Scalar>
+void SlerpBatch(
+  const Quaternion<Scalar>* a,
+  const Quaternion<Scalar>* b,
+  Scalar t,
+  size_t count,
+  Quaternion<Scalar>* out
+)
+{
+  InterpolateBatch<true>(a, b, t, count, out);
+}
\ No newline at end of file
@@ -0,0 +1,472 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Random number engines for the samplers of Sample.h
+//
+//   Xoshiro256PlusPlus  Blackman and Vigna, 32 bytes of state, period 2^256 - 1, jumps ahead by
+//                       2^128 or 2^192 numbers. The default engine, Rng.
+//   Pcg32               O'Neill's PCG-XSH-RR, 16 bytes of state, 32 bit outputs, 2^63 streams
+//                       selected by the increment, jumps ahead by any distance in O(log)
+//   Philox4x32          Salmon et al. counter based Philox4x32-10: the n-th number of a stream is
+//                       a hash of (key, n), so any sample of any pixel is drawn without state
+//   Xoshiro256PlusPlusLanes
+//                       several xoshiro256++ streams stepped together in SIMD registers, for the
+//                       bulk fills of Sample.h
+//
+// All are UniformRandomBitGenerators, for the std distributions too, and draw the same numbers on
+// every platform. A stream is fully determined by its seed, so a render drawing from explicitly
+// seeded streams is bit reproducible. Parallel code gives each worker or, better, each block of
+// work its own stream so the numbers do not depend on the schedule: construct engines from
+// (seed, stream), or Split a Xoshiro256PlusPlus.
+//
+// UniformDouble and UniformFloat turn the bits of any engine into [0, 1). ThreadRng is a default
+// stream per thread for callers that do not pass one.
+
+// SplitMix64 by Vigna, steps x and returns a well mixed 64 bit hash of it
+constexpr uint64_t SplitMix64(uint64_t& x)
+{
+  uint64_t z = (x += 0x9e3779b97f4a7c15);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return z ^ (z >> 31);
+}
+
+class Xoshiro256PlusPlus
+{
+public:
+  using result_type = uint64_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  // Constructors
+
+  // Distinct (seed, stream) pairs are independent for all practical purposes, in O(1) for any
+  // stream index
+  constexpr explicit Xoshiro256PlusPlus(uint64_t seed = 0, uint64_t stream = 0) : s{}
+  {
+    uint64_t x = stream;
+    uint64_t mixed = seed ^ SplitMix64(x);
+    for (uint64_t& word : s) {
+      word = SplitMix64(mixed);
+    }
+  }
+
+  // Generation
+
+  constexpr result_type operator()()
+  {
+    uint64_t result = Rotl(s[0] + s[3], 23) + s[0];
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Rotl(s[3], 45);
+    return result;
+  }
+
+  // Streams
+
+  // Advances by 2^128 numbers
+  constexpr void Jump()
+  {
+    constexpr uint64_t polynomial[4] = {
+      0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c
+    };
+    JumpBy(polynomial);
+  }
+
+  // Advances by 2^192 numbers, 2^64 streams of 2^128 numbers apart
+  constexpr void LongJump()
+  {
+    constexpr uint64_t polynomial[4] = {
+      0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635
+    };
+    JumpBy(polynomial);
+  }
+
+  // A stream drawing the next 2^128 numbers of this one, which jumps past them. The streams split
+  // off never overlap.
+  constexpr Xoshiro256PlusPlus Split()
+  {
+    Xoshiro256PlusPlus split = *this;
+    Jump();
+    return split;
+  }
+
+  constexpr bool operator==(const Xoshiro256PlusPlus& rhs) const
+  {
+    return s[0] == rhs.s[0] && s[1] == rhs.s[1] && s[2] == rhs.s[2] && s[3] == rhs.s[3];
+  }
+
+  constexpr bool operator!=(const Xoshiro256PlusPlus& rhs) const { return !(*this == rhs); }
+
+private:
+  template<size_t lanes>
+  friend class Xoshiro256PlusPlusLanes;
+
+  static constexpr uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  constexpr void JumpBy(const uint64_t (&polynomial)[4])
+  {
+    uint64_t jumped[4] = {};
+    for (uint64_t word : polynomial) {
+      for (int b = 0; b < 64; ++b) {
+        if (word & (uint64_t{1} << b)) {
+          for (int i = 0; i < 4; ++i) {
+            jumped[i] ^= s[i];
+          }
+        }
+        (*this)();
+      }
+    }
+    for (int i = 0; i < 4; ++i) {
+      s[i] = jumped[i];
+    }
+  }
+
+  uint64_t s[4];
+};
+
+class Pcg32
+{
+public:
+  using result_type = uint32_t;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  // Constructors
+
+  // The seeding of the reference pcg32_srandom_r, streams differ by their increment
+  constexpr explicit Pcg32(uint64_t seed = 0, uint64_t stream = 0)
+      : state{0},
+        increment{(stream << 1) | 1}
+  {
+    Step();
+    state += seed;
+    Step();
+  }
+
+  // Generation
+
+  constexpr result_type operator()()
+  {
+    uint64_t old = state;
+    Step();
+    uint32_t xorShifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+    uint32_t rotation = static_cast<uint32_t>(old >> 59);
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+  }
+
+  // Streams
+
+  // Advances by delta numbers, Brown's "Random Number Generation with Arbitrary Strides": the
+  // affine step is squared log2(delta) times
+  constexpr void Advance(uint64_t delta)
+  {
+    uint64_t multiplier = pcgMultiplier;
+    uint64_t addend = increment;
+    uint64_t accumulatedMultiplier = 1;
+    uint64_t accumulatedAddend = 0;
+    for (; delta > 0; delta >>= 1) {
+      if (delta & 1) {
+        accumulatedMultiplier *= multiplier;
+        accumulatedAddend = accumulatedAddend * multiplier + addend;
+      }
+      addend = (multiplier + 1) * addend;
+      multiplier *= multiplier;
+    }
+    state = accumulatedMultiplier * state + accumulatedAddend;
+  }
+
+  constexpr bool operator==(const Pcg32& rhs) const
+  {
+    return state == rhs.state && increment == rhs.increment;
+  }
+
+  constexpr bool operator!=(const Pcg32& rhs) const { return !(*this == rhs); }
+
+private:
+  static constexpr uint64_t pcgMultiplier = 6364136223846793005ull;
+
+  constexpr void Step() { state = state * pcgMultiplier + increment; }
+
+  uint64_t state;
+  uint64_t increment;
+};
+
+class Philox4x32
+{
+public:
+  using result_type = uint32_t;
+  using CounterType = std::array<uint32_t, 4>;
+  using KeyType = std::array<uint32_t, 2>;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  // Constructors
+
+  // The seed is the key, the stream the high half of the counter. The low half counts blocks of
+  // 4 numbers, 2^66 numbers a stream.
+  constexpr explicit Philox4x32(uint64_t seed = 0, uint64_t stream = 0)
+      : key{Low(seed), High(seed)},
+        counter{0, 0, Low(stream), High(stream)},
+        block{},
+        index{4}
+  {
+  }
+
+  // The 4 numbers of a counter, the whole generator: ten rounds of multiplications scrambling
+  // the counter, each with a different key
+  static constexpr CounterType Block(CounterType counter, KeyType key)
+  {
+    for (int round = 0; round < 10; ++round) {
+      if (round > 0) {
+        key[0] += 0x9e3779b9;
+        key[1] += 0xbb67ae85;
+      }
+      uint64_t product0 = uint64_t{0xd2511f53} * counter[0];
+      uint64_t product1 = uint64_t{0xcd9e8d57} * counter[2];
+      counter = {
+        High(product1) ^ counter[1] ^ key[0],
+        Low(product1),
+        High(product0) ^ counter[3] ^ key[1],
+        Low(product0)
+      };
+    }
+    return counter;
+  }
+
+  // Generation
+
+  constexpr result_type operator()()
+  {
+    if (index == 4) {
+      Refill();
+    }
+    return block[index++];
+  }
+
+  // Streams
+
+  // Moves to the position-th number of the stream, a sample index times the numbers per sample
+  // draws any sample of the stream on its own
+  constexpr void Seek(uint64_t position)
+  {
+    counter[0] = Low(position / 4);
+    counter[1] = High(position / 4);
+    index = 4;
+    if (position % 4 != 0) {
+      Refill();
+      index = position % 4;
+    }
+  }
+
+  bool operator==(const Philox4x32& rhs) const
+  {
+    return key == rhs.key && counter == rhs.counter && index == rhs.index &&
+           (index == 4 || block == rhs.block);
+  }
+
+  bool operator!=(const Philox4x32& rhs) const { return !(*this == rhs); }
+
+private:
+  static constexpr uint32_t Low(uint64_t x) { return static_cast<uint32_t>(x); }
+  static constexpr uint32_t High(uint64_t x) { return static_cast<uint32_t>(x >> 32); }
+
+  // Generates the block of the counter and moves the counter to the next one
+  constexpr void Refill()
+  {
+    block = Block(counter, key);
+    index = 0;
+    if (++counter[0] == 0) {
+      ++counter[1];
+    }
+  }
+
+  KeyType key;
+  CounterType counter;
+  CounterType block;
+  // Next number of block, 4 when used up
+  uint64_t index;
+};
+
+// lanes xoshiro256++ streams stepped together, lanes numbers a step. The state is stored lane by
+// lane so the compiler vectorizes the step, 8 lanes fill an AVX-512 register of 64 bit integers
+// or two AVX2 ones. The lanes are split off one Xoshiro256PlusPlus and never overlap. Calls to
+// the engine hand out the numbers of a step one at a time, Next the whole step.
+template<size_t lanes = 8>
+class Xoshiro256PlusPlusLanes
+{
+  static_assert(lanes > 0, "Xoshiro256PlusPlusLanes requires a lane.");
+
+public:
+  using result_type = uint64_t;
+
+  static constexpr size_t laneCount = lanes;
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  // Constructors
+
+  explicit Xoshiro256PlusPlusLanes(uint64_t seed = 0, uint64_t stream = 0)
+      : Xoshiro256PlusPlusLanes(Xoshiro256PlusPlus(seed, stream))
+  {
+  }
+
+  explicit Xoshiro256PlusPlusLanes(Xoshiro256PlusPlus rng) : s{}, step{}, index{lanes}
+  {
+    for (size_t k = 0; k < lanes; ++k) {
+      Xoshiro256PlusPlus lane = rng.Split();
+      for (size_t i = 0; i < 4; ++i) {
+        s[i][k] = lane.s[i];
+      }
+    }
+  }
+
+  // Generation
+
+  // The next number of every lane
+  void Next(uint64_t (&out)[lanes])
+  {
+    for (size_t k = 0; k < lanes; ++k) {
+      out[k] = Rotl(s[0][k] + s[3][k], 23) + s[0][k];
+    }
+    for (size_t k = 0; k < lanes; ++k) {
+      uint64_t t = s[1][k] << 17;
+      s[2][k] ^= s[0][k];
+      s[3][k] ^= s[1][k];
+      s[1][k] ^= s[2][k];
+      s[0][k] ^= s[3][k];
+      s[2][k] ^= t;
+      s[3][k] = Rotl(s[3][k], 45);
+    }
+  }
+
+  result_type operator()()
+  {
+    if (index == lanes) {
+      Next(step);
+      index = 0;
+    }
+    return step[index++];
+  }
+
+private:
+  static constexpr uint64_t Rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+  alignas(64) uint64_t s[4][lanes];
+  // Numbers of the last step not handed out yet, from index on
+  uint64_t step[lanes];
+  size_t index;
+};
+
+using Rng = Xoshiro256PlusPlus;
+
+// Engines with 32 or 64 uniformly random bits a call
+template<typename Engine, typename = void>
+struct IsRandomEngine {
+  static constexpr bool value = false;
+};
+
+template<typename Engine>
+struct IsRandomEngine<Engine, std::void_t<typename Engine::result_type>> {
+  using Bits = typename Engine::result_type;
+  static constexpr bool isWord = std::is_same_v<Bits, uint32_t> || std::is_same_v<Bits, uint64_t>;
+  static constexpr bool value =
+    isWord && Engine::min() == 0 && Engine::max() == std::numeric_limits<Bits>::max();
+};
+
+template<typename Engine>
+constexpr bool IsRandomEngineV = IsRandomEngine<Engine>::value;
+
+// Uniform in [0, 1) from the high bits, every float of the form k 2^-24 and every double of the
+// form k 2^-53 with the same probability. A multiply of the integer, no division, no rejection
+// and no std::uniform_real_distribution, whose output depends on the standard library.
+
+constexpr float ToUnitFloat(uint32_t bits)
+{
+  return static_cast<float>(bits >> 8) * 0x1.0p-24f;
+}
+
+constexpr double ToUnitDouble(uint64_t bits)
+{
+  return static_cast<double>(bits >> 11) * 0x1.0p-53;
+}
+
+// Uniform in [0, 1) through the exponent: the high bits as the mantissa of a number in [1, 2),
+// minus 1. A bit less than ToUnitFloat and ToUnitDouble, but only integer logic and a floating
+// point subtraction, which vectorize on every SIMD instruction set where conversions of 64 bit
+// integers do not.
+
+inline float MantissaToUnitFloat(uint32_t bits)
+{
+  uint32_t oneToTwo = (bits >> 9) | 0x3f800000;
+  float x;
+  std::memcpy(&x, &oneToTwo, sizeof(x));
+  return x - 1.0f;
+}
+
+inline double MantissaToUnitDouble(uint64_t bits)
+{
+  uint64_t oneToTwo = (bits >> 12) | 0x3ff0000000000000;
+  double x;
+  std::memcpy(&x, &oneToTwo, sizeof(x));
+  return x - 1.0;
+}
+
+// One call of 64 bit engines, two of 32 bit ones
+template<typename Engine>
+constexpr double UniformDouble(Engine& engine)
+{
+  static_assert(IsRandomEngineV<Engine>, "UniformDouble requires a 32 or 64 bit engine.");
+  if constexpr (sizeof(typename Engine::result_type) == 8) {
+    return ToUnitDouble(engine());
+  } else {
+    uint64_t high = engine();
+    return ToUnitDouble((high << 32) | engine());
+  }
+}
+
+template<typename Engine>
+constexpr double UniformDouble(Engine& engine, double lo, double hi)
+{
+  return lo + (hi - lo) * UniformDouble(engine);
+}
+
+template<typename Engine>
+constexpr float UniformFloat(Engine& engine)
+{
+  static_assert(IsRandomEngineV<Engine>, "UniformFloat requires a 32 or 64 bit engine.");
+  if constexpr (sizeof(typename Engine::result_type) == 8) {
+    return ToUnitFloat(static_cast<uint32_t>(engine() >> 32));
+  } else {
+    return ToUnitFloat(engine());
+  }
+}
+
+template<typename Engine>
+constexpr float UniformFloat(Engine& engine, float lo, float hi)
+{
+  return lo + (hi - lo) * UniformFloat(engine);
+}
+
+// Stream of the calling thread. Threads are numbered in the order they first call it and thread
+// k draws from Rng(seed, k), the main thread usually being thread 0, so a single threaded program
+// is reproducible. Multithreaded code wanting reproducible numbers passes its own streams.
+Rng& ThreadRng();
+
+// Restarts the stream of every thread from seed, 0 when never called. Threads reseed on their
+// next call to ThreadRng.
+void SeedThreadRngs(uint64_t seed);
\ No newline at end of file
@@ -0,0 +1,544 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+#include "Dimension.h"
+#include "Simd.h"
+#include "Tensor.h"
+
+// Reductions over axes of a tensor
+//
+// Reduce<axes...>(t, op) combines the elements of t along axes with op, the result has the
+// dimension of t without those axes (SubDim::Complement of each axis), or is a scalar when every
+// axis is reduced. Axes are listed in increasing order, an empty list reduces every axis. Sum, Min,
+// Max, Mean and Norm are reductions with the usual operations, ArgMax the index of the largest
+// element along one axis.
+//
+// Elements are combined pairwise: ranges are split in halves down to blocks of pairwiseBlockSize,
+// so the rounding error of a sum grows with the logarithm of the count instead of the count.
+// Adjacent axes that are all reduced or all kept are merged at compile time and the reduction
+// runs as one of two kernels, both reading memory in order:
+//   inner reduced  each output is a pairwise reduction of contiguous runs, loaded with packets
+//   inner kept     rows of outputs are combined pairwise with rows of the input, a packet of
+//                  outputs at a time
+// op is applied to packets when gtk::simd::IsPacketOp says so, otherwise to scalars.
+
+// Binary operations of Min and Max, usable with std::plus<> wherever an op is expected
+struct MinOp {
+  template<typename T>
+  constexpr T operator()(const T& a, const T& b) const
+  {
+    if constexpr (std::is_arithmetic_v<T>) {
+      return a < b ? a : b;
+    } else {
+      return Min(a, b);
+    }
+  }
+};
+
+struct MaxOp {
+  template<typename T>
+  constexpr T operator()(const T& a, const T& b) const
+  {
+    if constexpr (std::is_arithmetic_v<T>) {
+      return a > b ? a : b;
+    } else {
+      return Max(a, b);
+    }
+  }
+};
+
+namespace gtk::simd
+{
+template<typename Scalar>
+struct IsPacketOp<MinOp, Scalar> {
+  static constexpr bool value = HasNativePacketV<Scalar>;
+};
+
+template<typename Scalar>
+struct IsPacketOp<MaxOp, Scalar> {
+  static constexpr bool value = HasNativePacketV<Scalar>;
+};
+}  // namespace gtk::simd
+
+inline constexpr size_t pairwiseBlockSize = 64;
+inline constexpr size_t reductionMaxRank = 32;
+
+// op over load(i) for i in [first, last), which must not be empty. Blocks keep four accumulators
+// to hide the latency of op.
+template<typename V, typename BinaryOp, typename Load>
+constexpr V PairwiseReduce(size_t first, size_t last, const BinaryOp& op, const Load& load)
+{
+  size_t n = last - first;
+  if (n > pairwiseBlockSize) {
+    size_t middle = first + n / 2;
+    V lower = PairwiseReduce<V>(first, middle, op, load);
+    return op(lower, PairwiseReduce<V>(middle, last, op, load));
+  }
+  if (n < 4) {
+    V acc = load(first);
+    for (size_t i = first + 1; i < last; ++i) {
+      acc = op(acc, load(i));
+    }
+    return acc;
+  }
+  V acc[4] = {load(first), load(first + 1), load(first + 2), load(first + 3)};
+  size_t i = first + 4;
+  for (; i + 4 <= last; i += 4) {
+    for (size_t k = 0; k < 4; ++k) {
+      acc[k] = op(acc[k], load(i + k));
+    }
+  }
+  for (; i < last; ++i) {
+    acc[0] = op(acc[0], load(i));
+  }
+  return op(op(acc[0], acc[1]), op(acc[2], acc[3]));
+}
+
+// Axes of a tensor merged into runs of adjacent axes that are all kept or all reduced, outermost
+// first. A run is one axis whose extent is the product of the merged extents.
+struct ReductionLayout {
+  std::array<size_t, reductionMaxRank> keptExtents{};
+  std::array<size_t, reductionMaxRank> keptStrides{};
+  std::array<size_t, reductionMaxRank> reducedExtents{};
+  std::array<size_t, reductionMaxRank> reducedStrides{};
+  size_t keptRank = 0;
+  size_t reducedRank = 0;
+
+  // The innermost run, whose stride is 1, is reduced
+  bool innerReduced = false;
+
+  constexpr size_t KeptCount() const { return Product(keptExtents, keptRank); }
+  constexpr size_t ReducedCount() const { return Product(reducedExtents, reducedRank); }
+
+  // Offset of the index-th element of the first rank runs, kept or reduced
+  static constexpr size_t Offset(
+    const std::array<size_t, reductionMaxRank>& extents,
+    const std::array<size_t, reductionMaxRank>& strides,
+    size_t rank,
+    size_t index
+  )
+  {
+    size_t offset = 0;
+    for (size_t i = rank; i-- > 0;) {
+      offset += (index % extents[i]) * strides[i];
+      index /= extents[i];
+    }
+    return offset;
+  }
+
+  static constexpr size_t Product(const std::array<size_t, reductionMaxRank>& extents, size_t rank)
+  {
+    size_t product = 1;
+    for (size_t i = 0; i < rank; ++i) {
+      product *= extents[i];
+    }
+    return product;
+  }
+};
+
+template<typename D, size_t... axes>
+constexpr ReductionLayout MakeReductionLayout()
+{
+  static_assert(D::rank <= reductionMaxRank);
+  std::array<bool, D::rank> reduced{};
+  if constexpr (sizeof...(axes) == 0) {
+    for (bool& r : reduced) {
+      r = true;
+    }
+  } else {
+    ((reduced[axes] = true), ...);
+  }
+
+  ReductionLayout layout{};
+  constexpr auto tailProducts = D::TailProducts();
+  for (size_t i = 0; i < D::rank; ++i) {
+    bool sameRun = i > 0 && reduced[i] == reduced[i - 1];
+    auto& extents = reduced[i] ? layout.reducedExtents : layout.keptExtents;
+    auto& strides = reduced[i] ? layout.reducedStrides : layout.keptStrides;
+    size_t& rank = reduced[i] ? layout.reducedRank : layout.keptRank;
+    if (!sameRun) {
+      extents[rank++] = 1;
+    }
+    extents[rank - 1] *= D::extents[i];
+    strides[rank - 1] = tailProducts[i];
+  }
+  layout.innerReduced = reduced[D::rank - 1];
+  return layout;
+}
+
+// Axes listed in increasing order, each an axis of a tensor of the given rank
+template<size_t rank, size_t... axes>
+constexpr bool IsReductionAxes()
+{
+  std::array<size_t, sizeof...(axes) + 1> list = {axes..., rank};
+  for (size_t i = 0; i < sizeof...(axes); ++i) {
+    if (list[i] >= list[i + 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// D without axes, which are in increasing order
+template<typename D, size_t... axes>
+struct ReducedDimension {
+  using Type = D;
+};
+
+template<typename D, size_t axis, size_t... rest>
+struct ReducedDimension<D, axis, rest...> {
+  using Type = typename SubDim<typename ReducedDimension<D, rest...>::Type, axis, 1>::Complement;
+};
+
+// An empty list of axes reduces every axis
+template<typename D, size_t... axes>
+using ReducedDimensionT = std::conditional_t<
+  sizeof...(axes) == 0,
+  TDimension<>,
+  typename ReducedDimension<D, axes...>::Type>;
+
+// dst[j] = f(dst[j], src[j]) for j in [0, n), a packet at a time when op has packets
+template<typename Scalar, typename BinaryOp, typename F>
+void ReduceRow(Scalar* dst, const Scalar* src, size_t n, const F& f)
+{
+  size_t j = 0;
+  if constexpr (gtk::simd::IsPacketOpV<BinaryOp, Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    for (; j + Packet::width <= n; j += Packet::width) {
+      f(Packet::Load(dst + j), Packet::Load(src + j)).Store(dst + j);
+    }
+  }
+  for (; j < n; ++j) {
+    dst[j] = f(dst[j], src[j]);
+  }
+}
+
+// op over map(p[i]) for i in [0, n), n > 0
+template<typename Scalar, typename BinaryOp, typename Map>
+Scalar ReduceContiguous(const Scalar* p, size_t n, const BinaryOp& op, const Map& map)
+{
+  if constexpr (gtk::simd::IsPacketOpV<BinaryOp, Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    constexpr size_t w = Packet::width;
+    size_t packetCount = n / w;
+    if (packetCount > 0) {
+      Packet total = PairwiseReduce<Packet>(0, packetCount, op, [&](size_t k) {
+        return map(Packet::Load(p + k * w));
+      });
+      Scalar lanes[w];
+      total.Store(lanes);
+      Scalar result = PairwiseReduce<Scalar>(0, w, op, [&](size_t k) { return lanes[k]; });
+      for (size_t i = packetCount * w; i < n; ++i) {
+        result = op(result, map(p[i]));
+      }
+      return result;
+    }
+  }
+  return PairwiseReduce<Scalar>(0, n, op, [&](size_t i) { return map(p[i]); });
+}
+
+// dst holds op over map(row(r)) for r in [first, last), elementwise over rows of n elements.
+// scratch holds a row per level of recursion below this one.
+template<typename Scalar, typename BinaryOp, typename Map, typename Row>
+void PairwiseRows(
+  Scalar* dst,
+  Scalar* scratch,
+  size_t n,
+  size_t first,
+  size_t last,
+  const BinaryOp& op,
+  const Map& map,
+  const Row& row
+)
+{
+  if (last - first > pairwiseBlockSize) {
+    size_t middle = first + (last - first) / 2;
+    PairwiseRows(dst, scratch + n, n, first, middle, op, map, row);
+    PairwiseRows(scratch, scratch + n, n, middle, last, op, map, row);
+    ReduceRow<Scalar, BinaryOp>(dst, scratch, n, op);
+    return;
+  }
+  ReduceRow<Scalar, BinaryOp>(dst, row(first), n, [&](const auto&, const auto& b) {
+    return map(b);
+  });
+  for (size_t r = first + 1; r < last; ++r) {
+    ReduceRow<Scalar, BinaryOp>(dst, row(r), n, [&](const auto& a, const auto& b) {
+      return op(a, map(b));
+    });
+  }
+}
+
+// Runtime kernels, out holds layout.KeptCount() elements
+template<typename Scalar, typename BinaryOp, typename Map>
+void ReduceStrided(
+  const Scalar* in,
+  Scalar* out,
+  const ReductionLayout& layout,
+  const BinaryOp& op,
+  const Map& map
+)
+{
+  const auto& l = layout;
+  if (l.innerReduced) {
+    // The innermost run is contiguous, the outer reduced runs are combined pairwise
+    size_t n = l.reducedExtents[l.reducedRank - 1];
+    size_t outerRank = l.reducedRank - 1;
+    size_t outerCount = ReductionLayout::Product(l.reducedExtents, outerRank);
+    for (size_t o = 0; o < l.KeptCount(); ++o) {
+      const Scalar* base =
+        in + ReductionLayout::Offset(l.keptExtents, l.keptStrides, l.keptRank, o);
+      out[o] = PairwiseReduce<Scalar>(0, outerCount, op, [&](size_t r) {
+        size_t offset = ReductionLayout::Offset(l.reducedExtents, l.reducedStrides, outerRank, r);
+        return ReduceContiguous(base + offset, n, op, map);
+      });
+    }
+    return;
+  }
+
+  // The innermost run is kept, rows of n outputs are reduced together
+  size_t n = l.keptExtents[l.keptRank - 1];
+  size_t outerRank = l.keptRank - 1;
+  size_t reducedCount = l.ReducedCount();
+  size_t levels = 1;
+  for (size_t count = reducedCount; count > pairwiseBlockSize; count -= count / 2) {
+    ++levels;
+  }
+  std::vector<Scalar> scratch(n * levels);
+  for (size_t o = 0; o * n < l.KeptCount(); ++o) {
+    const Scalar* base = in + ReductionLayout::Offset(l.keptExtents, l.keptStrides, outerRank, o);
+    PairwiseRows(out + o * n, scratch.data(), n, 0, reducedCount, op, map, [&](size_t r) {
+      return base + ReductionLayout::Offset(l.reducedExtents, l.reducedStrides, l.reducedRank, r);
+    });
+  }
+}
+
+// Same reduction with scalars only, for constant evaluation
+template<typename Scalar, typename BinaryOp, typename Map>
+constexpr void ReduceScalar(
+  const Scalar* in,
+  Scalar* out,
+  const ReductionLayout& l,
+  const BinaryOp& op,
+  const Map& map
+)
+{
+  for (size_t o = 0; o < l.KeptCount(); ++o) {
+    size_t base = ReductionLayout::Offset(l.keptExtents, l.keptStrides, l.keptRank, o);
+    out[o] = PairwiseReduce<Scalar>(0, l.ReducedCount(), op, [&](size_t r) {
+      size_t offset = ReductionLayout::Offset(l.reducedExtents, l.reducedStrides, l.reducedRank, r);
+      return map(in[base + offset]);
+    });
+  }
+}
+
+// Tensors are reduced in place, views and expressions are evaluated first
+template<typename T>
+constexpr decltype(auto) ReductionOperand(const T& t)
+{
+  if constexpr (IsTensorClassV<T>) {
+    return t;
+  } else {
+    return t.Eval();
+  }
+}
+
+template<size_t... axes, typename T, typename BinaryOp, typename Map>
+constexpr auto ReduceMapped(const T& t, const BinaryOp& op, const Map& map)
+{
+  using D = typename T::DimensionType;
+  using Scalar = typename T::ScalarType;
+  static_assert(
+    IsReductionAxes<D::rank, axes...>(), "Reductions take increasing axes of the tensor."
+  );
+
+  const auto& operand = ReductionOperand(t);
+  constexpr ReductionLayout layout = MakeReductionLayout<D, axes...>();
+  using R = ReducedDimensionT<D, axes...>;
+  auto reduce = [&](Scalar* out) {
+    if (gtk::simd::IsConstantEvaluated()) {
+      ReduceScalar(&operand[0], out, layout, op, map);
+    } else {
+      ReduceStrided(&operand[0], out, layout, op, map);
+    }
+  };
+
+  if constexpr (R::rank == 0) {
+    Scalar result{};
+    reduce(&result);
+    return result;
+  } else {
+    MakeTensorFromDimensionT<Scalar, R> result{};
+    reduce(&result[0]);
+    return result;
+  }
+}
+
+struct ReductionIdentity {
+  template<typename V>
+  constexpr V operator()(const V& v) const
+  {
+    return v;
+  }
+};
+
+template<size_t... axes, typename T, typename BinaryOp>
+constexpr auto Reduce(const T& t, const BinaryOp& op)
+{
+  return ReduceMapped<axes...>(t, op, ReductionIdentity{});
+}
+
+template<size_t... axes, typename T>
+constexpr auto Sum(const T& t)
+{
+  return Reduce<axes...>(t, std::plus<>{});
+}
+
+template<size_t... axes, typename T>
+constexpr auto Min(const T& t)
+{
+  return Reduce<axes...>(t, MinOp{});
+}
+
+template<size_t... axes, typename T>
+constexpr auto Max(const T& t)
+{
+  return Reduce<axes...>(t, MaxOp{});
+}
+
+template<size_t... axes, typename T>
+constexpr auto Mean(const T& t)
+{
+  using Scalar = typename T::ScalarType;
+  static_assert(std::is_floating_point_v<Scalar>, "Mean requires floating point tensors.");
+  constexpr ReductionLayout layout = MakeReductionLayout<typename T::DimensionType, axes...>();
+  constexpr Scalar scale = Scalar{1} / static_cast<Scalar>(layout.ReducedCount());
+
+  auto result = Sum<axes...>(t);
+  if constexpr (std::is_arithmetic_v<decltype(result)>) {
+    return result * scale;
+  } else {
+    for (auto& x : result) {
+      x *= scale;
+    }
+    return result;
+  }
+}
+
+// Euclidean norm along axes, the Frobenius norm of the tensor when every axis is reduced
+template<size_t... axes, typename T>
+auto Norm(const T& t)
+{
+  using Scalar = typename T::ScalarType;
+  static_assert(std::is_floating_point_v<Scalar>, "Norm requires floating point tensors.");
+  auto result = ReduceMapped<axes...>(t, std::plus<>{}, [](const auto& x) { return x * x; });
+  if constexpr (std::is_arithmetic_v<decltype(result)>) {
+    return std::sqrt(result);
+  } else {
+    for (auto& x : result) {
+      x = std::sqrt(x);
+    }
+    return result;
+  }
+}
+
+// Runtime kernel of ArgMax, layout has a single reduced run
+template<typename Scalar>
+void ArgMaxStrided(const Scalar* in, size_t* out, const ReductionLayout& l)
+{
+  size_t m = l.reducedExtents[0];
+  if (l.innerReduced) {
+    // The largest element first, then its position, unless comparisons with NaN found none
+    for (size_t o = 0; o < l.KeptCount(); ++o) {
+      const Scalar* base =
+        in + ReductionLayout::Offset(l.keptExtents, l.keptStrides, l.keptRank, o);
+      Scalar largest = ReduceContiguous(base, m, MaxOp{}, ReductionIdentity{});
+      size_t index = 0;
+      while (index < m && !(base[index] == largest)) {
+        ++index;
+      }
+      if (index == m) {
+        index = 0;
+        for (size_t r = 1; r < m; ++r) {
+          index = base[r] > base[index] ? r : index;
+        }
+      }
+      out[o] = index;
+    }
+    return;
+  }
+
+  // Rows of the reduced axis are compared with the largest elements so far, a row of outputs at
+  // a time
+  size_t n = l.keptExtents[l.keptRank - 1];
+  size_t stride = l.reducedStrides[0];
+  std::vector<Scalar> best(n);
+  for (size_t o = 0; o * n < l.KeptCount(); ++o) {
+    const Scalar* base =
+      in + ReductionLayout::Offset(l.keptExtents, l.keptStrides, l.keptRank - 1, o);
+    size_t* indices = out + o * n;
+    std::copy(base, base + n, best.begin());
+    std::fill(indices, indices + n, size_t{0});
+    for (size_t r = 1; r < m; ++r) {
+      const Scalar* row = base + r * stride;
+      for (size_t j = 0; j < n; ++j) {
+        bool larger = row[j] > best[j];
+        best[j] = larger ? row[j] : best[j];
+        indices[j] = larger ? r : indices[j];
+      }
+    }
+  }
+}
+
+template<typename Scalar>
+constexpr void ArgMaxScalar(const Scalar* in, size_t* out, const ReductionLayout& l)
+{
+  size_t m = l.reducedExtents[0];
+  size_t stride = l.reducedStrides[0];
+  for (size_t o = 0; o < l.KeptCount(); ++o) {
+    const Scalar* base =
+      in + ReductionLayout::Offset(l.keptExtents, l.keptStrides, l.keptRank, o);
+    size_t index = 0;
+    for (size_t r = 1; r < m; ++r) {
+      index = base[r * stride] > base[index * stride] ? r : index;
+    }
+    out[o] = index;
+  }
+}
+
+// Index along axis of the first largest element, the flattened index of the first largest element
+// of the tensor without an axis
+template<size_t... axis, typename T>
+constexpr auto ArgMax(const T& t)
+{
+  using D = typename T::DimensionType;
+  static_assert(sizeof...(axis) <= 1, "ArgMax reduces one axis, or every axis.");
+  static_assert(IsReductionAxes<D::rank, axis...>(), "ArgMax takes an axis of the tensor.");
+
+  const auto& operand = ReductionOperand(t);
+  constexpr ReductionLayout layout = MakeReductionLayout<D, axis...>();
+  using R = ReducedDimensionT<D, axis...>;
+  auto argMax = [&](size_t* out) {
+    if (gtk::simd::IsConstantEvaluated()) {
+      ArgMaxScalar(&operand[0], out, layout);
+    } else {
+      ArgMaxStrided(&operand[0], out, layout);
+    }
+  };
+
+  if constexpr (R::rank == 0) {
+    size_t result = 0;
+    argMax(&result);
+    return result;
+  } else {
+    MakeTensorFromDimensionT<size_t, R> result{};
+    argMax(&result[0]);
+    return result;
+  }
+}
\ No newline at end of file
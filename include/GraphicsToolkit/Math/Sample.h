@@ -1,8 +1,15 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <stdexcept>
 #include <tuple>
 #include <functional>
+#include <type_traits>
+
+#include "Execution.h"
+#include "Parallel.h"
+#include "Random.h"
 
 struct ProbabilityDensityFunction1D {
   ProbabilityDensityFunction1D(double domainMin, double domainMax, double argMax);
@@ -16,15 +23,56 @@ struct ProbabilityDensityFunction1D {
   double argMax;
 };
 
+// Samplers draw from any engine of Random.h, or from ThreadRng() without one
+
+template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+double SampleUniform1D(Engine& rng, double lo = 0., double hi = 1.)
+{
+  return UniformDouble(rng, lo, hi);
+}
+
 double SampleUniform1D(double lo = 0., double hi = 1.);
 
+template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+std::tuple<double, double> SampleUniform2D(Engine& rng, double lo = 0., double hi = 1.)
+{
+  double x = SampleUniform1D(rng, lo, hi);
+  double y = SampleUniform1D(rng, lo, hi);
+  return {x, y};
+}
+
 std::tuple<double, double> SampleUniform2D(double lo = 0., double hi = 1.);
 
+template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+std::tuple<double, double, double> SampleUniform3D(Engine& rng, double lo = 0., double hi = 1.)
+{
+  double x = SampleUniform1D(rng, lo, hi);
+  double y = SampleUniform1D(rng, lo, hi);
+  double z = SampleUniform1D(rng, lo, hi);
+  return {x, y, z};
+}
+
 std::tuple<double, double, double> SampleUniform3D(double lo = 0., double hi = 1.);
 
 double SampleNormal1D(double lo = 0., double hi = 1.);
 
-double Sample1D(const ProbabilityDensityFunction1D& pdf);
+template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+double RejectionSample1D(
+  Engine& rng,
+  double lo,
+  double hi,
+  const std::function<double(double)>& pdf,
+  double upperBound
+)
+{
+  while (true) {
+    double x = SampleUniform1D(rng, lo, hi);
+    double u = SampleUniform1D(rng);
+    if (u * upperBound < pdf(x)) {
+      return x;
+    }
+  }
+}
 
 double RejectionSample1D(
   double lo,
@@ -33,6 +81,196 @@ double RejectionSample1D(
   double upperBound
 );
 
+template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+double Sample1D(Engine& rng, const ProbabilityDensityFunction1D& pdf)
+{
+  return RejectionSample1D(rng, pdf.domainMin, pdf.domainMax, std::ref(pdf), pdf.UpperBound());
+}
+
+double Sample1D(const ProbabilityDensityFunction1D& pdf);
+
+// Bulk uniform samples in [lo, hi), count of them into out. Xoshiro256PlusPlusLanes engines fill
+// lanes doubles or 2 lanes floats a step in SIMD registers, other engines one number at a time.
+// Points go into SoA buffers, an array a coordinate, such as the lanes of a TensorSoA:
+//   FillUniform2D(points.Lane(0), points.Lane(1), points.Size(), 0., 1., rng);
+
+template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+void FillUniform(double* out, size_t count, double lo, double hi, Engine& rng)
+{
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = UniformDouble(rng, lo, hi);
+  }
+}
+
+template<typename Engine, typename = std::enable_if_t<IsRandomEngineV<Engine>>>
+void FillUniform(float* out, size_t count, float lo, float hi, Engine& rng)
+{
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = UniformFloat(rng, lo, hi);
+  }
+}
+
+template<size_t lanes>
+void FillUniform(
+  double* out,
+  size_t count,
+  double lo,
+  double hi,
+  Xoshiro256PlusPlusLanes<lanes>& rng
+)
+{
+  double scale = hi - lo;
+  uint64_t bits[lanes];
+  size_t i = 0;
+  for (; i + lanes <= count; i += lanes) {
+    rng.Next(bits);
+    for (size_t k = 0; k < lanes; ++k) {
+      out[i + k] = lo + scale * MantissaToUnitDouble(bits[k]);
+    }
+  }
+  if (i < count) {
+    rng.Next(bits);
+    for (size_t k = 0; i + k < count; ++k) {
+      out[i + k] = lo + scale * MantissaToUnitDouble(bits[k]);
+    }
+  }
+}
+
+// Both halves of every number
+template<size_t lanes>
+void FillUniform(
+  float* out,
+  size_t count,
+  float lo,
+  float hi,
+  Xoshiro256PlusPlusLanes<lanes>& rng
+)
+{
+  float scale = hi - lo;
+  uint64_t bits[lanes];
+  float values[2 * lanes];
+  size_t i = 0;
+  for (; i + 2 * lanes <= count; i += 2 * lanes) {
+    rng.Next(bits);
+    for (size_t k = 0; k < lanes; ++k) {
+      out[i + k] = lo + scale * MantissaToUnitFloat(static_cast<uint32_t>(bits[k] >> 32));
+      out[i + lanes + k] = lo + scale * MantissaToUnitFloat(static_cast<uint32_t>(bits[k]));
+    }
+  }
+  if (i < count) {
+    rng.Next(bits);
+    for (size_t k = 0; k < lanes; ++k) {
+      values[k] = lo + scale * MantissaToUnitFloat(static_cast<uint32_t>(bits[k] >> 32));
+      values[lanes + k] = lo + scale * MantissaToUnitFloat(static_cast<uint32_t>(bits[k]));
+    }
+    std::copy(values, values + (count - i), out + i);
+  }
+}
+
+template<typename Scalar, typename Engine>
+void FillUniform2D(Scalar* x, Scalar* y, size_t count, Scalar lo, Scalar hi, Engine& rng)
+{
+  FillUniform(x, count, lo, hi, rng);
+  FillUniform(y, count, lo, hi, rng);
+}
+
+template<typename Scalar, typename Engine>
+void FillUniform3D(
+  Scalar* x,
+  Scalar* y,
+  Scalar* z,
+  size_t count,
+  Scalar lo,
+  Scalar hi,
+  Engine& rng
+)
+{
+  FillUniform(x, count, lo, hi, rng);
+  FillUniform(y, count, lo, hi, rng);
+  FillUniform(z, count, lo, hi, rng);
+}
+
+// Bulk samples under an execution policy. Block b of sampleBlockSize samples draws from its own
+// stream SampleBlockEngine(seed, b), so the samples only depend on the seed: every policy and
+// thread count gives the same ones.
+//   FillUniform(gtk::exec::par, out.data(), out.size(), 0., 1., seed);
+
+inline constexpr size_t sampleBlockSize = size_t{1} << 16;
+
+// Seeding the 8 lanes costs about as much as 10000 samples, a block amortizes it
+using SampleBlockEngine = Xoshiro256PlusPlusLanes<8>;
+
+// Calls f(first, last, rng) on the blocks covering [0, count), rng the engine of the block
+template<typename Policy, typename F>
+void ForEachSampleBlock(const Policy& policy, size_t count, uint64_t seed, const F& f)
+{
+  size_t blocks = gtk::BlockCount(count, sampleBlockSize);
+  gtk::exec::ForEachChunk(policy, blocks, sampleBlockSize, [&](size_t first, size_t last) {
+    for (size_t b = first; b < last; ++b) {
+      SampleBlockEngine rng(seed, b);
+      size_t begin = b * sampleBlockSize;
+      f(begin, std::min(begin + sampleBlockSize, count), rng);
+    }
+  });
+}
+
+template<
+  typename Policy,
+  typename Scalar,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void FillUniform(
+  const Policy& policy,
+  Scalar* out,
+  size_t count,
+  Scalar lo,
+  Scalar hi,
+  uint64_t seed
+)
+{
+  ForEachSampleBlock(policy, count, seed, [&](size_t first, size_t last, auto& rng) {
+    FillUniform(out + first, last - first, lo, hi, rng);
+  });
+}
+
+// Every coordinate draws from the streams of its own seed, derived from seed
+template<
+  typename Policy,
+  typename Scalar,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void FillUniform2D(
+  const Policy& policy,
+  Scalar* x,
+  Scalar* y,
+  size_t count,
+  Scalar lo,
+  Scalar hi,
+  uint64_t seed
+)
+{
+  FillUniform(policy, x, count, lo, hi, SplitMix64(seed));
+  FillUniform(policy, y, count, lo, hi, SplitMix64(seed));
+}
+
+template<
+  typename Policy,
+  typename Scalar,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void FillUniform3D(
+  const Policy& policy,
+  Scalar* x,
+  Scalar* y,
+  Scalar* z,
+  size_t count,
+  Scalar lo,
+  Scalar hi,
+  uint64_t seed
+)
+{
+  FillUniform(policy, x, count, lo, hi, SplitMix64(seed));
+  FillUniform(policy, y, count, lo, hi, SplitMix64(seed));
+  FillUniform(policy, z, count, lo, hi, SplitMix64(seed));
+}
+
 struct NormalDistribution : public ProbabilityDensityFunction1D {
   NormalDistribution(double mu, double sigma);
 
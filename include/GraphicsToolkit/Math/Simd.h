@@ -0,0 +1,625 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <type_traits>
+
+// Fixed width packets of scalars mapped to the widest instruction set enabled at compile time
+//
+// The instruction set is picked from the compiler's target macros (-mavx2, /arch:AVX2, ...), there
+// is no runtime dispatch. Define GTK_NO_SIMD to force the scalar code paths everywhere.
+//
+//   float    16 (AVX-512F)  8 (AVX)    4 (SSE2, NEON)
+//   double    8 (AVX-512F)  4 (AVX)    2 (SSE2, AArch64 NEON)
+//   int32_t  16 (AVX-512F)  8 (AVX2)   4 (SSE4.1, NEON)
+//
+// Packets are only used at runtime, constant evaluation always takes the scalar paths.
+
+#if !defined(GTK_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define GTK_SIMD_SSE2
+#endif
+// MSVC has no macro for SSE4.1, every target with AVX has it
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define GTK_SIMD_SSE41
+#endif
+#if defined(__AVX__)
+#define GTK_SIMD_AVX
+#endif
+#if defined(__AVX2__)
+#define GTK_SIMD_AVX2
+#endif
+#if defined(__AVX512F__)
+#define GTK_SIMD_AVX512
+#endif
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define GTK_SIMD_NEON
+#endif
+#endif
+
+#if defined(GTK_SIMD_SSE2)
+#include <immintrin.h>
+#elif defined(GTK_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace gtk::simd
+{
+
+// True while the enclosing expression is constant evaluated, packets must not be used then
+constexpr bool IsConstantEvaluated()
+{
+#if defined(__clang__)
+#if __has_builtin(__builtin_is_constant_evaluated)
+  return __builtin_is_constant_evaluated();
+#else
+  return true;
+#endif
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+  return __builtin_is_constant_evaluated();
+#else
+  // Cannot tell, stay on the scalar paths that work in both contexts
+  return true;
+#endif
+}
+
+// Specialized below for every scalar and width the target supports
+template<typename Scalar, size_t width>
+struct Packet {
+  static constexpr bool supported = false;
+};
+
+template<typename Scalar, size_t width>
+static constexpr bool HasPacketV = Packet<Scalar, width>::supported;
+
+#if defined(GTK_SIMD_SSE2)
+
+template<>
+struct Packet<float, 4> {
+  using ScalarType = float;
+  static constexpr size_t width = 4;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const float* p) { return {_mm_loadu_ps(p)}; }
+  static Packet Broadcast(float x) { return {_mm_set1_ps(x)}; }
+  void Store(float* p) const { _mm_storeu_ps(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm_add_ps(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm_sub_ps(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm_mul_ps(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm_min_ps(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm_max_ps(a.v, b.v)}; }
+  friend Packet operator/(Packet a, Packet b) { return {_mm_div_ps(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {_mm_sqrt_ps(a.v)}; }
+
+  // Transposes the 4x4 block whose rows are rows[0] to rows[3]
+  static void Transpose(Packet* rows)
+  {
+    _MM_TRANSPOSE4_PS(rows[0].v, rows[1].v, rows[2].v, rows[3].v);
+  }
+
+  __m128 v;
+};
+
+template<>
+struct Packet<double, 2> {
+  using ScalarType = double;
+  static constexpr size_t width = 2;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const double* p) { return {_mm_loadu_pd(p)}; }
+  static Packet Broadcast(double x) { return {_mm_set1_pd(x)}; }
+  void Store(double* p) const { _mm_storeu_pd(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm_add_pd(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm_sub_pd(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm_mul_pd(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm_min_pd(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm_max_pd(a.v, b.v)}; }
+  friend Packet operator/(Packet a, Packet b) { return {_mm_div_pd(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {_mm_sqrt_pd(a.v)}; }
+
+  static void Transpose(Packet* rows)
+  {
+    __m128d r0 = rows[0].v;
+    rows[0].v = _mm_unpacklo_pd(r0, rows[1].v);
+    rows[1].v = _mm_unpackhi_pd(r0, rows[1].v);
+  }
+
+  __m128d v;
+};
+
+#endif
+
+#if defined(GTK_SIMD_SSE41)
+
+template<>
+struct Packet<std::int32_t, 4> {
+  using ScalarType = std::int32_t;
+  static constexpr size_t width = 4;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = false;
+  static constexpr bool hasSqrt = false;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const std::int32_t* p)
+  {
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))};
+  }
+  static Packet Broadcast(std::int32_t x) { return {_mm_set1_epi32(x)}; }
+  void Store(std::int32_t* p) const { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm_add_epi32(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm_sub_epi32(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm_mullo_epi32(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm_min_epi32(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm_max_epi32(a.v, b.v)}; }
+
+  // Same shuffles as float, integer lanes are moved without conversion
+  static void Transpose(Packet* rows)
+  {
+    __m128 r0 = _mm_castsi128_ps(rows[0].v);
+    __m128 r1 = _mm_castsi128_ps(rows[1].v);
+    __m128 r2 = _mm_castsi128_ps(rows[2].v);
+    __m128 r3 = _mm_castsi128_ps(rows[3].v);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    rows[0].v = _mm_castps_si128(r0);
+    rows[1].v = _mm_castps_si128(r1);
+    rows[2].v = _mm_castps_si128(r2);
+    rows[3].v = _mm_castps_si128(r3);
+  }
+
+  __m128i v;
+};
+
+#endif
+
+#if defined(GTK_SIMD_AVX)
+
+template<>
+struct Packet<float, 8> {
+  using ScalarType = float;
+  static constexpr size_t width = 8;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const float* p) { return {_mm256_loadu_ps(p)}; }
+  static Packet Broadcast(float x) { return {_mm256_set1_ps(x)}; }
+  void Store(float* p) const { _mm256_storeu_ps(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm256_add_ps(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm256_sub_ps(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm256_mul_ps(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm256_min_ps(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm256_max_ps(a.v, b.v)}; }
+  friend Packet operator/(Packet a, Packet b) { return {_mm256_div_ps(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {_mm256_sqrt_ps(a.v)}; }
+
+  // Transposes the 8x8 block whose rows are rows[0] to rows[7]: pairs of rows are interleaved,
+  // then pairs of pairs, and the 128 bit halves are exchanged last
+  static void Transpose(Packet* rows)
+  {
+    __m256 t[8];
+    for (size_t i = 0; i < 8; i += 2) {
+      t[i] = _mm256_unpacklo_ps(rows[i].v, rows[i + 1].v);
+      t[i + 1] = _mm256_unpackhi_ps(rows[i].v, rows[i + 1].v);
+    }
+    __m256 u[8];
+    for (size_t i = 0; i < 8; i += 4) {
+      u[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+      u[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+      u[i + 2] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+      u[i + 3] = _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (size_t i = 0; i < 4; ++i) {
+      rows[i].v = _mm256_permute2f128_ps(u[i], u[i + 4], 0x20);
+      rows[i + 4].v = _mm256_permute2f128_ps(u[i], u[i + 4], 0x31);
+    }
+  }
+
+  __m256 v;
+};
+
+template<>
+struct Packet<double, 4> {
+  using ScalarType = double;
+  static constexpr size_t width = 4;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const double* p) { return {_mm256_loadu_pd(p)}; }
+  static Packet Broadcast(double x) { return {_mm256_set1_pd(x)}; }
+  void Store(double* p) const { _mm256_storeu_pd(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm256_add_pd(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm256_sub_pd(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm256_mul_pd(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm256_min_pd(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm256_max_pd(a.v, b.v)}; }
+  friend Packet operator/(Packet a, Packet b) { return {_mm256_div_pd(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {_mm256_sqrt_pd(a.v)}; }
+
+  static void Transpose(Packet* rows)
+  {
+    __m256d t0 = _mm256_unpacklo_pd(rows[0].v, rows[1].v);
+    __m256d t1 = _mm256_unpackhi_pd(rows[0].v, rows[1].v);
+    __m256d t2 = _mm256_unpacklo_pd(rows[2].v, rows[3].v);
+    __m256d t3 = _mm256_unpackhi_pd(rows[2].v, rows[3].v);
+    rows[0].v = _mm256_permute2f128_pd(t0, t2, 0x20);
+    rows[1].v = _mm256_permute2f128_pd(t1, t3, 0x20);
+    rows[2].v = _mm256_permute2f128_pd(t0, t2, 0x31);
+    rows[3].v = _mm256_permute2f128_pd(t1, t3, 0x31);
+  }
+
+  __m256d v;
+};
+
+#endif
+
+#if defined(GTK_SIMD_AVX2)
+
+template<>
+struct Packet<std::int32_t, 8> {
+  using ScalarType = std::int32_t;
+  static constexpr size_t width = 8;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = false;
+  static constexpr bool hasSqrt = false;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const std::int32_t* p)
+  {
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))};
+  }
+  static Packet Broadcast(std::int32_t x) { return {_mm256_set1_epi32(x)}; }
+  void Store(std::int32_t* p) const { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm256_add_epi32(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm256_sub_epi32(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm256_mullo_epi32(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm256_min_epi32(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm256_max_epi32(a.v, b.v)}; }
+
+  static void Transpose(Packet* rows)
+  {
+    Packet<float, 8> r[8];
+    for (size_t i = 0; i < 8; ++i) {
+      r[i].v = _mm256_castsi256_ps(rows[i].v);
+    }
+    Packet<float, 8>::Transpose(r);
+    for (size_t i = 0; i < 8; ++i) {
+      rows[i].v = _mm256_castps_si256(r[i].v);
+    }
+  }
+
+  __m256i v;
+};
+
+#endif
+
+#if defined(GTK_SIMD_AVX512)
+
+template<>
+struct Packet<float, 16> {
+  using ScalarType = float;
+  static constexpr size_t width = 16;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+  static constexpr bool hasTranspose = false;
+
+  static Packet Load(const float* p) { return {_mm512_loadu_ps(p)}; }
+  static Packet Broadcast(float x) { return {_mm512_set1_ps(x)}; }
+  void Store(float* p) const { _mm512_storeu_ps(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm512_add_ps(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm512_sub_ps(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm512_mul_ps(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm512_min_ps(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm512_max_ps(a.v, b.v)}; }
+  friend Packet operator/(Packet a, Packet b) { return {_mm512_div_ps(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {_mm512_sqrt_ps(a.v)}; }
+
+  __m512 v;
+};
+
+template<>
+struct Packet<double, 8> {
+  using ScalarType = double;
+  static constexpr size_t width = 8;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+  static constexpr bool hasTranspose = false;
+
+  static Packet Load(const double* p) { return {_mm512_loadu_pd(p)}; }
+  static Packet Broadcast(double x) { return {_mm512_set1_pd(x)}; }
+  void Store(double* p) const { _mm512_storeu_pd(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm512_add_pd(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm512_sub_pd(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm512_mul_pd(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm512_min_pd(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm512_max_pd(a.v, b.v)}; }
+  friend Packet operator/(Packet a, Packet b) { return {_mm512_div_pd(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {_mm512_sqrt_pd(a.v)}; }
+
+  __m512d v;
+};
+
+template<>
+struct Packet<std::int32_t, 16> {
+  using ScalarType = std::int32_t;
+  static constexpr size_t width = 16;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = false;
+  static constexpr bool hasSqrt = false;
+  static constexpr bool hasTranspose = false;
+
+  static Packet Load(const std::int32_t* p) { return {_mm512_loadu_si512(p)}; }
+  static Packet Broadcast(std::int32_t x) { return {_mm512_set1_epi32(x)}; }
+  void Store(std::int32_t* p) const { _mm512_storeu_si512(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {_mm512_add_epi32(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {_mm512_sub_epi32(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {_mm512_mullo_epi32(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {_mm512_min_epi32(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {_mm512_max_epi32(a.v, b.v)}; }
+
+  __m512i v;
+};
+
+#endif
+
+#if defined(GTK_SIMD_NEON)
+
+template<>
+struct Packet<float, 4> {
+  using ScalarType = float;
+  static constexpr size_t width = 4;
+  static constexpr bool supported = true;
+#if defined(__aarch64__) || defined(_M_ARM64)
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+#else
+  static constexpr bool hasDivision = false;
+  static constexpr bool hasSqrt = false;
+#endif
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const float* p) { return {vld1q_f32(p)}; }
+  static Packet Broadcast(float x) { return {vdupq_n_f32(x)}; }
+  void Store(float* p) const { vst1q_f32(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {vaddq_f32(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {vsubq_f32(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {vmulq_f32(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {vminq_f32(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {vmaxq_f32(a.v, b.v)}; }
+#if defined(__aarch64__) || defined(_M_ARM64)
+  friend Packet operator/(Packet a, Packet b) { return {vdivq_f32(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {vsqrtq_f32(a.v)}; }
+#endif
+
+  // Transposes 2x2 blocks within pairs of rows, then exchanges the halves of the pairs
+  static void Transpose(Packet* rows)
+  {
+    float32x4x2_t p = vtrnq_f32(rows[0].v, rows[1].v);
+    float32x4x2_t q = vtrnq_f32(rows[2].v, rows[3].v);
+    rows[0].v = vcombine_f32(vget_low_f32(p.val[0]), vget_low_f32(q.val[0]));
+    rows[1].v = vcombine_f32(vget_low_f32(p.val[1]), vget_low_f32(q.val[1]));
+    rows[2].v = vcombine_f32(vget_high_f32(p.val[0]), vget_high_f32(q.val[0]));
+    rows[3].v = vcombine_f32(vget_high_f32(p.val[1]), vget_high_f32(q.val[1]));
+  }
+
+  float32x4_t v;
+};
+
+template<>
+struct Packet<std::int32_t, 4> {
+  using ScalarType = std::int32_t;
+  static constexpr size_t width = 4;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = false;
+  static constexpr bool hasSqrt = false;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const std::int32_t* p) { return {vld1q_s32(p)}; }
+  static Packet Broadcast(std::int32_t x) { return {vdupq_n_s32(x)}; }
+  void Store(std::int32_t* p) const { vst1q_s32(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {vaddq_s32(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {vsubq_s32(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {vmulq_s32(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {vminq_s32(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {vmaxq_s32(a.v, b.v)}; }
+
+  static void Transpose(Packet* rows)
+  {
+    int32x4x2_t p = vtrnq_s32(rows[0].v, rows[1].v);
+    int32x4x2_t q = vtrnq_s32(rows[2].v, rows[3].v);
+    rows[0].v = vcombine_s32(vget_low_s32(p.val[0]), vget_low_s32(q.val[0]));
+    rows[1].v = vcombine_s32(vget_low_s32(p.val[1]), vget_low_s32(q.val[1]));
+    rows[2].v = vcombine_s32(vget_high_s32(p.val[0]), vget_high_s32(q.val[0]));
+    rows[3].v = vcombine_s32(vget_high_s32(p.val[1]), vget_high_s32(q.val[1]));
+  }
+
+  int32x4_t v;
+};
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+template<>
+struct Packet<double, 2> {
+  using ScalarType = double;
+  static constexpr size_t width = 2;
+  static constexpr bool supported = true;
+  static constexpr bool hasDivision = true;
+  static constexpr bool hasSqrt = true;
+  static constexpr bool hasTranspose = true;
+
+  static Packet Load(const double* p) { return {vld1q_f64(p)}; }
+  static Packet Broadcast(double x) { return {vdupq_n_f64(x)}; }
+  void Store(double* p) const { vst1q_f64(p, v); }
+
+  friend Packet operator+(Packet a, Packet b) { return {vaddq_f64(a.v, b.v)}; }
+  friend Packet operator-(Packet a, Packet b) { return {vsubq_f64(a.v, b.v)}; }
+  friend Packet operator*(Packet a, Packet b) { return {vmulq_f64(a.v, b.v)}; }
+  friend Packet Min(Packet a, Packet b) { return {vminq_f64(a.v, b.v)}; }
+  friend Packet Max(Packet a, Packet b) { return {vmaxq_f64(a.v, b.v)}; }
+  friend Packet operator/(Packet a, Packet b) { return {vdivq_f64(a.v, b.v)}; }
+  friend Packet Sqrt(Packet a) { return {vsqrtq_f64(a.v)}; }
+
+  static void Transpose(Packet* rows)
+  {
+    float64x2_t r0 = rows[0].v;
+    rows[0].v = vtrn1q_f64(r0, rows[1].v);
+    rows[1].v = vtrn2q_f64(r0, rows[1].v);
+  }
+
+  float64x2_t v;
+};
+#endif
+
+#endif
+
+// Widest packet holding at most count scalars, void if there is none
+template<typename Scalar, size_t count>
+struct PacketForCount {
+private:
+  static constexpr size_t PickWidth()
+  {
+    if (count >= 16 && HasPacketV<Scalar, 16>) {
+      return 16;
+    } else if (count >= 8 && HasPacketV<Scalar, 8>) {
+      return 8;
+    } else if (count >= 4 && HasPacketV<Scalar, 4>) {
+      return 4;
+    } else if (count >= 2 && HasPacketV<Scalar, 2>) {
+      return 2;
+    }
+    return 0;
+  }
+
+public:
+  static constexpr size_t width = PickWidth();
+  using Type = std::conditional_t<width == 0, void, Packet<Scalar, width>>;
+};
+
+template<typename Scalar, size_t count>
+using PacketForCountT = typename PacketForCount<Scalar, count>::Type;
+
+// Widest packet for Scalar, void if the target has none
+template<typename Scalar>
+using NativePacketT = PacketForCountT<Scalar, std::numeric_limits<size_t>::max()>;
+
+template<typename Scalar>
+static constexpr bool HasNativePacketV = !std::is_void_v<NativePacketT<Scalar>>;
+
+// Componentwise operators applied to packets exactly like to scalars
+template<typename BinaryOp, typename Scalar>
+struct IsPacketOp {
+  static constexpr bool value = false;
+};
+
+template<typename Scalar>
+struct IsPacketOp<std::plus<>, Scalar> {
+  static constexpr bool value = HasNativePacketV<Scalar>;
+};
+
+template<typename Scalar>
+struct IsPacketOp<std::minus<>, Scalar> {
+  static constexpr bool value = HasNativePacketV<Scalar>;
+};
+
+template<typename Scalar>
+struct IsPacketOp<std::multiplies<>, Scalar> {
+  static constexpr bool value = HasNativePacketV<Scalar>;
+};
+
+template<typename Scalar>
+struct IsPacketOp<std::divides<>, Scalar> {
+private:
+  static constexpr bool HasDivision()
+  {
+    if constexpr (HasNativePacketV<Scalar>) {
+      return NativePacketT<Scalar>::hasDivision;
+    } else {
+      return false;
+    }
+  }
+
+public:
+  static constexpr bool value = HasDivision();
+};
+
+template<typename BinaryOp, typename Scalar>
+static constexpr bool IsPacketOpV = IsPacketOp<BinaryOp, Scalar>::value;
+
+// Native packets of Scalar support Sqrt
+template<typename Scalar>
+struct HasPacketSqrt {
+private:
+  static constexpr bool HasSqrt()
+  {
+    if constexpr (HasNativePacketV<Scalar>) {
+      return NativePacketT<Scalar>::hasSqrt;
+    } else {
+      return false;
+    }
+  }
+
+public:
+  static constexpr bool value = HasSqrt();
+};
+
+template<typename Scalar>
+static constexpr bool HasPacketSqrtV = HasPacketSqrt<Scalar>::value;
+
+// Widest packet of Scalar no wider than count with a register transpose of width x width
+// blocks, void if there is none
+template<typename Scalar, size_t count = std::numeric_limits<size_t>::max()>
+struct TransposePacket {
+private:
+  template<size_t width>
+  static constexpr bool HasTranspose()
+  {
+    if constexpr (HasPacketV<Scalar, width>) {
+      return count >= width && Packet<Scalar, width>::hasTranspose;
+    } else {
+      return false;
+    }
+  }
+
+  static constexpr size_t PickWidth()
+  {
+    if (HasTranspose<8>()) {
+      return 8;
+    } else if (HasTranspose<4>()) {
+      return 4;
+    } else if (HasTranspose<2>()) {
+      return 2;
+    }
+    return 0;
+  }
+
+public:
+  static constexpr size_t width = PickWidth();
+  using Type = std::conditional_t<width == 0, void, Packet<Scalar, width>>;
+};
+
+template<typename Scalar, size_t count = std::numeric_limits<size_t>::max()>
+using TransposePacketT = typename TransposePacket<Scalar, count>::Type;
+
+}  // namespace gtk::simd
\ No newline at end of file
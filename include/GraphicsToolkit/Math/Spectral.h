@@ -0,0 +1,290 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "Execution.h"
+#include "Matrix.h"
+#include "Tensor.h"
+#include "Vector.h"
+
+// Eigen decomposition of symmetric 3x3 matrices and singular value decomposition of small square
+// matrices, both by Jacobi rotations. Each rotation zeroes one off diagonal pair with the
+// numerically stable tangent formula, written without a branch for the pairs that are already
+// zero, and a sweep rotates every pair once. Three or four sweeps usually reach rounding error,
+// convergence is checked once per sweep.
+
+template<typename Scalar>
+struct SymmetricEigen3 {
+  // Eigenvalues in descending order, eigenvectors in the matching columns, A = V diag(values) V^T
+  Vector<Scalar, 3> values;
+  Matrix<Scalar, 3, 3> vectors;
+};
+
+template<typename Scalar, size_t n>
+struct SingularValueDecomposition {
+  // Singular values in descending order, A = U diag(singularValues) V^T with U and V orthogonal
+  Matrix<Scalar, n, n> u;
+  Vector<Scalar, n> singularValues;
+  Matrix<Scalar, n, n> v;
+};
+
+// Cosine and sine of the rotation zeroing apq given tau = (aqq - app) / 2, returns the tangent
+template<typename Scalar>
+Scalar JacobiRotation(Scalar tau, Scalar apq, Scalar& c, Scalar& s)
+{
+  Scalar den = std::abs(tau) + std::sqrt(tau * tau + apq * apq);
+  Scalar t = den > Scalar{} ? std::copysign(Scalar{1}, tau) * apq / den : Scalar{};
+  c = Scalar{1} / std::sqrt(t * t + Scalar{1});
+  s = t * c;
+  return t;
+}
+
+inline constexpr size_t jacobiMaxSweeps = 12;
+
+template<typename Scalar, typename Storage>
+SymmetricEigen3<Scalar> Eigen(const BasicTensor<Scalar, Storage, 3, 3>& m)
+{
+  static_assert(std::is_floating_point_v<Scalar>, "Eigen requires floating point matrices.");
+  constexpr Scalar epsilon = std::numeric_limits<Scalar>::epsilon();
+
+  // Only the lower triangle is read
+  Scalar a[3][3] = {
+    {m(0, 0), m(1, 0), m(2, 0)}, {m(1, 0), m(1, 1), m(2, 1)}, {m(2, 0), m(2, 1), m(2, 2)}
+  };
+  Scalar v[3][3] = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+
+  for (size_t sweep = 0; sweep < jacobiMaxSweeps; ++sweep) {
+    Scalar off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+    Scalar diagonal = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+    if (off <= epsilon * epsilon * diagonal) {
+      break;
+    }
+
+    constexpr size_t pairs[3][3] = {{0, 1, 2}, {0, 2, 1}, {1, 2, 0}};
+    for (const auto& pair : pairs) {
+      size_t p = pair[0];
+      size_t q = pair[1];
+      size_t r = pair[2];
+      Scalar c;
+      Scalar s;
+      Scalar apq = a[p][q];
+      Scalar t = JacobiRotation((a[q][q] - a[p][p]) / 2, apq, c, s);
+      a[p][p] -= t * apq;
+      a[q][q] += t * apq;
+      a[p][q] = a[q][p] = Scalar{};
+      Scalar arp = a[r][p];
+      Scalar arq = a[r][q];
+      a[r][p] = a[p][r] = c * arp - s * arq;
+      a[r][q] = a[q][r] = s * arp + c * arq;
+      for (size_t i = 0; i < 3; ++i) {
+        Scalar vip = v[i][p];
+        Scalar viq = v[i][q];
+        v[i][p] = c * vip - s * viq;
+        v[i][q] = s * vip + c * viq;
+      }
+    }
+  }
+
+  // Sorting network over the three eigenvalues, the eigenvectors follow
+  size_t order[3] = {0, 1, 2};
+  auto sort = [&](size_t i, size_t j) {
+    if (a[order[i]][order[i]] < a[order[j]][order[j]]) {
+      std::swap(order[i], order[j]);
+    }
+  };
+  sort(0, 1);
+  sort(1, 2);
+  sort(0, 1);
+
+  SymmetricEigen3<Scalar> result;
+  for (size_t j = 0; j < 3; ++j) {
+    result.values[j] = a[order[j]][order[j]];
+    for (size_t i = 0; i < 3; ++i) {
+      result.vectors(i, j) = v[i][order[j]];
+    }
+  }
+  return result;
+}
+
+// One sided Jacobi: rotations orthogonalize the columns of A, the rotated columns are U scaled by
+// the singular values. Columns of U for zero singular values are completed to an orthonormal
+// basis.
+template<typename Scalar, typename Storage, size_t n>
+SingularValueDecomposition<Scalar, n> Svd(const BasicTensor<Scalar, Storage, n, n>& m)
+{
+  static_assert(std::is_floating_point_v<Scalar>, "Svd requires floating point matrices.");
+  static_assert(n >= 1 && n <= 4, "Svd is only provided up to 4x4.");
+  constexpr Scalar epsilon = std::numeric_limits<Scalar>::epsilon();
+
+  Matrix<Scalar, n, n> u(m);
+  Matrix<Scalar, n, n> v{};
+  for (size_t i = 0; i < n; ++i) {
+    v(i, i) = 1;
+  }
+
+  for (size_t sweep = 0; sweep < jacobiMaxSweeps; ++sweep) {
+    bool converged = true;
+    for (size_t p = 0; p + 1 < n; ++p) {
+      for (size_t q = p + 1; q < n; ++q) {
+        Scalar alpha{};
+        Scalar beta{};
+        Scalar gamma{};
+        for (size_t i = 0; i < n; ++i) {
+          alpha += u(i, p) * u(i, p);
+          beta += u(i, q) * u(i, q);
+          gamma += u(i, p) * u(i, q);
+        }
+        converged = converged && gamma * gamma <= epsilon * epsilon * alpha * beta;
+
+        Scalar c;
+        Scalar s;
+        JacobiRotation((beta - alpha) / 2, gamma, c, s);
+        for (size_t i = 0; i < n; ++i) {
+          Scalar uip = u(i, p);
+          Scalar uiq = u(i, q);
+          u(i, p) = c * uip - s * uiq;
+          u(i, q) = s * uip + c * uiq;
+          Scalar vip = v(i, p);
+          Scalar viq = v(i, q);
+          v(i, p) = c * vip - s * viq;
+          v(i, q) = s * vip + c * viq;
+        }
+      }
+    }
+    if (converged) {
+      break;
+    }
+  }
+
+  Vector<Scalar, n> sigma{};
+  for (size_t j = 0; j < n; ++j) {
+    Scalar sum{};
+    for (size_t i = 0; i < n; ++i) {
+      sum += u(i, j) * u(i, j);
+    }
+    sigma[j] = std::sqrt(sum);
+  }
+
+  // Selection sort of at most four columns
+  size_t order[n];
+  for (size_t j = 0; j < n; ++j) {
+    order[j] = j;
+  }
+  for (size_t j = 0; j < n; ++j) {
+    for (size_t k = j + 1; k < n; ++k) {
+      if (sigma[order[k]] > sigma[order[j]]) {
+        std::swap(order[j], order[k]);
+      }
+    }
+  }
+
+  SingularValueDecomposition<Scalar, n> result;
+  Scalar tolerance = epsilon * static_cast<Scalar>(n) * sigma[order[0]];
+  for (size_t j = 0; j < n; ++j) {
+    Scalar sj = sigma[order[j]];
+    result.singularValues[j] = sj;
+    for (size_t i = 0; i < n; ++i) {
+      result.u(i, j) = sj > tolerance ? u(i, order[j]) / sj : Scalar{};
+      result.v(i, j) = v(i, order[j]);
+    }
+    if (sj > tolerance) {
+      continue;
+    }
+
+    // Gram-Schmidt of the unit vector least covered by the columns found so far
+    Scalar best{};
+    for (size_t e = 0; e < n; ++e) {
+      Scalar candidate[n] = {};
+      candidate[e] = 1;
+      for (size_t k = 0; k < j; ++k) {
+        Scalar d = result.u(e, k);
+        for (size_t i = 0; i < n; ++i) {
+          candidate[i] -= d * result.u(i, k);
+        }
+      }
+      Scalar norm{};
+      for (size_t i = 0; i < n; ++i) {
+        norm += candidate[i] * candidate[i];
+      }
+      if (norm > best) {
+        best = norm;
+        Scalar inv = Scalar{1} / std::sqrt(norm);
+        for (size_t i = 0; i < n; ++i) {
+          result.u(i, j) = candidate[i] * inv;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+// Batches, out[i] decomposes m[i]
+
+template<typename Scalar, typename Storage>
+void EigenBatch(
+  const BasicTensor<Scalar, Storage, 3, 3>* m,
+  size_t count,
+  SymmetricEigen3<Scalar>* out
+)
+{
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = Eigen(m[i]);
+  }
+}
+
+template<typename Scalar, typename Storage, size_t n>
+void SvdBatch(
+  const BasicTensor<Scalar, Storage, n, n>* m,
+  size_t count,
+  SingularValueDecomposition<Scalar, n>* out
+)
+{
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = Svd(m[i]);
+  }
+}
+
+// Batches under an execution policy, split in chunks of consecutive matrices. A decomposition
+// costs about four sweeps of n (n - 1) / 2 rotations of 6 n multiply adds.
+
+template<size_t n>
+inline constexpr size_t jacobiBatchCost = 4 * (n * (n - 1) / 2) * 6 * n;
+
+template<
+  typename Policy,
+  typename Scalar,
+  typename Storage,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void EigenBatch(
+  const Policy& policy,
+  const BasicTensor<Scalar, Storage, 3, 3>* m,
+  size_t count,
+  SymmetricEigen3<Scalar>* out
+)
+{
+  gtk::exec::ForEachChunk(policy, count, jacobiBatchCost<3>, [&](size_t first, size_t last) {
+    EigenBatch(m + first, last - first, out + first);
+  });
+}
+
+template<
+  typename Policy,
+  typename Scalar,
+  typename Storage,
+  size_t n,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void SvdBatch(
+  const Policy& policy,
+  const BasicTensor<Scalar, Storage, n, n>* m,
+  size_t count,
+  SingularValueDecomposition<Scalar, n>* out
+)
+{
+  gtk::exec::ForEachChunk(policy, count, jacobiBatchCost<n>, [&](size_t first, size_t last) {
+    SvdBatch(m + first, last - first, out + first);
+  });
+}
\ No newline at end of file
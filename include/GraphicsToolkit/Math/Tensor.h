@@ -1,31 +1,120 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <iterator>
+#include <type_traits>
 
 #include "Dimension.h"
+#include "Simd.h"
 #include "Tuple.h"
 
-template<typename Scalar, size_t... dims>
-class Tensor
+// Specialized by TensorExpression.h for lazily evaluated expression nodes
+template<typename T>
+struct IsTensorExprClass {
+  static constexpr bool value = false;
+};
+
+template<typename T>
+static constexpr bool IsTensorExprClassV = IsTensorExprClass<T>::value;
+
+// Non-owning tensors reading another tensor's storage in place
+template<typename T>
+struct IsTensorViewClass {
+  static constexpr bool value = false;
+};
+
+template<typename T>
+static constexpr bool IsTensorViewClassV = IsTensorViewClass<T>::value;
+
+// Tensor-like types without storage of their own, materialized by assigning them to a Tensor
+template<typename T>
+static constexpr bool IsLazyTensorClassV = IsTensorExprClassV<T> || IsTensorViewClassV<T>;
+
+// Flat operands whose elements can be computed a gtk::simd::Packet<Scalar, width> at a time
+template<typename T, typename Scalar>
+struct IsVectorizable {
+  static constexpr bool value = false;
+};
+
+template<typename T, typename Scalar>
+static constexpr bool IsVectorizableV = IsVectorizable<T, Scalar>::value;
+
+// Storage policies, the layout of the count logical elements of a BasicTensor
+//   Packed         count elements with the alignment of Scalar
+//   Aligned<n>     count elements starting on an n byte boundary
+//   PaddedTo<n>    count rounded up to a multiple of n elements, aligned to n elements when that
+//                  is a power of two, so a PaddedTo<4> float vec3 is a single 16 byte lane
+//
+// Padding elements are zero initialized and are not elements of the tensor: count, iteration and
+// comparisons only see the logical ones. Evaluating an expression may write to the padding.
+
+struct Packed {
+  template<typename Scalar, size_t count>
+  static constexpr size_t storedCount = count;
+
+  template<typename Scalar, size_t count>
+  static constexpr size_t alignment = alignof(Scalar);
+};
+
+template<size_t bytes>
+struct Aligned {
+  static_assert(bytes > 0 && (bytes & (bytes - 1)) == 0, "Alignment must be a power of two.");
+
+  template<typename Scalar, size_t count>
+  static constexpr size_t storedCount = count;
+
+  template<typename Scalar, size_t count>
+  static constexpr size_t alignment = std::max(bytes, alignof(Scalar));
+};
+
+template<size_t multiple>
+struct PaddedTo {
+  static_assert(multiple > 0, "Must pad to a positive number of elements.");
+
+  template<typename Scalar, size_t count>
+  static constexpr size_t storedCount = (count + multiple - 1) / multiple * multiple;
+
+  template<typename Scalar, size_t count>
+  static constexpr size_t alignment =
+    ((multiple & (multiple - 1)) == 0) ? std::max(multiple * sizeof(Scalar), alignof(Scalar))
+                                       : alignof(Scalar);
+};
+
+template<typename Scalar, typename Storage, size_t... dims>
+class BasicTensor
 {
 public:
   using ScalarType = Scalar;
   using DimensionType = TDimension<dims...>;
+  using StorageType = Storage;
   static constexpr size_t rank = DimensionType::rank;
   static constexpr size_t count = DimensionType::count;
 
+  // Physical layout, storedCount - count trailing padding elements
+  static constexpr size_t storedCount = Storage::template storedCount<Scalar, count>;
+  static constexpr size_t alignment = Storage::template alignment<Scalar, count>;
+
+  // Element i is stored at data[i]
+  static constexpr bool isFlat = true;
+
+  // Elements readable through operator[], the padding included
+  static constexpr size_t laneCount = storedCount;
+
   // Constructors
 
   template<typename... Ts>
-  static constexpr std::array<Scalar, DimensionType::count> CTArr(Ts... args)
+  static constexpr std::array<Scalar, storedCount> CTArr(Ts... args)
   {
-    std::array<Scalar, DimensionType::count> arr{};
+    std::array<Scalar, storedCount> arr{};
     size_t i{};
     auto _ = {0, (arr[i++] = args, 0)...};
     return arr;
   }
 
-  template<typename... Ts>
-  constexpr Tensor(Ts... args) : data{CTArr(args...)}
+  template<
+    typename... Ts,
+    typename = std::enable_if_t<!(sizeof...(Ts) == 1 && (IsLazyTensorClassV<Ts> || ...))>>
+  constexpr BasicTensor(Ts... args) : data{CTArr(args...)}
   {
     // Cannot directly assign here because this constructor is constexpr
     // Must use CTArr helper to initialize 'data' in member initializer
@@ -33,7 +122,8 @@ public:
     // auto _ = {0, (data[i++] = args, 0)...};
   }
 
-  constexpr explicit Tensor(std::initializer_list<std::initializer_list<ScalarType>> il)
+  constexpr explicit BasicTensor(std::initializer_list<std::initializer_list<ScalarType>> il)
+      : data{}
   {
     size_t i{};
     for (auto l : il) {
@@ -43,16 +133,30 @@ public:
     }
   }
 
-  // Conversion from another tensor type
-  template<typename OtherScalar, size_t... otherDims>
-  constexpr Tensor(const Tensor<OtherScalar, otherDims...>& other)
+  // Conversion from another tensor type, or the same type with another storage policy
+  template<typename OtherScalar, typename OtherStorage, size_t... otherDims>
+  constexpr BasicTensor(const BasicTensor<OtherScalar, OtherStorage, otherDims...>& other) : data{}
   {
     static_assert(
       DimensionType::count <= TDimension<otherDims...>::count,
       "Must provide a tensor with at least as many elements as the target dimension."
     );
 
-    std::copy(other.data.begin(), other.data.begin() + DimensionType::count, data.begin());
+    std::copy(other.begin(), other.begin() + DimensionType::count, data.begin());
+  }
+
+  // Evaluation of a componentwise expression, all operators fused into a single pass
+  template<typename Expr, typename = std::enable_if_t<IsLazyTensorClassV<Expr>>>
+  constexpr BasicTensor(const Expr& expr) : data{}
+  {
+    Assign(expr);
+  }
+
+  template<typename Expr, typename = std::enable_if_t<IsLazyTensorClassV<Expr>>>
+  constexpr BasicTensor& operator=(const Expr& expr)
+  {
+    Assign(expr);
+    return *this;
   }
 
   // Implicit conversion to scalar
@@ -85,58 +189,123 @@ public:
 
   bool IsZeroFree() const
   {
-    return std::all_of(data.begin(), data.end(), [](const Scalar& val) { return val != 0; });
+    return std::all_of(begin(), end(), [](const Scalar& val) { return val != 0; });
   }
 
   bool OneHot() const
   {
-    return std::count(data.begin(), data.end(), 1) == 1 &&
-           std::count(data.begin(), data.end(), 0) == DimensionType::count - 1;
+    return std::count(begin(), end(), 1) == 1 &&
+           std::count(begin(), end(), 0) == DimensionType::count - 1;
   }
 
-  // Iterators for range-based for loops
+  // Iterators for range-based for loops, over the logical elements only
   constexpr auto begin() { return data.begin(); }
-  constexpr auto end() { return data.end(); }
+  constexpr auto end() { return data.begin() + count; }
   constexpr auto begin() const { return data.begin(); }
-  constexpr auto end() const { return data.end(); }
+  constexpr auto end() const { return data.begin() + count; }
   constexpr auto cbegin() const { return data.cbegin(); }
-  constexpr auto cend() const { return data.cend(); }
-  constexpr auto rbegin() { return data.rbegin(); }
-  constexpr auto rend() { return data.rend(); }
+  constexpr auto cend() const { return data.cbegin() + count; }
+  constexpr auto rbegin() { return std::make_reverse_iterator(end()); }
+  constexpr auto rend() { return std::make_reverse_iterator(begin()); }
 
 #if !defined(GTK_TEST)
 private:
 #endif
-  std::array<Scalar, DimensionType::count> data;
+  template<typename Expr>
+  constexpr void Assign(const Expr& expr)
+  {
+    using ExprDimension = typename Expr::DimensionType;
+    static_assert(
+      DimensionType::count == ExprDimension::count,
+      "Must provide an expression with as many elements as the target dimension."
+    );
+
+    if constexpr (Expr::isFlat) {
+      if constexpr (IsVectorizableV<Expr, Scalar>) {
+        if (!gtk::simd::IsConstantEvaluated()) {
+          // Padding shared by the target and all operands is computed along with the elements
+          AssignPackets<0, std::min(laneCount, Expr::laneCount)>(expr);
+          return;
+        }
+      }
+      for (size_t i = 0; i < DimensionType::count; ++i) {
+        data[i] = static_cast<Scalar>(expr[i]);
+      }
+    } else {
+      // Broadcast operands are read through their strides, one loop per axis
+      ForEachMultiIndex<ExprDimension>([&](size_t i, const auto& index) {
+        data[i] = static_cast<Scalar>(expr.template At<ExprDimension>(index));
+      });
+    }
+  }
+
+  // Elements [first, last) with the widest packets that fit, the tail with narrower ones
+  template<size_t first, size_t last, typename Expr>
+  void AssignPackets(const Expr& expr)
+  {
+    using Packet = gtk::simd::PacketForCountT<Scalar, last - first>;
+    if constexpr (std::is_void_v<Packet>) {
+      for (size_t i = first; i < std::min(last, count); ++i) {
+        data[i] = expr[i];
+      }
+    } else {
+      constexpr size_t packetsEnd = last - (last - first) % Packet::width;
+      for (size_t i = first; i < packetsEnd; i += Packet::width) {
+        expr.template PacketAt<Packet>(i).Store(&data[i]);
+      }
+      AssignPackets<packetsEnd, last>(expr);
+    }
+  }
+
+  alignas(alignment) std::array<Scalar, storedCount> data;
 };
 
-template<typename Scalar>
-class Tensor<Scalar> : public Tensor<Scalar, 1>
+template<typename Scalar, typename Storage>
+class BasicTensor<Scalar, Storage> : public BasicTensor<Scalar, Storage, 1>
 {
 public:
-  Tensor(Scalar x) : Tensor<Scalar, 1>(x) {}
+  BasicTensor(Scalar x) : BasicTensor<Scalar, Storage, 1>(x) {}
 };
 
+template<typename Scalar, size_t... dims>
+using Tensor = BasicTensor<Scalar, Packed, dims...>;
+
 template<typename T>
 struct IsTensorClass {
   static constexpr bool value = false;
 };
 
-template<typename Scalar, size_t... dims>
-struct IsTensorClass<Tensor<Scalar, dims...>> {
+template<typename Scalar, typename Storage, size_t... dims>
+struct IsTensorClass<BasicTensor<Scalar, Storage, dims...>> {
   static constexpr bool value = true;
 };
 
 template<typename T>
 static constexpr bool IsTensorClassV = IsTensorClass<T>::value;
 
+// Single elements are broadcast to a packet after the usual arithmetic conversion
+template<typename S, typename Storage, size_t... dims, typename Scalar>
+struct IsVectorizable<BasicTensor<S, Storage, dims...>, Scalar> {
+  static constexpr bool value =
+    std::is_same_v<S, Scalar> || (TDimension<dims...>::count == 1 && std::is_arithmetic_v<S>);
+};
 
-template<typename Scalar, size_t... dims, typename OtherScalar, size_t... otherDims>
-constexpr bool
-operator==(const Tensor<Scalar, dims...>& lhs, const Tensor<OtherScalar, otherDims...>& rhs)
+
+// Compares the logical elements, tensors with different storage policies can be equal
+template<
+  typename Scalar,
+  typename Storage,
+  size_t... dims,
+  typename OtherScalar,
+  typename OtherStorage,
+  size_t... otherDims>
+constexpr bool operator==(
+  const BasicTensor<Scalar, Storage, dims...>& lhs,
+  const BasicTensor<OtherScalar, OtherStorage, otherDims...>& rhs
+)
 {
-  using Dl = typename Tensor<Scalar, dims...>::DimensionType;
-  using Dr = typename Tensor<OtherScalar, otherDims...>::DimensionType;
+  using Dl = TDimension<dims...>;
+  using Dr = TDimension<otherDims...>;
   if (Dl::count != Dr::count || Dl::rank != Dr::rank ||
       std::is_same_v<Scalar, OtherScalar> == false) {
     return false;
@@ -151,8 +320,9 @@ operator==(const Tensor<Scalar, dims...>& lhs, const Tensor<OtherScalar, otherDi
   return true;
 }
 
-template<typename S1, size_t... dims1, typename S2, size_t... dims2>
-constexpr bool operator!=(const Tensor<S1, dims1...>& lhs, const Tensor<S2, dims2...>& rhs)
+template<typename S1, typename St1, size_t... dims1, typename S2, typename St2, size_t... dims2>
+constexpr bool
+operator!=(const BasicTensor<S1, St1, dims1...>& lhs, const BasicTensor<S2, St2, dims2...>& rhs)
 {
   return !(lhs == rhs);
 }
@@ -189,6 +359,73 @@ template<typename D>
 inline constexpr auto DimensionAsTupleV = DimensionAsTuple<D>::value;
 
 
+// Reads element index of ToDimension from t, as if t had been broadcast to ToDimension
+template<typename ToDimension, typename T>
+constexpr decltype(auto) BroadcastAt(const T& t, const std::array<size_t, ToDimension::rank>& index)
+{
+  if constexpr (IsTensorClassV<T>) {
+    return t[BroadcastOffset<typename T::DimensionType, ToDimension>(index)];
+  } else {
+    return t.template At<ToDimension>(index);
+  }
+}
+
+// Zero-copy broadcast: reads FromTensor in place through compile-time strides that are zero along
+// the broadcast axes
+template<typename ToDimension, typename FromTensor>
+class BroadcastView
+{
+  using FromDimension = typename FromTensor::DimensionType;
+
+public:
+  using ScalarType = typename FromTensor::ScalarType;
+  using DimensionType = ToDimension;
+  static constexpr size_t rank = DimensionType::rank;
+  static constexpr size_t count = DimensionType::count;
+  static constexpr bool isFlat = (FromDimension::count == count);
+  static constexpr size_t laneCount = count;
+  static constexpr auto strides = BroadcastStridesV<FromDimension, ToDimension>;
+
+  constexpr explicit BroadcastView(const FromTensor& t) : t{t} {}
+
+  constexpr const ScalarType& operator[](size_t i) const
+  {
+    if constexpr (isFlat) {
+      return t[i];
+    } else {
+      return t[InnerProduct(strides, DimensionType::MultiIndex(i))];
+    }
+  }
+
+  template<typename... Ts>
+  constexpr const ScalarType& operator()(const Ts... indices) const
+  {
+    std::array<size_t, rank> index = {static_cast<size_t>(indices)...};
+    return t[InnerProduct(strides, index)];
+  }
+
+  template<typename D>
+  constexpr const ScalarType& At(const std::array<size_t, D::rank>& index) const
+  {
+    // Broadcasting composes, so FromDimension maps to D directly
+    return t[BroadcastOffset<FromDimension, D>(index)];
+  }
+
+private:
+  const FromTensor& t;
+};
+
+template<typename ToDimension, typename FromTensor>
+struct IsTensorViewClass<BroadcastView<ToDimension, FromTensor>> {
+  static constexpr bool value = true;
+};
+
+template<typename ToDimension, typename FromTensor>
+constexpr auto MakeBroadcastView(const FromTensor& t)
+{
+  return BroadcastView<ToDimension, FromTensor>{t};
+}
+
 template<typename ToDimension, typename FromTensor>
 constexpr auto Broadcast(const FromTensor& t)
 {
@@ -196,20 +433,11 @@ constexpr auto Broadcast(const FromTensor& t)
 
   static_assert(CanBroadcast<FromDimension, ToDimension>::value);
 
-  using FromDimensionPadded = typename PadDim<FromDimension, ToDimension>::D1Padded;
-
   using ToTensor = MakeTensorFromDimensionT<typename FromTensor::ScalarType, ToDimension>;
-  ToTensor result;
-
-  for (size_t i = 0; i < ToDimension::count; ++i) {
-    auto toMultiIndexTuple = ToDimension::UnflattenedIndex(i);
-    auto fromDimTuple = DimensionAsTupleV<FromDimensionPadded>;
-    auto clampedMultiIndexTuple = gtk::Transform(
-      toMultiIndexTuple, fromDimTuple,
-      [](size_t index, size_t dim) { return std::min(index, dim - 1); }
-    );
-    auto fromIndex = FromDimension::FlattenedIndex(clampedMultiIndexTuple);
-    result[i] = t[fromIndex];
-  }
+  ToTensor result{};
+
+  ForEachMultiIndex<ToDimension>([&](size_t i, const auto& index) {
+    result[i] = BroadcastAt<ToDimension>(t, index);
+  });
   return result;
-}
+}
\ No newline at end of file
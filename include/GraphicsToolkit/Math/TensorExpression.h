@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "Tensor.h"
+
+// Lazily evaluated componentwise expressions
+//
+// Operators on tensors build a tree of TensorExpr nodes instead of computing a result. The tree
+// is evaluated element by element when it is assigned to a Tensor, so a chain like a * b + c * d
+// is computed in one pass without intermediate tensors.
+//
+// Named tensors are referenced by the nodes, temporaries and nested nodes are held by value.
+// Like any view, an expression must not outlive the named tensors it references.
+
+template<typename T>
+struct IsTensorOperand {
+  static constexpr bool value = IsTensorClassV<T> || IsTensorExprClassV<T> || IsTensorViewClassV<T>;
+};
+
+template<typename T>
+inline constexpr bool IsTensorOperandV = IsTensorOperand<std::decay_t<T>>::value;
+
+template<typename T>
+inline constexpr bool IsScalarOperandV = std::is_arithmetic_v<std::decay_t<T>>;
+
+template<typename T, typename U = std::decay_t<T>, bool isTensorOperand = IsTensorOperand<U>::value>
+struct ExprOperand {
+  // Plain scalars behave like single element tensors
+  using Type = Tensor<U, 1>;
+};
+
+template<typename T, typename U>
+struct ExprOperand<T, U, true> {
+  static constexpr bool isNamedTensor = IsTensorClassV<U> && std::is_lvalue_reference_v<T>;
+  using Type = std::conditional_t<isNamedTensor, const U&, U>;
+};
+
+// Storage type of an operand passed as T&& to an operator
+template<typename T>
+using ExprOperandT = typename ExprOperand<T>::Type;
+
+template<typename D1, typename D2>
+struct BroadcastDimension {
+  static constexpr bool canBroadcastToD1 = CanBroadcast<D2, D1>::value;
+  static constexpr bool canBroadcastToD2 = CanBroadcast<D1, D2>::value;
+  static_assert(
+    canBroadcastToD1 || canBroadcastToD2,
+    "Cannot perform componentwise operation: dimensions are not compatible for broadcasting."
+  );
+
+  using Type = std::conditional_t<canBroadcastToD1, D1, D2>;
+};
+
+template<typename D1, typename D2>
+using BroadcastDimensionT = typename BroadcastDimension<D1, D2>::Type;
+
+// Element i of the broadcast of T to D is element i of T, or T holds a single element
+template<typename T, typename D>
+inline constexpr bool IsFlatOperandV =
+  (T::DimensionType::count == D::count && T::isFlat) ||
+  (T::DimensionType::count == 1 && IsTensorClassV<T>);
+
+// Flat elements readable from an operand, single elements are repeated indefinitely
+template<typename T>
+inline constexpr size_t OperandLaneCountV = (T::DimensionType::count == 1 && IsTensorClassV<T>)
+                                              ? std::numeric_limits<size_t>::max()
+                                              : T::laneCount;
+
+template<typename BinaryOp, typename Lhs, typename Rhs>
+class TensorExpr
+{
+  using LhsType = std::decay_t<Lhs>;
+  using RhsType = std::decay_t<Rhs>;
+  using LhsDimension = typename LhsType::DimensionType;
+  using RhsDimension = typename RhsType::DimensionType;
+
+public:
+  using DimensionType = BroadcastDimensionT<LhsDimension, RhsDimension>;
+  using ScalarType = std::decay_t<decltype(std::declval<const BinaryOp&>()(
+    std::declval<typename LhsType::ScalarType>(), std::declval<typename RhsType::ScalarType>()
+  ))>;
+  using TensorType = MakeTensorFromDimensionT<ScalarType, DimensionType>;
+  static constexpr size_t rank = DimensionType::rank;
+  static constexpr size_t count = DimensionType::count;
+
+  // Element i only depends on element i of each operand, or on single element operands
+  static constexpr bool isFlat =
+    IsFlatOperandV<LhsType, DimensionType> && IsFlatOperandV<RhsType, DimensionType>;
+
+  // Elements readable through operator[], the padding lanes shared by all operands included
+  static constexpr size_t laneCount = [] {
+    size_t lanes = std::min(OperandLaneCountV<LhsType>, OperandLaneCountV<RhsType>);
+    return (isFlat && lanes != std::numeric_limits<size_t>::max()) ? lanes : count;
+  }();
+
+  constexpr TensorExpr(Lhs lhs, Rhs rhs, BinaryOp op)
+      : lhs{std::move(lhs)},
+        rhs{std::move(rhs)},
+        op{std::move(op)}
+  {
+  }
+
+  // Accessors, same conventions as Tensor
+  // operator[] for flattened index access
+  // operator() for multi-dimensional access
+
+  constexpr ScalarType operator[](size_t i) const
+  {
+    if constexpr (isFlat) {
+      return op(FlatAt(lhs, i), FlatAt(rhs, i));
+    } else {
+      return At<DimensionType>(DimensionType::MultiIndex(i));
+    }
+  }
+
+  template<typename... Ts>
+  constexpr ScalarType operator()(const Ts... indices) const
+  {
+    return (*this)[DimensionType::FlattenedIndex(indices...)];
+  }
+
+  // Implicit conversion to scalar
+  template<typename D = DimensionType, typename = std::enable_if_t<D::count == 1>>
+  constexpr operator ScalarType() const
+  {
+    return (*this)[0];
+  }
+
+  // Element index of the broadcast of this expression to D, operands are read in place
+  template<typename D>
+  constexpr ScalarType At(const std::array<size_t, D::rank>& index) const
+  {
+    return op(BroadcastAt<D>(lhs, index), BroadcastAt<D>(rhs, index));
+  }
+
+  constexpr TensorType Eval() const { return TensorType{*this}; }
+
+  // Elements [i, i + Packet::width) at once, only for expressions that are IsVectorizable
+  template<typename Packet>
+  Packet PacketAt(size_t i) const
+  {
+    return op(OperandPacketAt<Packet>(lhs, i), OperandPacketAt<Packet>(rhs, i));
+  }
+
+private:
+  template<typename Packet, typename T>
+  static Packet OperandPacketAt(const T& t, size_t i)
+  {
+    using Scalar = typename Packet::ScalarType;
+    if constexpr (IsTensorExprClassV<T>) {
+      return t.template PacketAt<Packet>(i);
+    } else if constexpr (T::DimensionType::count == 1) {
+      return Packet::Broadcast(static_cast<Scalar>(t[0]));
+    } else {
+      return Packet::Load(&t[i]);
+    }
+  }
+
+  template<typename T>
+  static constexpr decltype(auto) FlatAt(const T& t, size_t i)
+  {
+    if constexpr (std::decay_t<T>::DimensionType::count == 1) {
+      return t[0];
+    } else {
+      return t[i];
+    }
+  }
+
+  Lhs lhs;
+  Rhs rhs;
+  BinaryOp op;
+};
+
+template<typename BinaryOp, typename Lhs, typename Rhs>
+struct IsTensorExprClass<TensorExpr<BinaryOp, Lhs, Rhs>> {
+  static constexpr bool value = true;
+};
+
+template<typename BinaryOp, typename Lhs, typename Rhs, typename Scalar>
+struct IsVectorizable<TensorExpr<BinaryOp, Lhs, Rhs>, Scalar> {
+  using ExprType = TensorExpr<BinaryOp, Lhs, Rhs>;
+  static constexpr bool value = ExprType::isFlat &&
+                                std::is_same_v<typename ExprType::ScalarType, Scalar> &&
+                                gtk::simd::IsPacketOpV<BinaryOp, Scalar> &&
+                                IsVectorizableV<std::decay_t<Lhs>, Scalar> &&
+                                IsVectorizableV<std::decay_t<Rhs>, Scalar>;
+};
+
+// Materializes any tensor operand, tensors themselves are passed through
+template<typename T>
+constexpr decltype(auto) Eval(const T& t)
+{
+  if constexpr (IsTensorExprClassV<T>) {
+    return t.Eval();
+  } else {
+    return (t);
+  }
+}
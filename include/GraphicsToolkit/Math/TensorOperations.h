@@ -1,64 +1,130 @@
 #pragma once
 
+#include <functional>
+
+#include "DynamicTensor.h"
+#include "Execution.h"
+#include "Simd.h"
 #include "Tensor.h"
+#include "TensorExpression.h"
 
-template<typename T1, typename T2, typename BinaryOp>
+// Both operands are usable in a componentwise operation, and at least one of them is a tensor
+template<typename T1, typename T2>
+inline constexpr bool IsComponentwiseOperandsV =
+  (IsTensorOperandV<T1> || IsDynamicOperandV<T1> || IsScalarOperandV<T1>) &&
+  (IsTensorOperandV<T2> || IsDynamicOperandV<T2> || IsScalarOperandV<T2>) &&
+  (IsTensorOperandV<T1> || IsDynamicOperandV<T1> || IsTensorOperandV<T2> || IsDynamicOperandV<T2>);
+
+template<
+  typename T1,
+  typename T2,
+  typename BinaryOp,
+  bool isDynamic = IsDynamicOperandV<T1> || IsDynamicOperandV<T2>>
 struct ComponentwiseOpHelper {
-  using T1Actual = std::conditional_t<IsTensorClassV<T1>, T1, Tensor<T1, 1>>;
-  using T2Actual = std::conditional_t<IsTensorClassV<T2>, T2, Tensor<T2, 1>>;
-  using D1Actual = typename T1Actual::DimensionType;
-  using D2Actual = typename T2Actual::DimensionType;
+  using T1Actual = ExprOperandT<T1>;
+  using T2Actual = ExprOperandT<T2>;
+  using D1Actual = typename std::decay_t<T1Actual>::DimensionType;
+  using D2Actual = typename std::decay_t<T2Actual>::DimensionType;
 
-  static constexpr bool canBroadcastToT1 = CanBroadcast<D2Actual, D1Actual>::value;
-  static constexpr bool canBroadcastToT2 = CanBroadcast<D1Actual, D2Actual>::value;
-  static_assert(
-    canBroadcastToT1 || canBroadcastToT2,
-    "Cannot perform componentwise operation: dimensions are not compatible for broadcasting."
-  );
+  using D = BroadcastDimensionT<D1Actual, D2Actual>;
+  using ExprType = TensorExpr<std::decay_t<BinaryOp>, T1Actual, T2Actual>;
 
-  using D = std::conditional_t<canBroadcastToT1, D1Actual, D2Actual>;
+  // Nothing is computed here, the returned node is evaluated when assigned to a tensor
+  static constexpr ExprType Impl(T1&& t1, T2&& t2, BinaryOp&& op)
+  {
+    return ExprType{
+      T1Actual(std::forward<T1>(t1)), T2Actual(std::forward<T2>(t2)), std::forward<BinaryOp>(op)
+    };
+  };
+};
 
-  static constexpr auto Impl(const T1Actual& t1, const T2Actual& t2, BinaryOp&& op)
+// Shapes only known at runtime, broadcasting is checked when the node is built
+template<typename T1, typename T2, typename BinaryOp>
+struct ComponentwiseOpHelper<T1, T2, BinaryOp, true> {
+  using T1Actual = DynamicExprOperandT<T1>;
+  using T2Actual = DynamicExprOperandT<T2>;
+  using ExprType = DynamicTensorExpr<std::decay_t<BinaryOp>, T1Actual, T2Actual>;
+
+  static ExprType Impl(T1&& t1, T2&& t2, BinaryOp&& op)
   {
-    auto bt1 = Broadcast<D>(t1);
-    auto bt2 = Broadcast<D>(t2);
-    using Ret = MakeTensorFromDimensionT<decltype(op(t1(0), t2(0))), D>;
-    Ret result;
-    for (size_t i = 0; i < D::count; ++i) {
-      result[i] = std::forward<BinaryOp>(op)(bt1[i], bt2[i]);
-    }
-    return result;
+    return ExprType{
+      T1Actual(std::forward<T1>(t1)), T2Actual(std::forward<T2>(t2)), std::forward<BinaryOp>(op)
+    };
   };
 };
 
 template<typename T1, typename T2, typename BinaryOp>
-constexpr auto ComponentwiseOperation(const T1& t1, const T2& t2, BinaryOp&& op)
+constexpr auto ComponentwiseOperation(T1&& t1, T2&& t2, BinaryOp&& op)
 {
-  return ComponentwiseOpHelper<T1, T2, BinaryOp>::Impl(t1, t2, std::forward<BinaryOp>(op));
+  return ComponentwiseOpHelper<T1, T2, BinaryOp>::Impl(
+    std::forward<T1>(t1), std::forward<T2>(t2), std::forward<BinaryOp>(op)
+  );
 }
 
-template<typename T1, typename T2>
-constexpr auto operator+(const T1& t1, const T2& t2)
+template<typename T1, typename T2, typename = std::enable_if_t<IsComponentwiseOperandsV<T1, T2>>>
+constexpr auto operator+(T1&& t1, T2&& t2)
 {
-  return ComponentwiseOperation(t1, t2, [](auto a, auto b) { return a + b; });
+  return ComponentwiseOperation(std::forward<T1>(t1), std::forward<T2>(t2), std::plus<>{});
 }
 
-template<typename T1, typename T2>
-constexpr auto operator-(const T1& t1, const T2& t2)
+template<typename T1, typename T2, typename = std::enable_if_t<IsComponentwiseOperandsV<T1, T2>>>
+constexpr auto operator-(T1&& t1, T2&& t2)
 {
-  return ComponentwiseOperation(t1, t2, [](auto a, auto b) { return a - b; });
+  return ComponentwiseOperation(std::forward<T1>(t1), std::forward<T2>(t2), std::minus<>{});
 }
 
-template<typename T1, typename T2>
-constexpr auto operator*(const T1& t1, const T2& t2)
+template<typename T1, typename T2, typename = std::enable_if_t<IsComponentwiseOperandsV<T1, T2>>>
+constexpr auto operator*(T1&& t1, T2&& t2)
 {
-  return ComponentwiseOperation(t1, t2, [](auto a, auto b) { return a * b; });
+  return ComponentwiseOperation(std::forward<T1>(t1), std::forward<T2>(t2), std::multiplies<>{});
 }
 
-template<typename T1, typename T2>
-constexpr auto operator/(const T1& t1, const T2& t2)
+template<typename T1, typename T2, typename = std::enable_if_t<IsComponentwiseOperandsV<T1, T2>>>
+constexpr auto operator/(T1&& t1, T2&& t2)
 {
-  return ComponentwiseOperation(t1, t2, [](auto a, auto b) { return a / b; });
+  return ComponentwiseOperation(std::forward<T1>(t1), std::forward<T2>(t2), std::divides<>{});
 }
 
+// Evaluates a tensor expression into out under an execution policy, in chunks of the flattened
+// elements
+template<
+  typename Policy,
+  typename Scalar,
+  typename Storage,
+  size_t... dims,
+  typename Expr,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void Assign(const Policy& policy, BasicTensor<Scalar, Storage, dims...>& out, const Expr& expr)
+{
+  using D = TDimension<dims...>;
+  using ExprDimension = typename Expr::DimensionType;
+  static_assert(
+    IsTensorClassV<Expr> || IsLazyTensorClassV<Expr>, "Assign evaluates tensor expressions."
+  );
+  static_assert(
+    D::count == ExprDimension::count,
+    "Must provide an expression with as many elements as the target dimension."
+  );
 
+  Scalar* data = &out[0];
+  gtk::exec::ForEachChunk(policy, D::count, 1, [&](size_t first, size_t last) {
+    size_t i = first;
+    if constexpr (Expr::isFlat) {
+      if constexpr (IsVectorizableV<Expr, Scalar> && gtk::simd::HasNativePacketV<Scalar>) {
+        using Packet = gtk::simd::NativePacketT<Scalar>;
+        size_t packetsEnd = last - (last - first) % Packet::width;
+        for (; i < packetsEnd; i += Packet::width) {
+          expr.template PacketAt<Packet>(i).Store(data + i);
+        }
+      }
+      for (; i < last; ++i) {
+        data[i] = static_cast<Scalar>(expr[i]);
+      }
+    } else {
+      for (; i < last; ++i) {
+        auto index = ExprDimension::MultiIndex(i);
+        data[i] = static_cast<Scalar>(expr.template At<ExprDimension>(index));
+      }
+    }
+  });
+}
\ No newline at end of file
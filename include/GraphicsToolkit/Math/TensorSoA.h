@@ -0,0 +1,610 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
+#include "DynamicTensor.h"
+#include "Matrix.h"
+#include "Simd.h"
+#include "Tensor.h"
+#include "TensorExpression.h"
+#include "Vector.h"
+
+// Batches of small tensors stored as a structure of arrays
+//
+// Component c of every element lives in its own contiguous lane array, so a batch operation is a
+// loop over contiguous arrays per component instead of a loop over interleaved tensors. Lane
+// arrays start on dynamicTensorAlignment boundaries and are padded to a whole number of aligned
+// blocks, packet operations run over the padding rather than peeling off a scalar tail.
+//
+// soa[i] is a proxy reading and writing element i in place. It can be used wherever a tensor
+// operand is expected and converts to the tensor type by assignment.
+
+template<typename TensorType>
+class TensorSoA;
+
+// Element of a TensorSoA, Scalar is const qualified for read only references
+template<typename TensorType, typename Scalar>
+class TensorSoARef
+{
+public:
+  using ScalarType = typename TensorType::ScalarType;
+  using DimensionType = typename TensorType::DimensionType;
+  static constexpr size_t rank = DimensionType::rank;
+  static constexpr size_t count = DimensionType::count;
+  static constexpr bool isFlat = true;
+  static constexpr size_t laneCount = count;
+
+  TensorSoARef(Scalar* first, size_t stride) : first{first}, stride{stride} {}
+
+  TensorSoARef(const TensorSoARef&) = default;
+
+  // Assignment writes through to the batch, it never rebinds the reference
+  TensorSoARef& operator=(const TensorSoARef& other) { return *this = TensorType{other}; }
+
+  TensorSoARef& operator=(const TensorType& t)
+  {
+    for (size_t c = 0; c < count; ++c) {
+      (*this)[c] = t[c];
+    }
+    return *this;
+  }
+
+  template<typename Expr, typename = std::enable_if_t<IsLazyTensorClassV<Expr>>>
+  TensorSoARef& operator=(const Expr& expr)
+  {
+    return *this = TensorType{expr};
+  }
+
+  // Accessors, same conventions as Tensor
+
+  Scalar& operator[](size_t c) const { return first[c * stride]; }
+
+  template<typename... Ts>
+  Scalar& operator()(const Ts... indices) const
+  {
+    return (*this)[DimensionType::FlattenedIndex(indices...)];
+  }
+
+  template<typename D>
+  ScalarType At(const std::array<size_t, D::rank>& index) const
+  {
+    return (*this)[BroadcastOffset<DimensionType, D>(index)];
+  }
+
+  TensorType Eval() const { return TensorType{*this}; }
+
+private:
+  Scalar* first;
+  size_t stride;
+};
+
+template<typename TensorType, typename Scalar>
+struct IsTensorViewClass<TensorSoARef<TensorType, Scalar>> {
+  static constexpr bool value = true;
+};
+
+template<typename SoA, typename Reference>
+class TensorSoAIterator
+{
+public:
+  TensorSoAIterator(SoA* soa, size_t i) : soa{soa}, i{i} {}
+
+  Reference operator*() const { return (*soa)[i]; }
+
+  TensorSoAIterator& operator++()
+  {
+    ++i;
+    return *this;
+  }
+
+  bool operator==(const TensorSoAIterator& other) const { return i == other.i; }
+  bool operator!=(const TensorSoAIterator& other) const { return i != other.i; }
+
+private:
+  SoA* soa;
+  size_t i;
+};
+
+template<typename TensorType>
+class TensorSoA
+{
+  static_assert(IsTensorClassV<TensorType>, "TensorSoA stores batches of Tensor types.");
+
+public:
+  using ScalarType = typename TensorType::ScalarType;
+  using DimensionType = typename TensorType::DimensionType;
+  using ElementType = TensorType;
+  using Reference = TensorSoARef<TensorType, ScalarType>;
+  using ConstReference = TensorSoARef<TensorType, const ScalarType>;
+  static constexpr size_t components = DimensionType::count;
+
+  // Lane arrays are padded to multiples of this many elements
+  static constexpr size_t laneBlock =
+    std::max(dynamicTensorAlignment / sizeof(ScalarType), size_t{1});
+
+  // Constructors
+
+  TensorSoA() : lanes{DynamicShape{components, 0}} {}
+
+  explicit TensorSoA(size_t size, const TensorType& value = TensorType{}) : TensorSoA()
+  {
+    Resize(size, value);
+  }
+
+  TensorSoA(std::initializer_list<TensorType> elements) : TensorSoA()
+  {
+    Reserve(elements.size());
+    for (const TensorType& t : elements) {
+      PushBack(t);
+    }
+  }
+
+  // From an array of tensors, a transpose of the count x components matrix of their elements
+  TensorSoA(const TensorType* elements, size_t count) : TensorSoA()
+  {
+    Resize(count);
+    if (count > 0) {
+      TransposeInto(&elements[0][0], count, components, elementStride, Lane(0), Capacity());
+    }
+  }
+
+  size_t Size() const { return size; }
+  size_t Capacity() const { return lanes.Shape()[1]; }
+  bool Empty() const { return size == 0; }
+
+  // Size rounded up to a whole block, lanes are readable and writable up to here
+  size_t PaddedSize() const { return RoundUpToBlock(size); }
+
+  void Reserve(size_t capacity)
+  {
+    if (capacity > Capacity()) {
+      DynamicTensor<ScalarType> grown({components, RoundUpToBlock(capacity)});
+      for (size_t c = 0; c < components; ++c) {
+        std::copy(Lane(c), Lane(c) + size, grown.Data() + c * grown.Shape()[1]);
+      }
+      lanes = std::move(grown);
+    }
+  }
+
+  void Resize(size_t newSize, const TensorType& value = TensorType{})
+  {
+    Reserve(newSize);
+    for (size_t c = 0; c < components; ++c) {
+      std::fill(Lane(c) + std::min(size, newSize), Lane(c) + RoundUpToBlock(newSize), value[c]);
+    }
+    size = newSize;
+  }
+
+  void PushBack(const TensorType& t)
+  {
+    if (size == Capacity()) {
+      Reserve(std::max(2 * Capacity(), laneBlock));
+    }
+    (*this)[size++] = t;
+  }
+
+  void Clear() { size = 0; }
+
+  // Writes the elements back to an array of Size() tensors, padding elements are left untouched
+  void CopyTo(TensorType* out) const
+  {
+    if (size > 0) {
+      TransposeInto(Lane(0), components, size, Capacity(), &out[0][0], elementStride);
+    }
+  }
+
+  // Accessors
+
+  Reference operator[](size_t i) { return Reference{Lane(0) + i, Capacity()}; }
+  ConstReference operator[](size_t i) const { return ConstReference{Lane(0) + i, Capacity()}; }
+
+  // Component c of all elements, contiguous and aligned
+  ScalarType* Lane(size_t c) { return lanes.Data() + c * Capacity(); }
+  const ScalarType* Lane(size_t c) const { return lanes.Data() + c * Capacity(); }
+
+  // Iterators over element proxies
+  auto begin() { return TensorSoAIterator<TensorSoA, Reference>{this, 0}; }
+  auto end() { return TensorSoAIterator<TensorSoA, Reference>{this, size}; }
+  auto begin() const { return TensorSoAIterator<const TensorSoA, ConstReference>{this, 0}; }
+  auto end() const { return TensorSoAIterator<const TensorSoA, ConstReference>{this, size}; }
+
+private:
+  // Distance in scalars between consecutive tensors of an array, padding included
+  static constexpr size_t elementStride = sizeof(TensorType) / sizeof(ScalarType);
+
+  static size_t RoundUpToBlock(size_t n) { return (n + laneBlock - 1) / laneBlock * laneBlock; }
+
+  // Row c holds component c, the row length is the capacity
+  DynamicTensor<ScalarType> lanes;
+  size_t size = 0;
+};
+
+template<typename T>
+struct IsTensorSoAClass {
+  static constexpr bool value = false;
+};
+
+template<typename TensorType>
+struct IsTensorSoAClass<TensorSoA<TensorType>> {
+  static constexpr bool value = true;
+};
+
+template<typename T>
+static constexpr bool IsTensorSoAClassV = IsTensorSoAClass<T>::value;
+
+template<typename T1, typename T2>
+bool operator==(const TensorSoA<T1>& lhs, const TensorSoA<T2>& rhs)
+{
+  if (lhs.Size() != rhs.Size() || !std::is_same_v<T1, T2>) {
+    return false;
+  }
+  for (size_t c = 0; c < TensorSoA<T1>::components; ++c) {
+    if (!std::equal(lhs.Lane(c), lhs.Lane(c) + lhs.Size(), rhs.Lane(c))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T1, typename T2>
+bool operator!=(const TensorSoA<T1>& lhs, const TensorSoA<T2>& rhs)
+{
+  return !(lhs == rhs);
+}
+
+// Batch operands: the lane of component c of a batch, or the value every element shares when the
+// operand is a single tensor or a scalar
+
+template<typename T>
+decltype(auto) BatchLane(const T& t, size_t c)
+{
+  if constexpr (IsTensorSoAClassV<T>) {
+    return t.Lane(T::ElementType::count == 1 ? 0 : c);
+  } else if constexpr (IsTensorClassV<T>) {
+    return t[T::count == 1 ? 0 : c];
+  } else {
+    return t;
+  }
+}
+
+template<typename Scalar>
+Scalar BatchLaneAt(const Scalar* lane, size_t i)
+{
+  return lane[i];
+}
+
+template<typename Scalar>
+Scalar BatchLaneAt(Scalar value, size_t)
+{
+  return value;
+}
+
+template<typename Packet>
+Packet BatchLanePacketAt(const typename Packet::ScalarType* lane, size_t i)
+{
+  return Packet::Load(lane + i);
+}
+
+template<typename Packet>
+Packet BatchLanePacketAt(typename Packet::ScalarType value, size_t)
+{
+  return Packet::Broadcast(value);
+}
+
+// Arrays must hold Scalar, shared values are converted like the scalar operation would
+template<typename Lane, typename Scalar>
+static constexpr bool IsPacketLaneV =
+  std::is_pointer_v<Lane> ? std::is_same_v<std::remove_cv_t<std::remove_pointer_t<Lane>>, Scalar>
+                          : std::is_arithmetic_v<Lane>;
+
+template<typename T, bool isScalar = std::is_arithmetic_v<T>>
+struct BatchElement {
+  using Type = T;
+};
+
+template<typename T>
+struct BatchElement<T, true> {
+  using Type = Tensor<T, 1>;
+};
+
+template<typename TensorType>
+struct BatchElement<TensorSoA<TensorType>, false> {
+  using Type = TensorType;
+};
+
+// Element type of a batch, the type itself for tensors, single element tensors for scalars
+template<typename T>
+using BatchElementT = typename BatchElement<T>::Type;
+
+template<typename T>
+size_t BatchSize(const T& t)
+{
+  if constexpr (IsTensorSoAClassV<T>) {
+    return t.Size();
+  } else {
+    return 0;
+  }
+}
+
+template<typename T1, typename T2>
+size_t CommonBatchSize(const T1& t1, const T2& t2)
+{
+  if constexpr (IsTensorSoAClassV<T1> && IsTensorSoAClassV<T2>) {
+    if (t1.Size() != t2.Size()) {
+      throw std::invalid_argument("Batch operands must have the same size.");
+    }
+  }
+  return std::max(BatchSize(t1), BatchSize(t2));
+}
+
+// out[i] = op(lhs[i], rhs[i]) for i < size, lanes are either arrays or shared values. Packets run
+// on to paddedSize, the scalar operation stops at size: it may trap on the zero padding, as
+// integer division does.
+template<typename Scalar, typename LhsLane, typename RhsLane, typename BinaryOp>
+void BatchKernel(
+  Scalar* out,
+  LhsLane lhs,
+  RhsLane rhs,
+  size_t size,
+  size_t paddedSize,
+  const BinaryOp& op
+)
+{
+  size_t i = 0;
+  if constexpr (gtk::simd::IsPacketOpV<BinaryOp, Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    if constexpr (IsPacketLaneV<LhsLane, Scalar> && IsPacketLaneV<RhsLane, Scalar>) {
+      for (; i + Packet::width <= paddedSize; i += Packet::width) {
+        op(BatchLanePacketAt<Packet>(lhs, i), BatchLanePacketAt<Packet>(rhs, i)).Store(out + i);
+      }
+    }
+  }
+  for (; i < size; ++i) {
+    out[i] = static_cast<Scalar>(op(BatchLaneAt(lhs, i), BatchLaneAt(rhs, i)));
+  }
+}
+
+template<typename T1, typename T2>
+struct IsBatchOperands {
+  static constexpr bool isBatch1 = IsTensorSoAClassV<T1>;
+  static constexpr bool isBatch2 = IsTensorSoAClassV<T2>;
+  static constexpr bool isOperand1 = isBatch1 || IsTensorClassV<T1> || std::is_arithmetic_v<T1>;
+  static constexpr bool isOperand2 = isBatch2 || IsTensorClassV<T2> || std::is_arithmetic_v<T2>;
+  static constexpr bool value = (isBatch1 || isBatch2) && isOperand1 && isOperand2;
+};
+
+template<typename T1, typename T2>
+static constexpr bool IsBatchOperandsV =
+  IsBatchOperands<std::decay_t<T1>, std::decay_t<T2>>::value;
+
+// Componentwise operation over a whole batch, tensors and scalars are applied to every element
+template<typename T1, typename T2, typename BinaryOp>
+auto BatchOperation(const T1& t1, const T2& t2, const BinaryOp& op)
+{
+  using Element1 = BatchElementT<T1>;
+  using Element2 = BatchElementT<T2>;
+  static_assert(
+    Element1::count == Element2::count || Element1::count == 1 || Element2::count == 1,
+    "Batch operands must have the same number of components or a single one."
+  );
+
+  using ResultScalar = std::decay_t<decltype(op(
+    std::declval<typename Element1::ScalarType>(), std::declval<typename Element2::ScalarType>()
+  ))>;
+  using ResultDimension =
+    BroadcastDimensionT<typename Element1::DimensionType, typename Element2::DimensionType>;
+  using ResultTensor = MakeTensorFromDimensionT<ResultScalar, ResultDimension>;
+
+  TensorSoA<ResultTensor> result(CommonBatchSize(t1, t2));
+  for (size_t c = 0; c < ResultTensor::count; ++c) {
+    BatchKernel(
+      result.Lane(c), BatchLane(t1, c), BatchLane(t2, c), result.Size(), result.PaddedSize(), op
+    );
+  }
+  return result;
+}
+
+template<typename T1, typename T2, typename = std::enable_if_t<IsBatchOperandsV<T1, T2>>>
+auto operator+(const T1& t1, const T2& t2)
+{
+  return BatchOperation(t1, t2, std::plus<>{});
+}
+
+template<typename T1, typename T2, typename = std::enable_if_t<IsBatchOperandsV<T1, T2>>>
+auto operator-(const T1& t1, const T2& t2)
+{
+  return BatchOperation(t1, t2, std::minus<>{});
+}
+
+template<typename T1, typename T2, typename = std::enable_if_t<IsBatchOperandsV<T1, T2>>>
+auto operator*(const T1& t1, const T2& t2)
+{
+  return BatchOperation(t1, t2, std::multiplies<>{});
+}
+
+template<typename T1, typename T2, typename = std::enable_if_t<IsBatchOperandsV<T1, T2>>>
+auto operator/(const T1& t1, const T2& t2)
+{
+  return BatchOperation(t1, t2, std::divides<>{});
+}
+
+// Dot product of every element, lhs and rhs are batches or a single vector shared by all elements
+template<
+  typename T1,
+  typename T2,
+  typename = std::enable_if_t<IsTensorSoAClassV<T1> || IsTensorSoAClassV<T2>>>
+auto DotBatch(const T1& lhs, const T2& rhs)
+{
+  using Element1 = BatchElementT<T1>;
+  using Element2 = BatchElementT<T2>;
+  using Scalar = typename Element1::ScalarType;
+  constexpr size_t len = Element1::count;
+  static_assert(
+    Element1::rank == 1 && Element2::rank == 1 && Element2::count == len &&
+      std::is_same_v<typename Element2::ScalarType, Scalar>,
+    "Dot requires vectors of the same length and scalar type."
+  );
+
+  size_t n = CommonBatchSize(lhs, rhs);
+  DynamicTensor<Scalar> result({n});
+  Scalar* out = result.Data();
+
+  // All components are accumulated in registers, the result is written once
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    for (; i + Packet::width <= n; i += Packet::width) {
+      Packet sum = BatchLanePacketAt<Packet>(BatchLane(lhs, 0), i) *
+                   BatchLanePacketAt<Packet>(BatchLane(rhs, 0), i);
+      for (size_t c = 1; c < len; ++c) {
+        sum = sum + BatchLanePacketAt<Packet>(BatchLane(lhs, c), i) *
+                      BatchLanePacketAt<Packet>(BatchLane(rhs, c), i);
+      }
+      sum.Store(out + i);
+    }
+  }
+  for (; i < n; ++i) {
+    Scalar sum = BatchLaneAt(BatchLane(lhs, 0), i) * BatchLaneAt(BatchLane(rhs, 0), i);
+    for (size_t c = 1; c < len; ++c) {
+      sum += BatchLaneAt(BatchLane(lhs, c), i) * BatchLaneAt(BatchLane(rhs, c), i);
+    }
+    out[i] = sum;
+  }
+  return result;
+}
+
+// Cross product of every element, lhs and rhs are batches or a single vector shared by all
+template<
+  typename T1,
+  typename T2,
+  typename = std::enable_if_t<IsTensorSoAClassV<T1> || IsTensorSoAClassV<T2>>>
+auto CrossBatch(const T1& lhs, const T2& rhs)
+{
+  using Element1 = BatchElementT<T1>;
+  using Element2 = BatchElementT<T2>;
+  using Scalar = typename Element1::ScalarType;
+  static_assert(
+    Element1::rank == 1 && Element1::count == 3 && Element2::rank == 1 && Element2::count == 3 &&
+      std::is_same_v<typename Element2::ScalarType, Scalar>,
+    "Cross requires 3 component vectors of the same scalar type."
+  );
+
+  TensorSoA<Vector<Scalar, 3>> result(CommonBatchSize(lhs, rhs));
+  auto x0 = BatchLane(lhs, 0), y0 = BatchLane(lhs, 1), z0 = BatchLane(lhs, 2);
+  auto x1 = BatchLane(rhs, 0), y1 = BatchLane(rhs, 1), z1 = BatchLane(rhs, 2);
+  Scalar* x = result.Lane(0);
+  Scalar* y = result.Lane(1);
+  Scalar* z = result.Lane(2);
+
+  auto cross = [&](size_t i, auto at) {
+    auto a0 = at(x0, i), a1 = at(y0, i), a2 = at(z0, i);
+    auto b0 = at(x1, i), b1 = at(y1, i), b2 = at(z1, i);
+    return std::make_tuple(a1 * b2 - a2 * b1, a2 * b0 - a0 * b2, a0 * b1 - a1 * b0);
+  };
+
+  size_t n = result.PaddedSize();
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    auto at = [](auto lane, size_t i) { return BatchLanePacketAt<Packet>(lane, i); };
+    for (; i + Packet::width <= n; i += Packet::width) {
+      auto [cx, cy, cz] = cross(i, at);
+      cx.Store(x + i);
+      cy.Store(y + i);
+      cz.Store(z + i);
+    }
+  }
+  for (; i < n; ++i) {
+    auto at = [](auto lane, size_t i) { return BatchLaneAt(lane, i); };
+    std::tie(x[i], y[i], z[i]) = cross(i, at);
+  }
+  return result;
+}
+
+// Length of every element
+template<typename VectorType>
+DynamicTensor<typename VectorType::ScalarType> LengthBatch(const TensorSoA<VectorType>& v)
+{
+  using Scalar = typename VectorType::ScalarType;
+  constexpr size_t len = VectorType::count;
+  static_assert(
+    VectorType::rank == 1 && std::is_floating_point_v<Scalar>,
+    "LengthBatch requires floating point vectors."
+  );
+
+  size_t n = v.Size();
+  DynamicTensor<Scalar> result({n});
+  Scalar* out = result.Data();
+
+  size_t i = 0;
+  if constexpr (gtk::simd::HasPacketSqrtV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    for (; i + Packet::width <= n; i += Packet::width) {
+      Packet sum = Packet::Load(v.Lane(0) + i) * Packet::Load(v.Lane(0) + i);
+      for (size_t c = 1; c < len; ++c) {
+        sum = sum + Packet::Load(v.Lane(c) + i) * Packet::Load(v.Lane(c) + i);
+      }
+      Sqrt(sum).Store(out + i);
+    }
+  }
+  for (; i < n; ++i) {
+    out[i] = Length(v[i].Eval());
+  }
+  return result;
+}
+
+// Normalizes every element in place, zero vectors become NaN
+template<typename VectorType>
+void NormalizeBatch(TensorSoA<VectorType>& v)
+{
+  using Scalar = typename VectorType::ScalarType;
+  constexpr size_t len = VectorType::count;
+  static_assert(
+    VectorType::rank == 1 && std::is_floating_point_v<Scalar>,
+    "NormalizeBatch requires floating point vectors."
+  );
+
+  size_t n = v.Size();
+  size_t i = 0;
+  if constexpr (gtk::simd::HasPacketSqrtV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    for (; i + Packet::width <= n; i += Packet::width) {
+      Packet sum = Packet::Load(v.Lane(0) + i) * Packet::Load(v.Lane(0) + i);
+      for (size_t c = 1; c < len; ++c) {
+        sum = sum + Packet::Load(v.Lane(c) + i) * Packet::Load(v.Lane(c) + i);
+      }
+      Packet length = Sqrt(sum);
+      for (size_t c = 0; c < len; ++c) {
+        (Packet::Load(v.Lane(c) + i) / length).Store(v.Lane(c) + i);
+      }
+    }
+  }
+  for (; i < n; ++i) {
+    v[i] = Normalize(v[i].Eval());
+  }
+}
+
+// Dot and Cross of batches are the batch functions
+template<
+  typename T1,
+  typename T2,
+  typename = std::enable_if_t<IsTensorSoAClassV<T1> || IsTensorSoAClassV<T2>>>
+auto Dot(const T1& lhs, const T2& rhs)
+{
+  return DotBatch(lhs, rhs);
+}
+
+template<
+  typename T1,
+  typename T2,
+  typename = std::enable_if_t<IsTensorSoAClassV<T1> || IsTensorSoAClassV<T2>>>
+auto Cross(const T1& lhs, const T2& rhs)
+{
+  return CrossBatch(lhs, rhs);
+}
\ No newline at end of file
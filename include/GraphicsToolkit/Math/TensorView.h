@@ -0,0 +1,261 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <type_traits>
+
+#include "Dimension.h"
+#include "Simd.h"
+#include "Tensor.h"
+
+// Views of part of a tensor
+//
+// Row, Col, Slice and SubTensor select elements of a tensor without copying them. A view reads
+// and writes the parent storage through strides computed at compile time from the parent
+// TDimension, only the position of its first element is known at runtime. Views are operands of
+// the componentwise operators and of Mul, views whose elements are contiguous are read with
+// packets. Assigning to a view of a non-const tensor writes the parent in place, element by
+// element like assigning to a tensor, so an operand overlapping the view must only read each
+// element at the index it is written to.
+//
+// Like any view, a TensorView must not outlive the tensor it references.
+
+// Strides of the axes of ParentDimension except removedAxis, of all of them when removedAxis is
+// the rank
+template<typename ParentDimension, size_t removedAxis>
+struct ViewStrides {
+  static constexpr size_t rank = ParentDimension::rank - (removedAxis < ParentDimension::rank);
+
+private:
+  static constexpr std::array<size_t, rank> Compute()
+  {
+    std::array<size_t, rank> strides{};
+    constexpr auto tailProducts = ParentDimension::TailProducts();
+    size_t k = 0;
+    for (size_t i = 0; i < ParentDimension::rank; ++i) {
+      if (i != removedAxis) {
+        strides[k++] = tailProducts[i];
+      }
+    }
+    return strides;
+  }
+
+public:
+  static constexpr std::array<size_t, rank> value = Compute();
+};
+
+// The elements of ViewDimension read through strides are consecutive in memory
+template<typename ViewDimension, size_t rank>
+constexpr bool IsContiguousView(const std::array<size_t, rank>& strides)
+{
+  constexpr auto tailProducts = ViewDimension::TailProducts();
+  for (size_t i = 0; i < rank; ++i) {
+    if (ViewDimension::extents[i] != 1 && strides[i] != tailProducts[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ViewDimension elements of ParentTensor, which is const qualified for read only views, keeping
+// every axis but removedAxis of the parent
+template<typename ParentTensor, typename ViewDimension, size_t removedAxis>
+class TensorView
+{
+  using ParentType = std::remove_const_t<ParentTensor>;
+  using ParentDimension = typename ParentType::DimensionType;
+  static constexpr bool isConst = std::is_const_v<ParentTensor>;
+
+public:
+  using ScalarType = typename ParentType::ScalarType;
+  using DimensionType = ViewDimension;
+  using TensorType = MakeTensorFromDimensionT<ScalarType, DimensionType>;
+  using Pointer = std::conditional_t<isConst, const ScalarType*, ScalarType*>;
+  using Reference = std::conditional_t<isConst, const ScalarType&, ScalarType&>;
+  static constexpr size_t rank = DimensionType::rank;
+  static constexpr size_t count = DimensionType::count;
+
+  static_assert(ViewStrides<ParentDimension, removedAxis>::rank == rank);
+  static constexpr std::array<size_t, rank> strides =
+    ViewStrides<ParentDimension, removedAxis>::value;
+
+  // Element i is stored i elements after the first, like in a tensor
+  static constexpr bool isContiguous = IsContiguousView<DimensionType>(strides);
+
+  // Element i is read through operator[], the strides are applied by the view
+  static constexpr bool isFlat = true;
+  static constexpr size_t laneCount = count;
+
+  constexpr explicit TensorView(Pointer first) : first{first} {}
+
+  constexpr TensorView(const TensorView&) = default;
+
+  // Assignment writes the elements of the parent, it never rebinds the view
+  constexpr TensorView& operator=(const TensorView& other)
+  {
+    Assign(other);
+    return *this;
+  }
+
+  template<
+    typename T,
+    typename = std::enable_if_t<IsTensorClassV<T> || IsLazyTensorClassV<T>>>
+  constexpr TensorView& operator=(const T& t)
+  {
+    Assign(t);
+    return *this;
+  }
+
+  // Accessors, same conventions as Tensor
+  // operator[] for flattened index access
+  // operator() for multi-dimensional access
+
+  constexpr Reference operator[](size_t i) const { return first[Offset(i)]; }
+
+  template<typename... Ts>
+  constexpr Reference operator()(const Ts... indices) const
+  {
+    std::array<size_t, rank> index = {static_cast<size_t>(indices)...};
+    return first[InnerProduct(strides, index)];
+  }
+
+  template<typename D>
+  constexpr Reference At(const std::array<size_t, D::rank>& index) const
+  {
+    return (*this)[BroadcastOffset<DimensionType, D>(index)];
+  }
+
+  // Elements [i, i + Packet::width) at once, only for contiguous views
+  template<typename Packet>
+  Packet PacketAt(size_t i) const
+  {
+    return Packet::Load(first + i);
+  }
+
+  // First element, the others follow at the strides
+  constexpr Pointer Data() const { return first; }
+
+  constexpr TensorType Eval() const { return TensorType{*this}; }
+
+private:
+  static constexpr size_t Offset(size_t i)
+  {
+    if constexpr (isContiguous) {
+      return i;
+    } else {
+      return InnerProduct(strides, DimensionType::MultiIndex(i));
+    }
+  }
+
+  template<typename T>
+  constexpr void Assign(const T& t)
+  {
+    static_assert(!isConst, "Cannot assign to a view of a const tensor.");
+    using D = typename T::DimensionType;
+    if constexpr (D::count == count && T::isFlat) {
+      for (size_t i = 0; i < count; ++i) {
+        first[Offset(i)] = static_cast<ScalarType>(t[i]);
+      }
+    } else {
+      static_assert(
+        CanBroadcast<D, DimensionType>::value,
+        "Must assign a tensor that broadcasts to the dimension of the view."
+      );
+      ForEachMultiIndex<DimensionType>([&](size_t, const auto& index) {
+        first[InnerProduct(strides, index)] =
+          static_cast<ScalarType>(BroadcastAt<DimensionType>(t, index));
+      });
+    }
+  }
+
+  Pointer first;
+};
+
+template<typename ParentTensor, typename ViewDimension, size_t removedAxis>
+struct IsTensorViewClass<TensorView<ParentTensor, ViewDimension, removedAxis>> {
+  static constexpr bool value = true;
+};
+
+template<typename T>
+struct IsStridedViewClass {
+  static constexpr bool value = false;
+};
+
+template<typename ParentTensor, typename ViewDimension, size_t removedAxis>
+struct IsStridedViewClass<TensorView<ParentTensor, ViewDimension, removedAxis>> {
+  static constexpr bool value = true;
+};
+
+template<typename T>
+static constexpr bool IsStridedViewClassV = IsStridedViewClass<T>::value;
+
+// Contiguous views are loaded a packet at a time like the tensor they view
+template<typename ParentTensor, typename ViewDimension, size_t removedAxis, typename Scalar>
+struct IsVectorizable<TensorView<ParentTensor, ViewDimension, removedAxis>, Scalar> {
+  using ViewType = TensorView<ParentTensor, ViewDimension, removedAxis>;
+  static constexpr bool value =
+    ViewType::isContiguous && std::is_same_v<typename ViewType::ScalarType, Scalar>;
+};
+
+// View of the elements whose index along axis is k, the tensor without that axis
+template<size_t axis, typename T>
+constexpr auto Slice(T& t, size_t k)
+{
+  using ParentType = std::remove_const_t<T>;
+  using D = typename ParentType::DimensionType;
+  static_assert(IsTensorClassV<ParentType>, "Slice views Tensor types.");
+  static_assert(axis < D::rank && D::rank >= 2, "Slice requires an axis of a tensor of rank 2+.");
+
+  using ViewDimension = typename SubDim<D, axis, 1>::Complement;
+  return TensorView<T, ViewDimension, axis>{&t[0] + k * D::TailProducts()[axis]};
+}
+
+template<typename T>
+constexpr auto Row(T& m, size_t i)
+{
+  static_assert(std::remove_const_t<T>::rank == 2, "Row requires a matrix.");
+  return Slice<0>(m, i);
+}
+
+template<typename T>
+constexpr auto Col(T& m, size_t j)
+{
+  static_assert(std::remove_const_t<T>::rank == 2, "Col requires a matrix.");
+  return Slice<1>(m, j);
+}
+
+template<typename Block, typename D>
+struct BlockFits {
+private:
+  static constexpr bool Compute()
+  {
+    for (size_t i = 0; i < D::rank; ++i) {
+      if (Block::extents[i] > D::extents[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+public:
+  static constexpr bool value = Compute();
+};
+
+template<typename Block, typename D>
+static constexpr bool BlockFitsV = BlockFits<Block, D>::value;
+
+// View of the extents... block of t starting at offsets..., which must lie within t
+template<size_t... extents, typename T, typename... Offsets>
+constexpr auto SubTensor(T& t, const Offsets... offsets)
+{
+  using ParentType = std::remove_const_t<T>;
+  using D = typename ParentType::DimensionType;
+  static_assert(IsTensorClassV<ParentType>, "SubTensor views Tensor types.");
+  static_assert(
+    sizeof...(extents) == D::rank && sizeof...(Offsets) == D::rank,
+    "SubTensor takes an extent and an offset per axis of the tensor."
+  );
+  static_assert(BlockFitsV<TDimension<extents...>, D>, "SubTensor blocks must fit the tensor.");
+
+  return TensorView<T, TDimension<extents...>, D::rank>{&t[0] + D::FlattenedIndex(offsets...)};
+}
\ No newline at end of file
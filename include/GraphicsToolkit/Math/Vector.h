@@ -1,7 +1,12 @@
 #pragma once
 
-#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
 
+#include "Execution.h"
+#include "Simd.h"
 #include "Tensor.h"
 
 
@@ -9,18 +14,305 @@ template<typename Scalar, size_t len>
 using Vector = Tensor<Scalar, len>;
 
 
-template<typename Scalar, size_t len>
-constexpr auto Dot(const Vector<Scalar, len>& lhs, const Vector<Scalar, len>& rhs)
+// Single pass over both vectors, no intermediate product tensor
+template<typename Scalar, typename S1, typename S2, size_t len>
+constexpr Scalar
+Dot(const BasicTensor<Scalar, S1, len>& lhs, const BasicTensor<Scalar, S2, len>& rhs)
 {
-  Vector<Scalar, len> prod = lhs * rhs;
-  return std::accumulate(prod.begin(), prod.end(), Scalar{});
+  Scalar sum{};
+  for (size_t i = 0; i < len; ++i) {
+    sum += lhs[i] * rhs[i];
+  }
+  return sum;
 }
 
-template<typename Scalar>
-constexpr auto Cross(const Vector<Scalar, 3>& lhs, const Vector<Scalar, 3>& rhs)
+template<typename Scalar, typename S1, typename S2>
+constexpr auto Cross(const BasicTensor<Scalar, S1, 3>& lhs, const BasicTensor<Scalar, S2, 3>& rhs)
 {
   return Vector<Scalar, 3>{
     lhs[1] * rhs[2] - lhs[2] * rhs[1], lhs[2] * rhs[0] - lhs[0] * rhs[2],
     lhs[0] * rhs[1] - lhs[1] * rhs[0]
   };
+}
+
+template<typename Scalar, typename Storage, size_t len>
+Scalar Length(const BasicTensor<Scalar, Storage, len>& v)
+{
+  static_assert(std::is_floating_point_v<Scalar>, "Length requires floating point vectors.");
+  return std::sqrt(Dot(v, v));
+}
+
+// Zero vectors have no direction, their components become NaN
+template<typename Scalar, typename Storage, size_t len>
+BasicTensor<Scalar, Storage, len> Normalize(const BasicTensor<Scalar, Storage, len>& v)
+{
+  Scalar length = Length(v);
+  BasicTensor<Scalar, Storage, len> normalized = v;
+  for (size_t i = 0; i < len; ++i) {
+    normalized[i] = v[i] / length;
+  }
+  return normalized;
+}
+
+
+// Batch operations over contiguous arrays of vectors
+//
+// Blocks of vectors are transposed into per component lanes so the arithmetic runs across vectors
+// with packets rather than within one vector, the remaining vectors go through the functions
+// above. Outputs may alias inputs.
+
+template<typename VectorType>
+static constexpr bool IsBatchVectorV = IsTensorClassV<VectorType> && VectorType::rank == 1;
+
+// Scratch lanes for a block of vectors, lane c holds component c of each vector
+template<typename VectorType>
+struct VectorBlock {
+  using Scalar = typename VectorType::ScalarType;
+
+  // A whole number of packets at every SIMD width, and a scratch buffer of count * 64 scalars
+  // that stays small on the stack
+  static constexpr size_t size = 64;
+
+  void Load(const VectorType* v, size_t n)
+  {
+    for (size_t k = 0; k < n; ++k) {
+      for (size_t c = 0; c < VectorType::count; ++c) {
+        lanes[c][k] = v[k][c];
+      }
+    }
+  }
+
+  void Store(VectorType* v, size_t n) const
+  {
+    for (size_t k = 0; k < n; ++k) {
+      for (size_t c = 0; c < VectorType::count; ++c) {
+        v[k][c] = lanes[c][k];
+      }
+    }
+  }
+
+  template<typename Packet>
+  Packet PacketAt(size_t c, size_t k) const
+  {
+    return Packet::Load(&lanes[c][k]);
+  }
+
+  template<typename Packet>
+  void StorePacket(size_t c, size_t k, const Packet& p)
+  {
+    p.Store(&lanes[c][k]);
+  }
+
+  alignas(64) Scalar lanes[VectorType::count][size];
+};
+
+// Number of vectors from the next block that fill whole packets, 0 once only a tail is left
+template<typename Packet, typename VectorType>
+size_t NextVectorBlock(size_t i, size_t count)
+{
+  return std::min(VectorBlock<VectorType>::size, (count - i) / Packet::width * Packet::width);
+}
+
+template<typename VectorType>
+void DotBatch(
+  const VectorType* lhs,
+  const VectorType* rhs,
+  size_t count,
+  typename VectorType::ScalarType* out
+)
+{
+  static_assert(IsBatchVectorV<VectorType>, "Batch operations take arrays of vectors.");
+  using Scalar = typename VectorType::ScalarType;
+  constexpr size_t len = VectorType::count;
+
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    VectorBlock<VectorType> a;
+    VectorBlock<VectorType> b;
+    for (size_t n; (n = NextVectorBlock<Packet, VectorType>(i, count)) > 0; i += n) {
+      a.Load(lhs + i, n);
+      b.Load(rhs + i, n);
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet sum = a.template PacketAt<Packet>(0, k) * b.template PacketAt<Packet>(0, k);
+        for (size_t c = 1; c < len; ++c) {
+          sum = sum + a.template PacketAt<Packet>(c, k) * b.template PacketAt<Packet>(c, k);
+        }
+        sum.Store(out + i + k);
+      }
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = Dot(lhs[i], rhs[i]);
+  }
+}
+
+template<typename VectorType>
+void CrossBatch(const VectorType* lhs, const VectorType* rhs, size_t count, VectorType* out)
+{
+  static_assert(
+    IsBatchVectorV<VectorType> && VectorType::count == 3, "CrossBatch takes arrays of 3 vectors."
+  );
+  using Scalar = typename VectorType::ScalarType;
+
+  size_t i = 0;
+  if constexpr (gtk::simd::HasNativePacketV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    VectorBlock<VectorType> a;
+    VectorBlock<VectorType> b;
+    VectorBlock<VectorType> result;
+    for (size_t n; (n = NextVectorBlock<Packet, VectorType>(i, count)) > 0; i += n) {
+      a.Load(lhs + i, n);
+      b.Load(rhs + i, n);
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet a0 = a.template PacketAt<Packet>(0, k);
+        Packet a1 = a.template PacketAt<Packet>(1, k);
+        Packet a2 = a.template PacketAt<Packet>(2, k);
+        Packet b0 = b.template PacketAt<Packet>(0, k);
+        Packet b1 = b.template PacketAt<Packet>(1, k);
+        Packet b2 = b.template PacketAt<Packet>(2, k);
+        result.StorePacket(0, k, a1 * b2 - a2 * b1);
+        result.StorePacket(1, k, a2 * b0 - a0 * b2);
+        result.StorePacket(2, k, a0 * b1 - a1 * b0);
+      }
+      result.Store(out + i, n);
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = Cross(lhs[i], rhs[i]);
+  }
+}
+
+template<typename VectorType>
+void LengthBatch(const VectorType* v, size_t count, typename VectorType::ScalarType* out)
+{
+  static_assert(IsBatchVectorV<VectorType>, "Batch operations take arrays of vectors.");
+  using Scalar = typename VectorType::ScalarType;
+  constexpr size_t len = VectorType::count;
+
+  size_t i = 0;
+  if constexpr (gtk::simd::HasPacketSqrtV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    VectorBlock<VectorType> a;
+    for (size_t n; (n = NextVectorBlock<Packet, VectorType>(i, count)) > 0; i += n) {
+      a.Load(v + i, n);
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet sum = a.template PacketAt<Packet>(0, k) * a.template PacketAt<Packet>(0, k);
+        for (size_t c = 1; c < len; ++c) {
+          sum = sum + a.template PacketAt<Packet>(c, k) * a.template PacketAt<Packet>(c, k);
+        }
+        Sqrt(sum).Store(out + i + k);
+      }
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = Length(v[i]);
+  }
+}
+
+template<typename VectorType>
+void NormalizeBatch(const VectorType* v, size_t count, VectorType* out)
+{
+  static_assert(IsBatchVectorV<VectorType>, "Batch operations take arrays of vectors.");
+  using Scalar = typename VectorType::ScalarType;
+  constexpr size_t len = VectorType::count;
+
+  size_t i = 0;
+  if constexpr (gtk::simd::HasPacketSqrtV<Scalar>) {
+    using Packet = gtk::simd::NativePacketT<Scalar>;
+    VectorBlock<VectorType> a;
+    for (size_t n; (n = NextVectorBlock<Packet, VectorType>(i, count)) > 0; i += n) {
+      a.Load(v + i, n);
+      for (size_t k = 0; k < n; k += Packet::width) {
+        Packet sum = a.template PacketAt<Packet>(0, k) * a.template PacketAt<Packet>(0, k);
+        for (size_t c = 1; c < len; ++c) {
+          sum = sum + a.template PacketAt<Packet>(c, k) * a.template PacketAt<Packet>(c, k);
+        }
+        Packet length = Sqrt(sum);
+        for (size_t c = 0; c < len; ++c) {
+          a.StorePacket(c, k, a.template PacketAt<Packet>(c, k) / length);
+        }
+      }
+      a.Store(out + i, n);
+    }
+  }
+  for (; i < count; ++i) {
+    out[i] = Normalize(v[i]);
+  }
+}
+
+// Batches under an execution policy, split in chunks of whole VectorBlocks so every vector takes
+// the same packet or scalar path as in the batch without a policy, and gets the same result. A
+// vector costs about its count multiply adds.
+
+template<typename VectorType, typename Policy, typename F>
+void ForEachVectorChunk(const Policy& policy, size_t count, const F& f)
+{
+  constexpr size_t block = VectorBlock<VectorType>::size;
+  size_t blocks = (count + block - 1) / block;
+  size_t cost = block * VectorType::count;
+  gtk::exec::ForEachChunk(policy, blocks, cost, [&](size_t first, size_t last) {
+    f(first * block, std::min(last * block, count));
+  });
+}
+
+template<
+  typename Policy,
+  typename VectorType,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void DotBatch(
+  const Policy& policy,
+  const VectorType* lhs,
+  const VectorType* rhs,
+  size_t count,
+  typename VectorType::ScalarType* out
+)
+{
+  ForEachVectorChunk<VectorType>(policy, count, [&](size_t first, size_t last) {
+    DotBatch(lhs + first, rhs + first, last - first, out + first);
+  });
+}
+
+template<
+  typename Policy,
+  typename VectorType,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void CrossBatch(
+  const Policy& policy,
+  const VectorType* lhs,
+  const VectorType* rhs,
+  size_t count,
+  VectorType* out
+)
+{
+  ForEachVectorChunk<VectorType>(policy, count, [&](size_t first, size_t last) {
+    CrossBatch(lhs + first, rhs + first, last - first, out + first);
+  });
+}
+
+template<
+  typename Policy,
+  typename VectorType,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void LengthBatch(
+  const Policy& policy,
+  const VectorType* v,
+  size_t count,
+  typename VectorType::ScalarType* out
+)
+{
+  ForEachVectorChunk<VectorType>(policy, count, [&](size_t first, size_t last) {
+    LengthBatch(v + first, last - first, out + first);
+  });
+}
+
+template<
+  typename Policy,
+  typename VectorType,
+  typename = std::enable_if_t<gtk::exec::IsExecutionPolicyV<Policy>>>
+void NormalizeBatch(const Policy& policy, const VectorType* v, size_t count, VectorType* out)
+{
+  ForEachVectorChunk<VectorType>(policy, count, [&](size_t first, size_t last) {
+    NormalizeBatch(v + first, last - first, out + first);
+  });
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include "Math/GtkMath.h"
 
+#include "Math/Random.h"
 #include "Math/Sample.h"
 #include "Math/Discrepancy.h"
 
@@ -1,5 +1,18 @@
 #include "Discrepancy.h"
 
+#include "Parallel.h"
+#include "ThreadPool.h"
+
+namespace
+{
+
+// Points per block, a block of the sequence costs a few microseconds
+constexpr size_t s_corputGrain = 4096;
+
+}  // namespace
+
+using namespace gtk;
+
 double Corput(size_t i, unsigned int base) {
   double res = 0.0;
   double b = 1.0 / base;
@@ -12,23 +25,30 @@ double Corput(size_t i, unsigned int base) {
 }
 
 std::vector<double> CorputSequence(size_t count, unsigned int base) {
-  std::vector<double> seq;
-  seq.reserve(count);
-  for (int i = 0; i < count; ++i) {
-    seq.push_back(Corput(i + 1, base));
-  }
+  std::vector<double> seq(count);
+  ParallelFor(0, count, s_corputGrain, [&](size_t first, size_t last) {
+    for (size_t i = first; i < last; ++i) {
+      seq[i] = Corput(i + 1, base);
+    }
+  });
   return seq;
 }
 
 PointSet2D Halton2DSequence(size_t count) {
-  auto x = CorputSequence(count, 2);
-  auto y = CorputSequence(count, 3);
-  return {x, y};
+  std::vector<double> x, y;
+  TaskGroup group;
+  group.Run([&]() { x = CorputSequence(count, 2); });
+  y = CorputSequence(count, 3);
+  group.Wait();
+  return {std::move(x), std::move(y)};
 }
 
 PointSet3D Halton3DSequence(size_t count) {
-  auto x = CorputSequence(count, 2);
-  auto y = CorputSequence(count, 3);
-  auto z = CorputSequence(count, 5);
-  return {x, y, z};
+  std::vector<double> x, y, z;
+  TaskGroup group;
+  group.Run([&]() { x = CorputSequence(count, 2); });
+  group.Run([&]() { y = CorputSequence(count, 3); });
+  z = CorputSequence(count, 5);
+  group.Wait();
+  return {std::move(x), std::move(y), std::move(z)};
 }
@@ -0,0 +1,92 @@
+#include "DiscreteDistribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/core.h>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+
+void CheckWeight(size_t i, double weight)
+{
+  if (!std::isfinite(weight) || weight < 0) {
+    throw std::invalid_argument{fmt::format(
+      "Invalid weight {} of index {}: weights must be finite and non negative", weight, i
+    )};
+  }
+}
+
+}  // namespace
+
+DiscreteDistribution::DiscreteDistribution(std::vector<double> weights)
+    : weights{std::move(weights)}
+{
+  size_t n = Size();
+  if (n > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument{fmt::format("Invalid weight count {}: at most 2^32 indices", n)};
+  }
+  for (size_t i = 0; i < n; ++i) {
+    CheckWeight(i, Weight(i));
+  }
+  columns.resize(n);
+  scaled.resize(n);
+  work.resize(n);
+  Rebuild();
+}
+
+void DiscreteDistribution::SetWeight(size_t i, double weight)
+{
+  CheckWeight(i, weight);
+  weights[i] = weight;
+  stale = true;
+}
+
+void DiscreteDistribution::Rebuild()
+{
+  size_t n = weights.size();
+  double sum = 0;
+  for (double weight : weights) {
+    sum += weight;
+  }
+  if (!(sum > 0) || !std::isfinite(sum)) {
+    throw std::invalid_argument{
+      fmt::format("Invalid weight sum {}: weights must have a finite positive sum", sum)
+    };
+  }
+  total = sum;
+  stale = false;
+
+  // Columns under 1 are small and get topped up by large ones, the small worklist grows from the
+  // front of work and the large one from the back
+  size_t small = 0;
+  size_t large = n;
+  for (size_t i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * (static_cast<double>(n) / total);
+    if (scaled[i] < 1) {
+      work[small++] = static_cast<uint32_t>(i);
+    } else {
+      work[--large] = static_cast<uint32_t>(i);
+    }
+  }
+  while (small > 0 && large < n) {
+    uint32_t s = work[--small];
+    uint32_t l = work[large++];
+    columns[s] = {static_cast<uint32_t>(std::max(scaled[s], 0.) * 0x1.0p32), l};
+    scaled[l] = (scaled[l] + scaled[s]) - 1;
+    if (scaled[l] < 1) {
+      work[small++] = l;
+    } else {
+      work[--large] = l;
+    }
+  }
+  // What is left is 1 up to rounding
+  for (size_t k = large; k < n; ++k) {
+    columns[work[k]] = {std::numeric_limits<uint32_t>::max(), work[k]};
+  }
+  for (size_t k = 0; k < small; ++k) {
+    columns[work[k]] = {std::numeric_limits<uint32_t>::max(), work[k]};
+  }
+}
\ No newline at end of file
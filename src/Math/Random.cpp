@@ -0,0 +1,36 @@
+#include "Random.h"
+
+#include <atomic>
+
+
+namespace
+{
+
+std::atomic<uint64_t> s_seed{0};
+
+// Bumped by every SeedThreadRngs, threads compare it with the one their stream was seeded at
+std::atomic<uint64_t> s_generation{0};
+
+std::atomic<uint64_t> s_threadCount{0};
+
+}  // namespace
+
+Rng& ThreadRng()
+{
+  thread_local uint64_t index = s_threadCount.fetch_add(1, std::memory_order_relaxed);
+  thread_local uint64_t generation = 0;
+  thread_local Rng rng{0, index};
+
+  uint64_t current = s_generation.load(std::memory_order_acquire);
+  if (current != generation) {
+    generation = current;
+    rng = Rng{s_seed.load(std::memory_order_relaxed), index};
+  }
+  return rng;
+}
+
+void SeedThreadRngs(uint64_t seed)
+{
+  s_seed.store(seed, std::memory_order_relaxed);
+  s_generation.fetch_add(1, std::memory_order_release);
+}
@@ -1,23 +1,9 @@
 #include "Sample.h"
 
-#include <chrono>
 #include <fmt/core.h>
-#include <random>
 
 #include "GtkMath.h"
 
-
-namespace
-{
-
-auto s_gen = std::mt19937{static_cast<std::mt19937::result_type>(
-  std::chrono::high_resolution_clock::now().time_since_epoch().count()
-)};
-
-std::uniform_real_distribution<double> s_dist(0., 1.);
-
-}  // namespace
-
 using namespace gtk;
 
 ProbabilityDensityFunction1D::ProbabilityDensityFunction1D(
@@ -43,40 +29,28 @@ ProbabilityDensityFunction1D::ProbabilityDensityFunction1D(
 
 double SampleUniform1D(double lo, double hi)
 {
-  double x = s_dist(s_gen);
-  return Remap(x, 0., 1., lo, hi);
+  return SampleUniform1D(ThreadRng(), lo, hi);
 }
 
 std::tuple<double, double> SampleUniform2D(double lo, double hi)
 {
-  double x = SampleUniform1D(lo, hi);
-  double y = SampleUniform1D(lo, hi);
-  return {x, y};
+  return SampleUniform2D(ThreadRng(), lo, hi);
 }
 
 std::tuple<double, double, double> SampleUniform3D(double lo, double hi)
 {
-  double x = SampleUniform1D(lo, hi);
-  double y = SampleUniform1D(lo, hi);
-  double z = SampleUniform1D(lo, hi);
-  return {x, y, z};
+  return SampleUniform3D(ThreadRng(), lo, hi);
 }
 
 double Sample1D(const ProbabilityDensityFunction1D& pdf)
 {
-  return RejectionSample1D(pdf.domainMin, pdf.domainMax, std::ref(pdf), pdf.UpperBound());
+  return Sample1D(ThreadRng(), pdf);
 }
 
 double
 RejectionSample1D(double lo, double hi, const std::function<double(double)>& pdf, double upperBound)
 {
-  while (true) {
-    double x = SampleUniform1D(lo, hi);
-    double u = SampleUniform1D();
-    if (u * upperBound < pdf(x)) {
-      return x;
-    }
-  }
+  return RejectionSample1D(ThreadRng(), lo, hi, pdf, upperBound);
 }
 
 double NormalDistribution::operator()(double x) const
@@ -0,0 +1,75 @@
+#include "TabulatedSampler1D.h"
+
+#include <cmath>
+#include <fmt/core.h>
+#include <stdexcept>
+
+namespace
+{
+
+double CheckedPdf(const ProbabilityDensityFunction1D& pdf, double x)
+{
+  double value = pdf(x);
+  if (!std::isfinite(value) || value < 0) {
+    throw std::invalid_argument{fmt::format(
+      "Invalid PDF value {} at {}: a density must be finite and non negative", value, x
+    )};
+  }
+  return value;
+}
+
+}  // namespace
+
+TabulatedSampler1D::TabulatedSampler1D(const ProbabilityDensityFunction1D& pdf, size_t resolution)
+    : domainMin{pdf.domainMin},
+      domainMax{pdf.domainMax},
+      binWidth{(pdf.domainMax - pdf.domainMin) / static_cast<double>(resolution)},
+      cdf(resolution + 1),
+      guide(resolution)
+{
+  if (resolution == 0) {
+    throw std::invalid_argument{"Invalid resolution 0: a table needs a bin at least"};
+  }
+
+  // Simpson's rule on every bin, the pdf at the edge shared by two bins is evaluated once
+  size_t n = resolution;
+  double left = CheckedPdf(pdf, domainMin);
+  cdf[0] = 0;
+  for (size_t j = 0; j < n; ++j) {
+    double x = domainMin + static_cast<double>(j) * binWidth;
+    double middle = CheckedPdf(pdf, x + binWidth / 2);
+    double right = CheckedPdf(pdf, j + 1 == n ? domainMax : x + binWidth);
+    cdf[j + 1] = cdf[j] + (left + 4 * middle + right) * (binWidth / 6);
+    left = right;
+  }
+  double total = cdf[n];
+  if (!(total > 0) || !std::isfinite(total)) {
+    throw std::invalid_argument{
+      fmt::format("Invalid PDF mass {} over [{}, {}]", total, domainMin, domainMax)
+    };
+  }
+  for (double& c : cdf) {
+    c /= total;
+  }
+  // Exactly 1, so the search of Quantile stops at the last bin for any u below 1
+  cdf[n] = 1;
+
+  size_t j = 0;
+  for (size_t k = 0; k < n; ++k) {
+    double u = static_cast<double>(k) / static_cast<double>(n);
+    while (cdf[j + 1] <= u) {
+      ++j;
+    }
+    guide[k] = j;
+  }
+}
+
+double TabulatedSampler1D::Pdf(double x) const
+{
+  if (!(x >= domainMin && x <= domainMax)) {
+    return 0;
+  }
+  size_t n = guide.size();
+  size_t j = std::min(static_cast<size_t>((x - domainMin) / binWidth), n - 1);
+  return (cdf[j + 1] - cdf[j]) / binWidth;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+#include "Parallel.h"
+#include "ThreadPool.h"
+
+// Helper function to test a pool of the given number of workers
+static void ParallelLoops(size_t workerCount)
+{
+  using namespace gtk;
+  ThreadPool pool{workerCount};
+
+  // Blocks are grain aligned and cover the range once
+  std::vector<std::atomic<int>> calls(10007);
+  std::atomic<size_t> blocks{0};
+  ParallelFor(
+    7,
+    calls.size(),
+    100,
+    [&](size_t first, size_t last) {
+      EXPECT_EQ((first - 7) % 100, 0u);
+      EXPECT_LE(last - first, 100u);
+      blocks.fetch_add(1);
+      for (size_t i = first; i < last; ++i) {
+        calls[i].fetch_add(1);
+      }
+    },
+    pool
+  );
+  for (size_t i = 0; i < calls.size(); ++i) {
+    EXPECT_EQ(calls[i].load(), i < 7 ? 0 : 1);
+  }
+  EXPECT_EQ(blocks.load(), 100u);
+
+  // The float sum only depends on the grain, not on the number of threads
+  std::vector<float> v(1 << 20);
+  for (size_t i = 0; i < v.size(); ++i) {
+    v[i] = 1.0f / static_cast<float>(i % 1000 + 1);
+  }
+  auto sum = [&](size_t first, size_t last) {
+    float s = 0.0f;
+    for (size_t i = first; i < last; ++i) {
+      s += v[i];
+    }
+    return s;
+  };
+  auto plus = [](float a, float b) { return a + b; };
+  float serial = 0.0f;
+  {
+    std::vector<float> partials;
+    for (size_t first = 0; first < v.size(); first += 4096) {
+      partials.push_back(sum(first, first + 4096));
+    }
+    for (size_t step = 1; step < partials.size(); step *= 2) {
+      for (size_t i = 0; i + step < partials.size(); i += 2 * step) {
+        partials[i] += partials[i + step];
+      }
+    }
+    serial = partials[0];
+  }
+  EXPECT_EQ(ParallelReduce(0, v.size(), 4096, 0.0f, sum, plus, pool), serial);
+  EXPECT_EQ(ParallelReduce(5, 5, 4096, -1.0f, sum, plus, pool), -1.0f);
+}
+
+TEST(Core, Parallel)
+{
+  ParallelLoops(0);
+  ParallelLoops(1);
+  ParallelLoops(3);
+}
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Execution.h"
+#include "ThreadPool.h"
+
+TEST(Core, ThreadPool)
+{
+  using namespace gtk;
+
+  // Every task runs exactly once, on the workers or the calling thread
+  {
+    ThreadPool pool{3};
+    EXPECT_EQ(pool.Concurrency(), 4u);
+    std::vector<std::atomic<int>> calls(1000);
+    pool.Run(calls.size(), [&](size_t i) { calls[i].fetch_add(1); });
+    for (const auto& c : calls) {
+      EXPECT_EQ(c.load(), 1);
+    }
+  }
+
+  // Tasks run further batches without waiting on an idle pool
+  {
+    ThreadPool pool{2};
+    std::atomic<size_t> sum{0};
+    pool.Run(8, [&](size_t i) {
+      pool.Run(8, [&](size_t j) { sum.fetch_add(i * 8 + j); });
+    });
+    EXPECT_EQ(sum.load(), 64u * 63u / 2u);
+  }
+
+  // Exceptions reach the caller once the batch is done
+  {
+    ThreadPool pool{2};
+    std::atomic<int> finished{0};
+    EXPECT_THROW(
+      pool.Run(
+        16,
+        [&](size_t i) {
+          if (i == 5) {
+            throw std::runtime_error{"task failed"};
+          }
+          finished.fetch_add(1);
+        }
+      ),
+      std::runtime_error
+    );
+    EXPECT_EQ(finished.load(), 15);
+  }
+
+  // Without workers the caller runs everything
+  {
+    ThreadPool pool{0};
+    int sum = 0;
+    pool.Run(4, [&](size_t i) { sum += static_cast<int>(i); });
+    EXPECT_EQ(sum, 6);
+  }
+
+  // Continuations run after the tasks of their group, Wait waits for both
+  {
+    ThreadPool pool{2};
+    TaskGroup group{pool};
+    std::atomic<int> tasks{0};
+    std::atomic<int> seen{-1};
+    for (int i = 0; i < 50; ++i) {
+      group.Run([&]() {
+        // Tasks add tasks to their own group, from worker deques
+        group.Run([&]() { tasks.fetch_add(1); });
+        tasks.fetch_add(1);
+      });
+    }
+    group.Then([&]() { seen = tasks.load(); });
+    group.Wait();
+    EXPECT_EQ(seen.load(), 100);
+
+    // Continuations registered while a task runs follow it in order
+    std::atomic<bool> go{false};
+    std::vector<int> order;
+    group.Run([&]() {
+      while (!go.load()) {
+        std::this_thread::yield();
+      }
+      order.push_back(0);
+    });
+    group.Then([&]() { order.push_back(1); });
+    group.Then([&]() { order.push_back(2); });
+    go = true;
+    group.Wait();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+
+    // Without running tasks a continuation is queued right away
+    group.Then([&]() { order.clear(); });
+    group.Wait();
+    EXPECT_TRUE(order.empty());
+
+    // Groups nest, Wait rethrows the first exception once and clears it
+    group.Run([&]() {
+      TaskGroup inner{pool};
+      inner.Run([]() { throw std::logic_error{"inner"}; });
+      inner.Wait();
+    });
+    EXPECT_THROW(group.Wait(), std::logic_error);
+    group.Wait();
+  }
+
+  // Chunks cover the range once, small ranges and seq are a single chunk
+  {
+    std::vector<std::atomic<int>> calls(10000);
+    std::atomic<int> chunks{0};
+    auto count = [&](size_t first, size_t last) {
+      chunks.fetch_add(1);
+      for (size_t i = first; i < last; ++i) {
+        calls[i].fetch_add(1);
+      }
+    };
+    exec::ForEachChunk(exec::ParallelPolicy{100}, calls.size(), 1, count);
+    for (const auto& c : calls) {
+      EXPECT_EQ(c.load(), 1);
+    }
+    EXPECT_GE(chunks.load(), ThreadPool::Default().Concurrency() > 1 ? 2 : 1);
+
+    chunks = 0;
+    exec::ForEachChunk(exec::par, 100, 1, count);
+    exec::ForEachChunk(exec::seq, calls.size(), 1000, count);
+    EXPECT_EQ(chunks.load(), 2);
+    static_assert(exec::IsExecutionPolicyV<decltype(exec::par_unseq)>);
+    static_assert(!exec::IsExecutionPolicyV<int>);
+  }
+}
\ No newline at end of file
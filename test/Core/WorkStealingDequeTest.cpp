@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "WorkStealingDeque.h"
+
+TEST(Core, WorkStealingDeque)
+{
+  using namespace gtk;
+
+  // The owner takes the newest value, thieves the oldest, the ring grows past its capacity
+  {
+    WorkStealingDeque<int> deque{4};
+    EXPECT_EQ(deque.Capacity(), 4u);
+    for (int i = 0; i < 10; ++i) {
+      deque.Push(i);
+    }
+    EXPECT_EQ(deque.Size(), 10u);
+    EXPECT_GE(deque.Capacity(), 10u);
+    int value = -1;
+    EXPECT_TRUE(deque.Pop(value));
+    EXPECT_EQ(value, 9);
+    EXPECT_TRUE(deque.Steal(value));
+    EXPECT_EQ(value, 0);
+    while (deque.Pop(value)) {
+    }
+    EXPECT_EQ(value, 1);
+    EXPECT_TRUE(deque.Empty());
+    EXPECT_FALSE(deque.Steal(value));
+  }
+
+  // Every value is taken exactly once by the owner or one of the thieves
+  {
+    constexpr int count = 100000;
+    WorkStealingDeque<int> deque{16};
+    std::vector<std::atomic<int>> taken(count);
+    std::atomic<bool> pushing{true};
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < 3; ++t) {
+      thieves.emplace_back([&]() {
+        int value;
+        while (pushing.load() || !deque.Empty()) {
+          if (deque.Steal(value)) {
+            taken[value].fetch_add(1);
+          }
+        }
+      });
+    }
+    int value;
+    for (int i = 0; i < count; ++i) {
+      deque.Push(i);
+      if (i % 3 == 0 && deque.Pop(value)) {
+        taken[value].fetch_add(1);
+      }
+    }
+    while (deque.Pop(value)) {
+      taken[value].fetch_add(1);
+    }
+    pushing = false;
+    for (std::thread& thief : thieves) {
+      thief.join();
+    }
+    for (const auto& t : taken) {
+      EXPECT_EQ(t.load(), 1);
+    }
+  }
+}
\ No newline at end of file
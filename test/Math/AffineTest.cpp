@@ -0,0 +1,136 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "Affine.h"
+#include "Matrix.h"
+#include "TensorSoA.h"
+#include "Vector.h"
+
+
+template<typename Scalar>
+static void ExpectAffineNear(const Affine3<Scalar>& a, const Affine3<Scalar>& b, Scalar epsilon)
+{
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 4; ++j) {
+      EXPECT_NEAR(a(i, j), b(i, j), epsilon);
+    }
+  }
+}
+
+// Rotation about z by angle followed by a translation
+template<typename Scalar>
+static Affine3<Scalar> RigidTransform(Scalar angle, const Vector<Scalar, 3>& t)
+{
+  Scalar c = std::cos(angle);
+  Scalar s = std::sin(angle);
+  return Affine3<Scalar>(Matrix<Scalar, 3, 3>{c, -s, 0, s, c, 0, 0, 0, 1}, t);
+}
+
+// Helper function to test construction, composition and inverses
+static void AffineBasics()
+{
+  // Points are translated, directions are not
+  {
+    constexpr auto a = Affine3<float>::Translation(Vector<float, 3>(1.0f, 2.0f, 3.0f));
+    constexpr Vector<float, 3> ones(1.0f, 1.0f, 1.0f);
+    static_assert(TransformPoint(a, ones) == Vector<float, 3>(2.0f, 3.0f, 4.0f));
+    static_assert(TransformDirection(a, ones) == ones);
+    static_assert(a.Translation() == Vector<float, 3>(1, 2, 3));
+  }
+
+  // Composition matches the product of the 4x4 matrices
+  {
+    Affine3<double> a = RigidTransform(0.3, Vector<double, 3>(1.0, -2.0, 0.5));
+    Affine3<double> b = Affine3<double>::Scaling(Vector<double, 3>(2.0, 3.0, 4.0));
+    Affine3<double> ab = a * b;
+    Matrix<double, 4, 4> m = Mul(a.ToMatrix4(), b.ToMatrix4());
+    ExpectAffineNear(ab, Affine3<double>(m), 1e-12);
+    EXPECT_EQ(m(3, 3), 1.0);
+    EXPECT_EQ(m(3, 0), 0.0);
+
+    Vector<double, 3> p(0.25, -1.0, 2.0);
+    Vector<double, 3> q = TransformPoint(ab, p);
+    Vector<double, 3> r = TransformPoint(a, TransformPoint(b, p));
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_NEAR(q[i], r[i], 1e-12);
+    }
+  }
+
+  // General and rigid inverses
+  {
+    Affine3<double> rigid = RigidTransform(1.1, Vector<double, 3>(4.0, 5.0, -6.0));
+    ExpectAffineNear(rigid * RigidInverse(rigid), Affine3<double>(), 1e-12);
+    ExpectAffineNear(RigidInverse(rigid), Inverse(rigid), 1e-12);
+
+    Affine3<double> a(Matrix<double, 3, 4>{2, 1, 0, 1, 0, 3, 1, -2, 1, 0, 4, 3});
+    ExpectAffineNear(a * Inverse(a), Affine3<double>(), 1e-12);
+    ExpectAffineNear(Inverse(a) * a, Affine3<double>(), 1e-12);
+
+    // Normals stay perpendicular to transformed tangents
+    Vector<double, 3> tangent(1.0, 2.0, 0.0);
+    Vector<double, 3> normal(2.0, -1.0, 3.0);
+    Matrix<double, 3, 3> n = NormalMatrix(a);
+    Vector<double, 3> transformedNormal = Mul(n, Matrix<double, 3, 1>(normal));
+    EXPECT_NEAR(Dot(transformedNormal, TransformDirection(a, tangent)), 0.0, 1e-12);
+
+    Affine3<float> singular = Affine3<float>::Scaling(Vector<float, 3>(1.0f, 0.0f, 1.0f));
+    EXPECT_FALSE(std::isfinite(Inverse(singular)(1, 1)));
+  }
+}
+
+// Helper function to test transforms of arrays of vectors and of batches
+static void AffineBatches()
+{
+  Affine3<float> a = RigidTransform(0.7f, Vector<float, 3>(1.0f, 2.0f, 3.0f)) *
+                     Affine3<float>::Scaling(Vector<float, 3>(0.5f, 2.0f, 1.0f));
+
+  // Sizes around the block size exercise the packet loop and the scalar tail of each block
+  for (size_t count : {0, 5, 64, 150}) {
+    std::vector<Vector<float, 3>> v(count);
+    for (size_t i = 0; i < count; ++i) {
+      float x = static_cast<float>(i);
+      v[i] = Vector<float, 3>(x, 1.0f - x, 0.5f * x);
+    }
+
+    std::vector<Vector<float, 3>> points(count);
+    std::vector<Vector<float, 3>> directions = v;
+    TransformPoints(a, v.data(), count, points.data());
+    TransformDirections(a, directions.data(), count, directions.data());
+    for (size_t i = 0; i < count; ++i) {
+      Vector<float, 3> p = TransformPoint(a, v[i]);
+      Vector<float, 3> d = TransformDirection(a, v[i]);
+      for (size_t c = 0; c < 3; ++c) {
+        EXPECT_NEAR(points[i][c], p[c], 1e-4f);
+        EXPECT_NEAR(directions[i][c], d[c], 1e-4f);
+      }
+    }
+  }
+
+  // TensorSoA batches in place
+  {
+    TensorSoA<Vector<double, 3>> batch;
+    for (int i = 0; i < 21; ++i) {
+      batch.PushBack(Vector<double, 3>(i, 2 * i, -i));
+    }
+    Affine3<double> b = RigidTransform(-0.4, Vector<double, 3>(0.0, 1.0, 0.0));
+    TensorSoA<Vector<double, 3>> directions = batch;
+    TransformPoints(b, batch);
+    TransformDirections(b, directions);
+    for (int i = 0; i < 21; ++i) {
+      Vector<double, 3> v(i, 2 * i, -i);
+      Vector<double, 3> p = TransformPoint(b, v);
+      Vector<double, 3> d = TransformDirection(b, v);
+      for (size_t c = 0; c < 3; ++c) {
+        EXPECT_NEAR(batch[i][c], p[c], 1e-12);
+        EXPECT_NEAR(directions[i][c], d[c], 1e-12);
+      }
+    }
+  }
+}
+
+TEST(Math, Affine)
+{
+  AffineBasics();
+  AffineBatches();
+}
\ No newline at end of file
@@ -1352,6 +1352,60 @@ static void test()
     static_assert(CanDegenerate<TDimension<1, 1, 1>, TDimension<>>::value);     // All ones can degenerate to scalar
   }
 
+  {
+    // Broadcast Strides Tests
+    // Same dimension reads the source with its own tail products
+    constexpr auto sameStrides = BroadcastStridesV<Matrix, Matrix>;
+    static_assert(sameStrides[0] == 4 && sameStrides[1] == 1);
+
+    // Broadcast axes get zero strides
+    constexpr auto rowStrides = BroadcastStridesV<TDimension<1, 4>, TDimension<1024, 4>>;
+    static_assert(rowStrides[0] == 0 && rowStrides[1] == 1);
+
+    constexpr auto colStrides = BroadcastStridesV<TDimension<3, 1>, TDimension<3, 4>>;
+    static_assert(colStrides[0] == 1 && colStrides[1] == 0);
+
+    constexpr auto singleStrides = BroadcastStridesV<SingleElementVector, Tensor3D>;
+    static_assert(singleStrides[0] == 0 && singleStrides[1] == 0 && singleStrides[2] == 0);
+
+    // Lower rank sources are padded with leading 1s
+    constexpr auto vectorStrides = BroadcastStridesV<TDimension<4>, Tensor3D>;
+    static_assert(vectorStrides[0] == 0 && vectorStrides[1] == 0 && vectorStrides[2] == 1);
+
+    constexpr auto matrixStrides = BroadcastStridesV<TDimension<3, 4>, Tensor3D>;
+    static_assert(matrixStrides[0] == 0 && matrixStrides[1] == 4 && matrixStrides[2] == 1);
+
+    constexpr auto scalarStrides = BroadcastStridesV<Scalar, Matrix>;
+    static_assert(scalarStrides[0] == 0 && scalarStrides[1] == 0);
+
+    static_assert(BroadcastOffset<TDimension<1, 4>, TDimension<1024, 4>>({517, 3}) == 3);
+    static_assert(BroadcastOffset<TDimension<3, 1>, TDimension<3, 4>>({2, 3}) == 2);
+  }
+
+  {
+    // Multi Index Tests
+    constexpr auto matrixIndex = Matrix::MultiIndex(6);
+    static_assert(matrixIndex[0] == 1 && matrixIndex[1] == 2);
+
+    constexpr auto tensorIndex = Tensor3D::MultiIndex(23);
+    static_assert(tensorIndex[0] == 1 && tensorIndex[1] == 2 && tensorIndex[2] == 3);
+
+    static_assert(Matrix::extents[0] == 3 && Matrix::extents[1] == 4);
+    static_assert(Scalar::extents.size() == 0);
+
+    // ForEachMultiIndex visits elements in memory order
+    size_t visited = 0;
+    ForEachMultiIndex<Tensor3D>([&](size_t i, const std::array<size_t, 3>& index) {
+      EXPECT_EQ(i, visited++);
+      EXPECT_EQ(Tensor3D::FlattenedIndex(index[0], index[1], index[2]), i);
+    });
+    EXPECT_EQ(visited, Tensor3D::count);
+
+    visited = 0;
+    ForEachMultiIndex<Scalar>([&](size_t i, const std::array<size_t, 0>&) { visited += i + 1; });
+    EXPECT_EQ(visited, 1);
+  }
+
 }
 
 
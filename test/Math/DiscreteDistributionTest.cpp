@@ -0,0 +1,113 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+#include "DiscreteDistribution.h"
+#include "Random.h"
+
+
+// Fraction of count samples landing on every index
+template<typename Engine>
+static std::vector<double> Frequencies(const DiscreteDistribution& d, size_t count, Engine& rng)
+{
+  std::vector<size_t> samples(count);
+  d.SampleBatch(samples.data(), count, rng);
+  std::vector<double> frequencies(d.Size(), 0.0);
+  for (size_t s : samples) {
+    frequencies.at(s) += 1.0 / count;
+  }
+  return frequencies;
+}
+
+// Helper function to test the alias table against the weights
+static void DiscreteSampling()
+{
+  // Zero weights are never sampled, the others in proportion
+  {
+    DiscreteDistribution d({1.0, 2.0, 0.0, 3.0, 4.0});
+    EXPECT_EQ(d.Size(), 5u);
+    EXPECT_EQ(d.TotalWeight(), 10.0);
+    EXPECT_EQ(d.Probability(3), 0.3);
+    Rng rng(1);
+    std::vector<double> frequencies = Frequencies(d, 1000000, rng);
+    EXPECT_EQ(frequencies[2], 0.0);
+    for (size_t i = 0; i < d.Size(); ++i) {
+      EXPECT_NEAR(frequencies[i], d.Probability(i), 0.002);
+    }
+  }
+
+  // Heavily skewed weights, from every engine
+  {
+    std::vector<double> weights(1000);
+    for (size_t i = 0; i < weights.size(); ++i) {
+      weights[i] = (i % 100 == 0) ? 1000.0 : 1.0 + (i % 7);
+    }
+    DiscreteDistribution d(weights);
+    Pcg32 pcg(2);
+    Xoshiro256PlusPlusLanes<8> lanes(2);
+    for (const std::vector<double>& frequencies :
+         {Frequencies(d, 2000000, pcg), Frequencies(d, 2000000, lanes)}) {
+      for (size_t i = 0; i < d.Size(); i += 50) {
+        EXPECT_NEAR(frequencies[i], d.Probability(i), 0.002);
+      }
+    }
+  }
+
+  // A single index, and equal weights where every column is full
+  {
+    Rng rng(3);
+    DiscreteDistribution one({0.5});
+    EXPECT_EQ(one.Sample(rng), 0u);
+    DiscreteDistribution equal(std::vector<double>(4, 2.0));
+    std::vector<double> frequencies = Frequencies(equal, 400000, rng);
+    for (double f : frequencies) {
+      EXPECT_NEAR(f, 0.25, 0.003);
+    }
+  }
+
+  // Batches draw the same indices as single samples
+  {
+    DiscreteDistribution d({3.0, 1.0, 4.0, 1.0, 5.0});
+    Rng a(4);
+    Rng b(4);
+    std::vector<size_t> batch(100);
+    d.SampleBatch(batch.data(), batch.size(), a);
+    for (size_t s : batch) {
+      EXPECT_EQ(s, d.Sample(b));
+    }
+  }
+}
+
+// Helper function to test weight updates and invalid weights
+static void DiscreteUpdates()
+{
+  DiscreteDistribution d({1.0, 1.0, 1.0, 1.0});
+  d.SetWeight(0, 0.0);
+  d.SetWeight(3, 5.0);
+  EXPECT_TRUE(d.Stale());
+  EXPECT_EQ(d.TotalWeight(), 4.0);
+  d.Rebuild();
+  EXPECT_FALSE(d.Stale());
+  EXPECT_EQ(d.TotalWeight(), 7.0);
+  Rng rng(5);
+  std::vector<double> frequencies = Frequencies(d, 700000, rng);
+  EXPECT_EQ(frequencies[0], 0.0);
+  EXPECT_NEAR(frequencies[1], 1.0 / 7, 0.003);
+  EXPECT_NEAR(frequencies[3], 5.0 / 7, 0.003);
+
+  EXPECT_THROW(d.SetWeight(1, -1.0), std::invalid_argument);
+  EXPECT_THROW(DiscreteDistribution({1.0, std::nan("")}), std::invalid_argument);
+  EXPECT_THROW(DiscreteDistribution({0.0, 0.0}), std::invalid_argument);
+  EXPECT_THROW(DiscreteDistribution(std::vector<double>{}), std::invalid_argument);
+  d.SetWeight(1, 0.0);
+  d.SetWeight(2, 0.0);
+  d.SetWeight(3, 0.0);
+  EXPECT_THROW(d.Rebuild(), std::invalid_argument);
+}
+
+TEST(Math, DiscreteDistribution)
+{
+  DiscreteSampling();
+  DiscreteUpdates();
+}
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include <cstdint>
+#include <gtest/gtest.h>
+
+#include "DynamicTensor.h"
+#include "Tensor.h"
+#include "TensorOperations.h"
+
+
+// Helper function to test construction, storage and element access
+static void DynamicTensorBasics()
+{
+  // Shape, strides and fill
+  {
+    DynamicTensor<float> t({2, 3, 4}, 1.5f);
+    EXPECT_EQ(t.Rank(), 3);
+    EXPECT_EQ(t.Count(), 24);
+    EXPECT_EQ(t.Strides(), (DynamicShape{12, 4, 1}));
+    for (float value : t) {
+      EXPECT_EQ(value, 1.5f);
+    }
+
+    t(1, 2, 3) = 7.0f;
+    EXPECT_EQ(t[23], 7.0f);
+    t[4] = 3.0f;
+    EXPECT_EQ(t(0, 1, 0), 3.0f);
+  }
+
+  // Storage is aligned to a cache line
+  {
+    DynamicTensor<double> t({7, 3});
+    auto address = reinterpret_cast<std::uintptr_t>(t.Data());
+    EXPECT_EQ(address % dynamicTensorAlignment, 0);
+  }
+
+  // Image sized tensors live on the heap
+  {
+    DynamicTensor<float> image({1080, 1920, 4}, 0.25f);
+    EXPECT_EQ(image.Count(), 1080 * 1920 * 4);
+    EXPECT_EQ(image(1079, 1919, 3), 0.25f);
+  }
+
+  // Conversion from a fixed size tensor
+  {
+    Tensor<int, 2, 2> fixed(1, 2, 3, 4);
+    DynamicTensor<int> t(fixed);
+    EXPECT_EQ(t.Shape(), (DynamicShape{2, 2}));
+    EXPECT_EQ(t(1, 0), 3);
+  }
+
+  // Copy and move semantics
+  {
+    DynamicTensor<int> a({3}, 5);
+    DynamicTensor<int> b = a;
+    b[0] = 1;
+    EXPECT_EQ(a[0], 5);
+    EXPECT_NE(a, b);
+
+    DynamicTensor<int> c = std::move(b);
+    EXPECT_EQ(c[0], 1);
+    EXPECT_EQ(b.Count(), 0);
+
+    a = c;
+    EXPECT_EQ(a, c);
+  }
+}
+
+// Helper function to test runtime broadcasting rules
+static void DynamicBroadcasting()
+{
+  EXPECT_TRUE(CanBroadcastShape({1, 4}, {1024, 4}));
+  EXPECT_TRUE(CanBroadcastShape({4}, {2, 3, 4}));
+  EXPECT_TRUE(CanBroadcastShape({}, {2, 3}));
+  EXPECT_FALSE(CanBroadcastShape({2, 4}, {3, 4}));
+  EXPECT_FALSE(CanBroadcastShape({2, 3}, {3}));
+
+  EXPECT_EQ(BroadcastShape({2, 3}, {3}), (DynamicShape{2, 3}));
+  EXPECT_EQ(BroadcastShape({1}, {5, 5}), (DynamicShape{5, 5}));
+  EXPECT_THROW(BroadcastShape({2}, {3}), std::invalid_argument);
+
+  EXPECT_EQ(BroadcastShapeStrides({1, 4}, {1024, 4}), (DynamicShape{0, 1}));
+  EXPECT_EQ(BroadcastShapeStrides({3, 1}, {2, 3, 4}), (DynamicShape{0, 1, 0}));
+}
+
+// Helper function to test componentwise operators on dynamic tensors
+static void DynamicOperations()
+{
+  // Same shape operands
+  {
+    DynamicTensor<float> a({2, 2}, 2.0f);
+    DynamicTensor<float> b({2, 2}, 3.0f);
+    DynamicTensor<float> c = a * b + a;
+    EXPECT_EQ(c, (DynamicTensor<float>({2, 2}, 8.0f)));
+  }
+
+  // Scalars and fixed size tensors broadcast against dynamic ones
+  {
+    DynamicTensor<int> m({3, 2}, 1);
+    m(2, 1) = 10;
+    Tensor<int, 2> row(1, 2);
+
+    DynamicTensor<int> result = (m + row) * 2;
+    EXPECT_EQ(result.Shape(), (DynamicShape{3, 2}));
+    EXPECT_EQ(result(0, 0), 4);
+    EXPECT_EQ(result(1, 1), 6);
+    EXPECT_EQ(result(2, 1), 24);
+
+    DynamicTensor<int> scaled = 3 * m;
+    EXPECT_EQ(scaled(2, 1), 30);
+  }
+
+  // Broadcasting a dynamic row and column
+  {
+    DynamicTensor<int> col({3, 1});
+    for (size_t i = 0; i < 3; ++i) {
+      col[i] = static_cast<int>(i);
+    }
+    DynamicTensor<int> matrix({3, 4}, 100);
+    DynamicTensor<int> result = matrix + col;
+    for (size_t i = 0; i < 3; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        EXPECT_EQ(result(i, j), 100 + static_cast<int>(i));
+      }
+    }
+
+    auto expr = matrix - col;
+    EXPECT_FALSE(expr.IsFlat());
+    EXPECT_EQ(expr[6], 99);
+  }
+
+  // Incompatible shapes throw when the expression is built
+  {
+    DynamicTensor<float> a({2, 3});
+    DynamicTensor<float> b({3, 2});
+    EXPECT_THROW(a + b, std::invalid_argument);
+  }
+
+  // Assignment reuses storage when the shape matches and reshapes otherwise
+  {
+    DynamicTensor<double> a({4}, 1.0);
+    const double* storage = a.Data();
+    a = a + a;
+    EXPECT_EQ(a.Data(), storage);
+    EXPECT_EQ(a, (DynamicTensor<double>({4}, 2.0)));
+
+    DynamicTensor<double> grid({2, 4}, 1.0);
+    a = grid + a;
+    EXPECT_EQ(a, (DynamicTensor<double>({2, 4}, 3.0)));
+  }
+}
+
+TEST(Math, DynamicTensor)
+{
+  DynamicTensorBasics();
+  DynamicBroadcasting();
+  DynamicOperations();
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include "Einsum.h"
+#include "Matrix.h"
+#include "Tensor.h"
+#include "TensorView.h"
+#include "Vector.h"
+
+
+static constexpr char matmul[] = "ij,jk->ik";
+static constexpr char implicitMatmul[] = "ij,jk";
+static constexpr char batchMatVec[] = "bij,bj->bi";
+static constexpr char bilinear[] = "i,ij,j->";
+static constexpr char trace[] = "ii->";
+static constexpr char transpose[] = "ij->ji";
+static constexpr char rowSums[] = "ij->i";
+static constexpr char outer[] = "i,j->ij";
+
+// Helper function to test einsum subscripts against hand written loops
+static void EinsumProducts()
+{
+  // Subscripts are parsed at compile time
+  static_assert(ParseEinsum(matmul).valid);
+  static_assert(ParseEinsum(implicitMatmul).outputCount == 2);
+  static_assert(!ParseEinsum("ij,jk->ikk").valid);
+  static_assert(!ParseEinsum("ij,jk->il").valid);
+  static_assert(!ParseEinsum("i j;k").valid);
+
+  Matrix<float, 3, 4> a;
+  Matrix<float, 4, 5> b;
+  for (size_t i = 0; i < 20; ++i) {
+    if (i < 12) {
+      a[i] = static_cast<float>(i % 5) - 2.0f;
+    }
+    b[i] = static_cast<float>(i % 3) + 1.0f;
+  }
+
+  auto c = Einsum<matmul>(a, b);
+  static_assert(std::is_same_v<decltype(c), Matrix<float, 3, 5>>);
+  EXPECT_EQ(c, Mul(a, b));
+  EXPECT_EQ(Einsum<implicitMatmul>(a, b), Mul(a, b));
+
+  constexpr Matrix<int, 2, 2> small{1, 2, 3, 4};
+  static_assert(Einsum<matmul>(small, small) == Matrix<int, 2, 2>{7, 10, 15, 22});
+  static_assert(Einsum<trace>(small) == 5);
+  static_assert(Einsum<transpose>(small) == Matrix<int, 2, 2>{1, 3, 2, 4});
+  static_assert(Einsum<rowSums>(small) == Vector<int, 2>{3, 7});
+  static_assert(Einsum<outer>(Vector<int, 2>{1, 2}, Vector<int, 3>{1, 0, -1}) ==
+                Matrix<int, 2, 3>{1, 0, -1, 2, 0, -2});
+
+  // Batches of matrix vector products and bilinear forms
+  Tensor<double, 6, 3, 3> m;
+  Tensor<double, 6, 3> v;
+  for (size_t i = 0; i < 54; ++i) {
+    m[i] = static_cast<double>(i % 7) - 3.0;
+  }
+  for (size_t i = 0; i < 18; ++i) {
+    v[i] = static_cast<double>(i % 4);
+  }
+  auto mv = Einsum<batchMatVec>(m, v);
+  for (size_t batch = 0; batch < 6; ++batch) {
+    for (size_t i = 0; i < 3; ++i) {
+      double sum = 0.0;
+      for (size_t j = 0; j < 3; ++j) {
+        sum += m(batch, i, j) * v(batch, j);
+      }
+      EXPECT_EQ(mv(batch, i), sum);
+    }
+  }
+
+  Vector<double, 4> x{1, 2, 3, 4};
+  Vector<double, 5> y{1, -1, 1, -1, 1};
+  double form = 0.0;
+  for (size_t i = 0; i < 4; ++i) {
+    for (size_t j = 0; j < 5; ++j) {
+      form += x[i] * static_cast<double>(b(i, j)) * y[j];
+    }
+  }
+  EXPECT_EQ(Einsum<bilinear>(x, Matrix<double, 4, 5>(b), y), form);
+
+  // Views are read through their strides
+  Tensor<float, 4, 4, 2> pairs;
+  for (size_t i = 0; i < 32; ++i) {
+    pairs[i] = static_cast<float>(i % 9);
+  }
+  Matrix<float, 4, 4> even = Slice<2>(pairs, 0);
+  Matrix<float, 4, 4> odd = Slice<2>(pairs, 1);
+  EXPECT_EQ(Einsum<matmul>(Slice<2>(pairs, 0), Slice<2>(pairs, 1)), Mul(even, odd));
+}
+
+// Helper function to test contractions over pairs of axes
+static void Contractions()
+{
+  Matrix<float, 3, 4> a;
+  Matrix<float, 4, 5> b;
+  for (size_t i = 0; i < 20; ++i) {
+    if (i < 12) {
+      a[i] = static_cast<float>(i % 5) - 2.0f;
+    }
+    b[i] = static_cast<float>(i % 3) + 1.0f;
+  }
+  EXPECT_EQ((Contract<Axes<1>, Axes<0>>(a, b)), Mul(a, b));
+
+  // Contracting the rows of both gives the product of the transposes
+  auto ata = Contract<Axes<0>, Axes<0>>(a, a);
+  static_assert(std::is_same_v<decltype(ata), Matrix<float, 4, 4>>);
+  EXPECT_EQ(ata, Mul(Transposed(a), a));
+
+  // Every axis paired is a full inner product, no pair an outer product
+  float squares = 0.0f;
+  for (size_t i = 0; i < 12; ++i) {
+    squares += a[i] * a[i];
+  }
+  EXPECT_EQ((Contract<Axes<0, 1>, Axes<0, 1>>(a, a)), squares);
+  auto outerProduct = Contract<Axes<>, Axes<>>(Vector<int, 2>{1, 2}, Vector<int, 3>{3, 4, 5});
+  EXPECT_EQ(outerProduct, (Matrix<int, 2, 3>{3, 4, 5, 6, 8, 10}));
+
+  // Axes of the result: the free ones of the first operand, then of the second
+  Tensor<int, 2, 3, 4> t;
+  Tensor<int, 4, 2> u;
+  for (size_t i = 0; i < 24; ++i) {
+    t[i] = static_cast<int>(i);
+  }
+  for (size_t i = 0; i < 8; ++i) {
+    u[i] = static_cast<int>(i) - 3;
+  }
+  auto r = Contract<Axes<2, 0>, Axes<0, 1>>(t, u);
+  static_assert(std::is_same_v<decltype(r), Tensor<int, 3>>);
+  for (size_t j = 0; j < 3; ++j) {
+    int sum = 0;
+    for (size_t i = 0; i < 2; ++i) {
+      for (size_t k = 0; k < 4; ++k) {
+        sum += t(i, j, k) * u(k, i);
+      }
+    }
+    EXPECT_EQ(r[j], sum);
+  }
+}
+
+TEST(Math, Einsum)
+{
+  EinsumProducts();
+  Contractions();
+}
\ No newline at end of file
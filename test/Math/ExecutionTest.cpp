@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <memory>
+#include <vector>
+
+#include "DiscreteDistribution.h"
+#include "DynamicTensor.h"
+#include "Execution.h"
+#include "Matrix.h"
+#include "Sample.h"
+#include "Spectral.h"
+#include "TabulatedSampler1D.h"
+#include "Tensor.h"
+#include "TensorOperations.h"
+#include "Vector.h"
+
+
+// Helper function to test that every policy gives the sequential result
+template<typename Policy>
+static void PolicyMatchesSequential(const Policy& policy)
+{
+  // Broadcast and flat componentwise expressions, in chunks of rows
+  DynamicTensor<float> image({300, 257, 3});
+  for (size_t i = 0; i < image.Count(); ++i) {
+    image[i] = static_cast<float>(i % 97) * 0.5f;
+  }
+  DynamicTensor<float> gain({3}, 2.0f);
+  gain[1] = 0.5f;
+
+  DynamicTensor<float> expected = image * gain + 1.0f;
+  DynamicTensor<float> out;
+  Assign(policy, out, image * gain + 1.0f);
+  EXPECT_EQ(out, expected);
+  expected = image * image;
+  Assign(policy, out, image * image);
+  EXPECT_EQ(out, expected);
+
+  // Fixed size tensors, flattened elements
+  auto big = std::make_unique<Tensor<double, 64, 1024>>();
+  auto row = std::make_unique<Tensor<double, 1024>>();
+  for (size_t i = 0; i < 64 * 1024; ++i) {
+    (*big)[i] = static_cast<double>(i / 1024);
+  }
+  for (size_t i = 0; i < 1024; ++i) {
+    (*row)[i] = static_cast<double>(i);
+  }
+  Assign(policy, *big, *big + *row);
+  EXPECT_EQ((*big)(63, 1000), 1063.0);
+  Assign(policy, *big, *big * 2.0 - 1.0);
+  EXPECT_EQ((*big)(5, 3), 15.0);
+
+  // Products and transposes split by rows
+  DynamicTensor<float> a({130, 70});
+  DynamicTensor<float> b({70, 90});
+  for (size_t i = 0; i < a.Count(); ++i) {
+    a[i] = static_cast<float>(i % 7) - 3.0f;
+  }
+  for (size_t i = 0; i < b.Count(); ++i) {
+    b[i] = static_cast<float>(i % 5) - 2.0f;
+  }
+  EXPECT_EQ(Mul(policy, a, b), Mul(a, b));
+  EXPECT_EQ(Transposed(policy, a), Transposed(a));
+  EXPECT_THROW(Mul(policy, a, a), std::invalid_argument);
+
+  Matrix<float, 40, 30> m;
+  for (size_t i = 0; i < 1200; ++i) {
+    m[i] = static_cast<float>(i % 11);
+  }
+  EXPECT_EQ(Mul(policy, m, Transposed(m)), Mul(m, Transposed(m)));
+
+  // Batches of decompositions split by matrices
+  std::vector<Matrix<double, 3, 3>> symmetric(1000);
+  for (size_t i = 0; i < symmetric.size(); ++i) {
+    for (size_t j = 0; j < 9; ++j) {
+      symmetric[i][j] = static_cast<double>((i + j * j) % 13);
+    }
+    symmetric[i] = symmetric[i] + Transposed(symmetric[i]);
+  }
+  std::vector<SymmetricEigen3<double>> expectedEigen(symmetric.size());
+  std::vector<SymmetricEigen3<double>> eigen(symmetric.size());
+  EigenBatch(symmetric.data(), symmetric.size(), expectedEigen.data());
+  EigenBatch(policy, symmetric.data(), symmetric.size(), eigen.data());
+  std::vector<SingularValueDecomposition<double, 3>> expectedSvd(symmetric.size());
+  std::vector<SingularValueDecomposition<double, 3>> svd(symmetric.size());
+  SvdBatch(symmetric.data(), symmetric.size(), expectedSvd.data());
+  SvdBatch(policy, symmetric.data(), symmetric.size(), svd.data());
+  for (size_t i = 0; i < symmetric.size(); ++i) {
+    EXPECT_EQ(eigen[i].values, expectedEigen[i].values);
+    EXPECT_EQ(eigen[i].vectors, expectedEigen[i].vectors);
+    EXPECT_EQ(svd[i].singularValues, expectedSvd[i].singularValues);
+  }
+
+  // Batches of vectors split by blocks, an odd count leaves a scalar tail
+  std::vector<Vector<float, 3>> u(30001);
+  std::vector<Vector<float, 3>> v(u.size());
+  for (size_t i = 0; i < u.size(); ++i) {
+    float x = static_cast<float>(i % 17);
+    u[i] = Vector<float, 3>(x, 1.0f - x, 0.5f);
+    v[i] = Vector<float, 3>(2.0f, x, x * x);
+  }
+  std::vector<float> expectedScalars(u.size());
+  std::vector<float> scalars(u.size());
+  std::vector<Vector<float, 3>> expectedVectors(u.size());
+  std::vector<Vector<float, 3>> vectors(u.size());
+  DotBatch(u.data(), v.data(), u.size(), expectedScalars.data());
+  DotBatch(policy, u.data(), v.data(), u.size(), scalars.data());
+  EXPECT_EQ(scalars, expectedScalars);
+  LengthBatch(u.data(), u.size(), expectedScalars.data());
+  LengthBatch(policy, u.data(), u.size(), scalars.data());
+  EXPECT_EQ(scalars, expectedScalars);
+  CrossBatch(u.data(), v.data(), u.size(), expectedVectors.data());
+  CrossBatch(policy, u.data(), v.data(), u.size(), vectors.data());
+  EXPECT_EQ(vectors, expectedVectors);
+  NormalizeBatch(u.data(), u.size(), expectedVectors.data());
+  NormalizeBatch(policy, u.data(), u.size(), vectors.data());
+  EXPECT_EQ(vectors, expectedVectors);
+
+  // Bulk samples split by blocks, each drawing from its own stream of the seed
+  size_t sampleCount = 3 * sampleBlockSize + 5;
+  std::vector<double> expectedSamples(sampleCount);
+  std::vector<double> samples(sampleCount);
+  for (size_t b = 0; b < 4; ++b) {
+    SampleBlockEngine rng(9, b);
+    size_t first = b * sampleBlockSize;
+    size_t last = std::min(first + sampleBlockSize, sampleCount);
+    FillUniform(expectedSamples.data() + first, last - first, -1.0, 1.0, rng);
+  }
+  FillUniform(policy, samples.data(), sampleCount, -1.0, 1.0, 9);
+  EXPECT_EQ(samples, expectedSamples);
+
+  std::vector<float> expectedY(sampleCount);
+  std::vector<float> x(sampleCount);
+  std::vector<float> y(sampleCount);
+  FillUniform2D(gtk::exec::seq, x.data(), expectedY.data(), sampleCount, 0.0f, 1.0f, 9);
+  FillUniform2D(policy, x.data(), y.data(), sampleCount, 0.0f, 1.0f, 9);
+  EXPECT_EQ(y, expectedY);
+  EXPECT_NE(x, y);
+
+  TabulatedSampler1D tabulated(NormalDistribution(0.0, 1.0), 256);
+  tabulated.SampleBatch(gtk::exec::seq, expectedSamples.data(), sampleCount, 4);
+  tabulated.SampleBatch(policy, samples.data(), sampleCount, 4);
+  EXPECT_EQ(samples, expectedSamples);
+
+  DiscreteDistribution discrete({1.0, 3.0, 0.5, 2.0});
+  std::vector<size_t> expectedIndices(sampleCount);
+  std::vector<size_t> indices(sampleCount);
+  discrete.SampleBatch(gtk::exec::seq, expectedIndices.data(), sampleCount, 4);
+  discrete.SampleBatch(policy, indices.data(), sampleCount, 4);
+  EXPECT_EQ(indices, expectedIndices);
+}
+
+TEST(Math, Execution)
+{
+  PolicyMatchesSequential(gtk::exec::seq);
+  PolicyMatchesSequential(gtk::exec::par);
+  PolicyMatchesSequential(gtk::exec::par_unseq);
+
+  // A threshold below the size of the test tensors splits them in many chunks
+  PolicyMatchesSequential(gtk::exec::ParallelPolicy{64});
+}
\ No newline at end of file
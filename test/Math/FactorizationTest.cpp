@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include "DynamicTensor.h"
+#include "Factorization.h"
+#include "Matrix.h"
+#include "TensorSoA.h"
+#include "Vector.h"
+
+
+// Diagonally dominant, so invertible, with a symmetric part when symmetric is set
+template<size_t r, size_t c>
+static Matrix<double, r, c> TestMatrix(bool symmetric = false)
+{
+  Matrix<double, r, c> m;
+  for (size_t i = 0; i < r; ++i) {
+    for (size_t j = 0; j < c; ++j) {
+      size_t a = symmetric ? std::min(i, j) : i;
+      size_t b = symmetric ? std::max(i, j) : j;
+      m(i, j) = i == j ? 2.0 * static_cast<double>(c) : 1.0 / static_cast<double>(a + 2 * b + 1);
+    }
+  }
+  return m;
+}
+
+// Helper function to test the fixed size factorizations
+static void FixedFactorizations()
+{
+  Matrix<double, 5, 3> x;
+  for (size_t i = 0; i < 15; ++i) {
+    x[i] = static_cast<double>(i % 7) - 3.0;
+  }
+
+  // LU solves vectors and matrices of right hand sides, and gives the determinant
+  {
+    auto a = TestMatrix<5, 5>();
+    LU lu(a);
+    EXPECT_FALSE(lu.IsSingular());
+    EXPECT_NEAR(lu.Det(), Det(a), 1e-9);
+
+    Matrix<double, 5, 3> solved = lu.Solve(Mul(a, x));
+    for (size_t i = 0; i < 15; ++i) {
+      EXPECT_NEAR(solved[i], x[i], 1e-12);
+    }
+
+    Vector<double, 5> v(1.0, -2.0, 0.5, 3.0, 0.0);
+    Vector<double, 5> b = Mul(a, Matrix<double, 5, 1>(v));
+    Vector<double, 5> w = lu.Solve(b);
+    for (size_t i = 0; i < 5; ++i) {
+      EXPECT_NEAR(w[i], v[i], 1e-12);
+    }
+
+    LU singular(Matrix<double, 2, 2>(1.0, 2.0, 2.0, 4.0));
+    EXPECT_TRUE(singular.IsSingular());
+    EXPECT_EQ(singular.Det(), 0.0);
+  }
+
+  // Cholesky of a symmetric positive definite matrix
+  {
+    auto a = TestMatrix<5, 5>(true);
+    Cholesky cholesky(a);
+    EXPECT_TRUE(cholesky.IsPositiveDefinite());
+
+    Matrix<double, 5, 5> l = cholesky.L();
+    Matrix<double, 5, 5> lt{};
+    for (size_t i = 0; i < 5; ++i) {
+      for (size_t j = 0; j < 5; ++j) {
+        lt(i, j) = l(j, i);
+      }
+    }
+    Matrix<double, 5, 5> product = Mul(l, lt);
+    for (size_t i = 0; i < 25; ++i) {
+      EXPECT_NEAR(product[i], a[i], 1e-12);
+    }
+
+    Matrix<double, 5, 3> solved = cholesky.Solve(Mul(a, x));
+    for (size_t i = 0; i < 15; ++i) {
+      EXPECT_NEAR(solved[i], x[i], 1e-12);
+    }
+
+    EXPECT_FALSE(Cholesky(Matrix<double, 2, 2>(1.0, 2.0, 2.0, 1.0)).IsPositiveDefinite());
+  }
+
+  // QR solves consistent overdetermined systems exactly and fits lines in the least squares sense
+  {
+    auto a = TestMatrix<8, 5>();
+    QR qr(a);
+    EXPECT_TRUE(qr.IsFullRank());
+    Matrix<double, 5, 3> solved = qr.Solve(Mul(a, x));
+    for (size_t i = 0; i < 15; ++i) {
+      EXPECT_NEAR(solved[i], x[i], 1e-12);
+    }
+
+    // y = 2 x + 1 plus noise orthogonal to the columns
+    Matrix<double, 4, 2> line(0.0, 1.0, 1.0, 1.0, 2.0, 1.0, 3.0, 1.0);
+    Vector<double, 4> y(1.5, 2.5, 4.5, 7.5);
+    Vector<double, 2> fit = QR(line).Solve(y);
+    EXPECT_NEAR(fit[0], 2.0, 1e-12);
+    EXPECT_NEAR(fit[1], 1.0, 1e-12);
+  }
+
+  // Batches of right hand sides
+  {
+    auto a = TestMatrix<3, 3>();
+    TensorSoA<Vector<double, 3>> b;
+    for (int i = 0; i < 37; ++i) {
+      b.PushBack(Vector<double, 3>(i, 1.0 - i, 0.5 * i));
+    }
+    TensorSoA<Vector<double, 3>> solved = LU(a).Solve(b);
+    EXPECT_EQ(solved.Size(), 37);
+    for (size_t i = 0; i < 37; ++i) {
+      Vector<double, 3> back = Mul(a, Matrix<double, 3, 1>(solved[i].Eval()));
+      for (size_t c = 0; c < 3; ++c) {
+        EXPECT_NEAR(back[c], b[i][c], 1e-12);
+      }
+    }
+  }
+}
+
+// Helper function to test the dynamic factorizations, with more right hand sides than one block
+static void DynamicFactorizations()
+{
+  size_t n = 70;
+  size_t k = 1100;
+  DynamicTensor<double> a({n, n});
+  DynamicTensor<double> spd({n, n});
+  DynamicTensor<double> x({n, k});
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      a(i, j) = i == j ? 100.0 : 1.0 / static_cast<double>(i + 2 * j + 1);
+      spd(i, j) = i == j ? 100.0 : 1.0 / static_cast<double>(i + j + 1);
+    }
+  }
+  for (size_t i = 0; i < x.Count(); ++i) {
+    x[i] = static_cast<double>(i % 13) - 6.0;
+  }
+
+  auto expectSolved = [&](const DynamicTensor<double>& solved) {
+    EXPECT_EQ(solved.Shape(), x.Shape());
+    for (size_t i = 0; i < x.Count(); ++i) {
+      EXPECT_NEAR(solved[i], x[i], 1e-10);
+    }
+  };
+  expectSolved(LU(a).Solve(Mul(a, x)));
+  expectSolved(Cholesky(spd).Solve(Mul(spd, x)));
+
+  DynamicTensor<double> tall({n + 9, n});
+  for (size_t i = 0; i < tall.Count(); ++i) {
+    tall[i] = i % (n + 1) == 0 ? 50.0 : 1.0 / static_cast<double>(i % 17 + 1);
+  }
+  expectSolved(QR(tall).Solve(Mul(tall, x)));
+
+  DynamicTensor<double> vector({n});
+  EXPECT_EQ(LU(a).Solve(vector).Shape(), (DynamicShape{n}));
+  EXPECT_THROW(LU(a).Solve(DynamicTensor<double>({n + 1})), std::invalid_argument);
+  EXPECT_THROW(LU{tall}, std::invalid_argument);
+  EXPECT_THROW(QR(DynamicTensor<double>({3, 5})), std::invalid_argument);
+  EXPECT_THROW(Cholesky{vector}, std::invalid_argument);
+}
+
+TEST(Math, Factorization)
+{
+  FixedFactorizations();
+  DynamicFactorizations();
+}
\ No newline at end of file
@@ -0,0 +1,308 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "DynamicTensor.h"
+#include "Matrix.h"
+#include "Tensor.h"
+
+
+// Reference product through the naive triple loop
+template<typename S, size_t r, size_t k, size_t c>
+static Matrix<S, r, c> NaiveMul(const Matrix<S, r, k>& lhs, const Matrix<S, k, c>& rhs)
+{
+  Matrix<S, r, c> result{};
+  for (size_t i = 0; i < r; ++i) {
+    for (size_t j = 0; j < c; ++j) {
+      for (size_t p = 0; p < k; ++p) {
+        result(i, j) += lhs(i, p) * rhs(p, j);
+      }
+    }
+  }
+  return result;
+}
+
+// Small integer entries keep every product exact in floating point
+template<typename S, size_t r, size_t c>
+static Matrix<S, r, c> Filled(int seed)
+{
+  Matrix<S, r, c> m;
+  for (size_t i = 0; i < r * c; ++i) {
+    m[i] = static_cast<S>((static_cast<int>(i) * 7 + seed) % 11 - 5);
+  }
+  return m;
+}
+
+template<typename S, size_t r, size_t k, size_t c>
+static void ExpectMulMatchesNaive()
+{
+  auto lhs = Filled<S, r, k>(1);
+  auto rhs = Filled<S, k, c>(3);
+  EXPECT_EQ(Mul(lhs, rhs), (NaiveMul(lhs, rhs)));
+}
+
+// Helper function to test the unrolled, tiled and dynamic products
+static void Multiplication()
+{
+  // Unrolled sizes, packet rows and scalar expressions
+  ExpectMulMatchesNaive<float, 2, 2, 2>();
+  ExpectMulMatchesNaive<float, 3, 3, 3>();
+  ExpectMulMatchesNaive<float, 4, 4, 4>();
+  ExpectMulMatchesNaive<double, 4, 4, 4>();
+  ExpectMulMatchesNaive<double, 2, 3, 2>();
+  ExpectMulMatchesNaive<int, 4, 4, 4>();
+
+  // Tiled sizes with partial tiles on every edge, and depths across several blocks
+  ExpectMulMatchesNaive<float, 5, 7, 3>();
+  ExpectMulMatchesNaive<float, 16, 16, 16>();
+  ExpectMulMatchesNaive<float, 33, 17, 29>();
+  ExpectMulMatchesNaive<double, 9, 300, 21>();
+  ExpectMulMatchesNaive<int, 13, 6, 19>();
+
+  // Mixed scalars promote like the componentwise operators
+  {
+    Matrix<int, 2, 2> a(1, 2, 3, 4);
+    Matrix<double, 2, 2> b(0.5, 0.0, 0.0, 0.5);
+    EXPECT_EQ(Mul(a, b), (Matrix<double, 2, 2>(0.5, 1.0, 1.5, 2.0)));
+  }
+
+  // Products of constants are constants
+  {
+    constexpr Matrix<int, 2, 2> a(1, 2, 3, 4);
+    constexpr Matrix<int, 2, 2> aa = Mul(a, a);
+    static_assert(aa(0, 0) == 7 && aa(0, 1) == 10 && aa(1, 0) == 15 && aa(1, 1) == 22);
+
+    constexpr Matrix<int, 5, 1> ones(1, 1, 1, 1, 1);
+    constexpr Matrix<int, 1, 5> row(1, 2, 3, 4, 5);
+    static_assert(Mul(row, ones)[0] == 15);
+  }
+
+  // Dynamic matrices go through the same kernel
+  {
+    auto lhs = Filled<float, 37, 45>(2);
+    auto rhs = Filled<float, 45, 70>(5);
+    DynamicTensor<float> product = Mul(DynamicTensor<float>(lhs), DynamicTensor<float>(rhs));
+    EXPECT_EQ(product.Shape(), (DynamicShape{37, 70}));
+    EXPECT_EQ(product, DynamicTensor<float>(NaiveMul(lhs, rhs)));
+
+    DynamicTensor<float> vector({45});
+    EXPECT_THROW(Mul(DynamicTensor<float>(lhs), vector), std::invalid_argument);
+    EXPECT_THROW(Mul(DynamicTensor<float>(lhs), DynamicTensor<float>(lhs)), std::invalid_argument);
+  }
+}
+
+// Helper function to test the compile time ordering of matrix chains
+static void MultiplicationChains()
+{
+  // A (B v) instead of (A B) v
+  {
+    using A = Matrix<float, 4, 1000>;
+    using B = Matrix<float, 1000, 4>;
+    using V = Matrix<float, 4, 1>;
+    static_assert(MulChainCostV<A, B, V> == 8000);
+    static_assert(MulChain<A, B, V>::plan.split[0][2] == 0);
+
+    auto a = std::make_unique<A>(Filled<float, 4, 1000>(1));
+    auto b = std::make_unique<B>(Filled<float, 1000, 4>(2));
+    V v(1.0f, -2.0f, 3.0f, 0.5f);
+    EXPECT_EQ(Mul(*a, *b, v), Mul(*a, Mul(*b, v)));
+  }
+
+  // The textbook chain of six matrices
+  {
+    using Chain = MulChain<
+      Matrix<int, 30, 35>,
+      Matrix<int, 35, 15>,
+      Matrix<int, 15, 5>,
+      Matrix<int, 5, 10>,
+      Matrix<int, 10, 20>,
+      Matrix<int, 20, 25>>;
+    static_assert(Chain::cost == 15125);
+    static_assert(Chain::plan.split[0][5] == 2);
+  }
+
+  // Any order gives the same product
+  {
+    auto m1 = Filled<int, 3, 7>(1);
+    auto m2 = Filled<int, 7, 2>(2);
+    auto m3 = Filled<int, 2, 9>(3);
+    auto m4 = Filled<int, 9, 1>(4);
+    EXPECT_EQ(Mul(m1, m2, m3, m4), Mul(Mul(Mul(m1, m2), m3), m4));
+
+    constexpr Matrix<int, 2, 2> a(1, 2, 3, 4);
+    constexpr Matrix<int, 2, 1> x(1, -1);
+    static_assert(Mul(a, a, x)(0, 0) == -3);
+  }
+
+  // Chains with dynamic matrices
+  {
+    DynamicTensor<float> a(Filled<float, 3, 4>(1));
+    DynamicTensor<float> b(Filled<float, 4, 5>(2));
+    DynamicTensor<float> c(Filled<float, 5, 2>(3));
+    EXPECT_EQ(Mul(a, b, c), Mul(Mul(a, b), c));
+  }
+}
+
+template<typename S, size_t n>
+static void ExpectNearIdentity(const Matrix<S, n, n>& m, S epsilon)
+{
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      EXPECT_NEAR(m(i, j), i == j ? S{1} : S{0}, epsilon);
+    }
+  }
+}
+
+template<size_t n>
+static void ExpectAdjugateIdentity()
+{
+  auto m = Filled<int, n, n>(4);
+  Matrix<int, n, n> product = Mul(m, Adjugate(m));
+  int det = Det(m);
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      EXPECT_EQ(product(i, j), i == j ? det : 0);
+    }
+  }
+}
+
+// Helper function to test determinants, adjugates and inverses
+static void Inverses()
+{
+  // Closed forms are constant expressions
+  {
+    static_assert(Det(Matrix<int, 1, 1>(5)) == 5);
+    static_assert(Det(Matrix<int, 2, 2>(1, 2, 3, 4)) == -2);
+    static_assert(Det(Matrix<int, 3, 3>(2, 0, 1, 1, 3, 2, 1, 1, 2)) == 6);
+    static_assert(Det(Matrix<int, 4, 4>(1, 0, 2, -1, 3, 0, 0, 5, 2, 1, 4, -3, 1, 0, 5, 0)) == 30);
+
+    constexpr Matrix<double, 2, 2> inv = Inverse(Matrix<double, 2, 2>(2.0, 1.0, 1.0, 1.0));
+    static_assert(inv == Matrix<double, 2, 2>(1.0, -1.0, -1.0, 2.0));
+  }
+
+  // m Adjugate(m) = Det(m) I, exact in integers
+  ExpectAdjugateIdentity<2>();
+  ExpectAdjugateIdentity<3>();
+  ExpectAdjugateIdentity<4>();
+
+  // Closed form and LU inverses
+  {
+    Matrix<float, 3, 3> m3(2.0f, -1.0f, 0.0f, -1.0f, 2.0f, -1.0f, 0.0f, -1.0f, 2.0f);
+    ExpectNearIdentity(Mul(m3, Inverse(m3)), 1e-6f);
+
+    Matrix<double, 4, 4> m4(4, 1, 2, 0, 1, 5, 0, 1, 2, 0, 6, 1, 0, 1, 1, 3);
+    ExpectNearIdentity(Mul(m4, Inverse(m4)), 1e-12);
+    EXPECT_EQ(InverseTransposed(m4)(1, 2), Inverse(m4)(2, 1));
+
+    Matrix<double, 6, 6> m6{};
+    for (size_t i = 0; i < 6; ++i) {
+      for (size_t j = 0; j < 6; ++j) {
+        m6(i, j) = i == j ? 0.5 : 1.0 / static_cast<double>(i + j + 1);
+      }
+    }
+    ExpectNearIdentity(Mul(m6, Inverse(m6)), 1e-12);
+    ExpectNearIdentity(Mul(Inverse(m6), m6), 1e-12);
+  }
+
+  // LU determinants follow the row swaps
+  {
+    Matrix<double, 5, 5> permutation{};
+    size_t rows[5] = {1, 0, 2, 4, 3};
+    for (size_t i = 0; i < 5; ++i) {
+      permutation(i, rows[i]) = 2.0;
+    }
+    EXPECT_DOUBLE_EQ(Det(permutation), 32.0);
+
+    Matrix<double, 5, 5> singular = permutation;
+    singular(3, 3) = 2.0;
+    singular(3, 4) = 0.0;
+    EXPECT_EQ(Det(singular), 0.0);
+    Matrix<double, 5, 5> noInverse = Inverse(singular);
+    for (size_t i = 0; i < 25; ++i) {
+      EXPECT_TRUE(std::isnan(noInverse[i]));
+    }
+
+    auto m = Filled<double, 5, 5>(1);
+    Matrix<double, 4, 4> minor{};
+    for (size_t i = 0; i < 4; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        minor(i, j) = m(i + 1, j + 1);
+      }
+    }
+    Matrix<double, 5, 5> block{};
+    block(0, 0) = 3.0;
+    for (size_t i = 0; i < 4; ++i) {
+      for (size_t j = 0; j < 4; ++j) {
+        block(i + 1, j + 1) = minor(i, j);
+      }
+    }
+    EXPECT_NEAR(Det(block), 3.0 * Det(minor), 1e-9);
+  }
+}
+
+template<typename S>
+static void ExpectDynamicTransposed(size_t rows, size_t cols)
+{
+  DynamicTensor<S> m({rows, cols});
+  for (size_t i = 0; i < rows * cols; ++i) {
+    m[i] = static_cast<S>(i);
+  }
+  DynamicTensor<S> t = Transposed(m);
+  ASSERT_EQ(t.Shape(), (DynamicShape{cols, rows}));
+  for (size_t i = 0; i < rows; ++i) {
+    for (size_t j = 0; j < cols; ++j) {
+      EXPECT_EQ(t(j, i), m(i, j));
+    }
+  }
+  if (rows == cols) {
+    TransposeInPlace(m);
+    EXPECT_EQ(m, t);
+  }
+}
+
+// Helper function to test register tiled, recursive and in place transposes
+static void Transposes()
+{
+  // Fixed sizes on both sides of the tile widths, constant evaluated as well
+  {
+    constexpr auto m = Matrix<int, 2, 3>{1, 2, 3, 4, 5, 6};
+    static_assert(Transposed(m) == Matrix<int, 3, 2>{1, 4, 2, 5, 3, 6});
+    EXPECT_EQ(Transposed(m), (Matrix<int, 3, 2>{1, 4, 2, 5, 3, 6}));
+
+    auto a = Filled<float, 9, 13>(2);
+    auto t = Transposed(a);
+    for (size_t i = 0; i < 9; ++i) {
+      for (size_t j = 0; j < 13; ++j) {
+        EXPECT_EQ(t(j, i), a(i, j));
+      }
+    }
+    EXPECT_EQ(Transposed(t), a);
+
+    auto square = Filled<double, 11, 11>(4);
+    auto copy = square;
+    TransposeInPlace(copy);
+    EXPECT_EQ(copy, Transposed(square));
+  }
+
+  // Dynamic sizes cross the recursion threshold, odd sizes leave scalar edges
+  {
+    ExpectDynamicTransposed<float>(1, 1);
+    ExpectDynamicTransposed<float>(100, 37);
+    ExpectDynamicTransposed<float>(3, 1000);
+    ExpectDynamicTransposed<double>(129, 129);
+    ExpectDynamicTransposed<float>(200, 200);
+    ExpectDynamicTransposed<int>(67, 67);
+
+    DynamicTensor<float> rectangle({2, 3});
+    EXPECT_THROW(TransposeInPlace(rectangle), std::invalid_argument);
+    EXPECT_THROW(Transposed(DynamicTensor<float>({2, 3, 4})), std::invalid_argument);
+  }
+}
+
+TEST(Math, Matrix)
+{
+  Multiplication();
+  MultiplicationChains();
+  Inverses();
+  Transposes();
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "Matrix.h"
+#include "Quaternion.h"
+#include "TensorSoA.h"
+#include "Vector.h"
+
+
+template<typename Scalar>
+static void ExpectQuaternionNear(
+  const Quaternion<Scalar>& a,
+  const Quaternion<Scalar>& b,
+  Scalar epsilon
+)
+{
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_NEAR(a[i], b[i], epsilon);
+  }
+}
+
+// Unit quaternions spread over the sphere, some with negative w
+template<typename Scalar>
+static std::vector<Quaternion<Scalar>> Rotations(size_t count, Scalar phase)
+{
+  std::vector<Quaternion<Scalar>> q(count);
+  for (size_t i = 0; i < count; ++i) {
+    Scalar s = static_cast<Scalar>(i) + phase;
+    q[i] = Normalize(
+      Quaternion<Scalar>(std::sin(s), std::cos(2 * s), std::sin(3 * s), std::cos(s))
+    );
+  }
+  return q;
+}
+
+// Helper function to test construction, composition and conversions
+static void QuaternionBasics()
+{
+  constexpr Quaternion<float> identity;
+  static_assert(identity.W() == 1.0f && identity.Vec() == Vector<float, 3>(0.0f, 0.0f, 0.0f));
+  static_assert(identity * identity == identity);
+
+  // A quarter turn around z takes x to y
+  {
+    Vector<double, 3> z(0.0, 0.0, 1.0);
+    auto q = Quaternion<double>::AxisAngle(z, std::acos(-1.0) / 2);
+    Vector<double, 3> y = Rotate(q, Vector<double, 3>(1.0, 0.0, 0.0));
+    EXPECT_NEAR(y[0], 0.0, 1e-12);
+    EXPECT_NEAR(y[1], 1.0, 1e-12);
+    EXPECT_NEAR(y[2], 0.0, 1e-12);
+    ExpectQuaternionNear(q * Conjugate(q), Quaternion<double>(), 1e-12);
+    ExpectQuaternionNear(Inverse(q), Conjugate(q), 1e-12);
+  }
+
+  // Products apply the right hand side first, matrices agree, conversions round trip
+  std::vector<Quaternion<double>> q = Rotations<double>(32, 0.1);
+  Vector<double, 3> v(0.5, -2.0, 1.25);
+  for (size_t i = 0; i + 1 < q.size(); ++i) {
+    Vector<double, 3> composed = Rotate(q[i] * q[i + 1], v);
+    Vector<double, 3> chained = Rotate(q[i], Rotate(q[i + 1], v));
+    Vector<double, 3> matrix = Mul(ToMatrix(q[i]), Matrix<double, 3, 1>(Rotate(q[i + 1], v)));
+    for (size_t c = 0; c < 3; ++c) {
+      EXPECT_NEAR(composed[c], chained[c], 1e-12);
+      EXPECT_NEAR(matrix[c], chained[c], 1e-12);
+    }
+    EXPECT_NEAR(Length(q[i] * q[i + 1]), 1.0, 1e-12);
+
+    // The matrix does not know the sign of the quaternion
+    Quaternion<double> back = Quaternion<double>::FromMatrix(ToMatrix(q[i]));
+    EXPECT_NEAR(std::abs(Dot(back, q[i])), 1.0, 1e-12);
+  }
+}
+
+// Helper function to test nlerp, slerp and the fast slerp against each other
+static void QuaternionInterpolation()
+{
+  std::vector<Quaternion<double>> a = Rotations<double>(40, 0.3);
+  std::vector<Quaternion<double>> b = Rotations<double>(40, 1.7);
+  for (size_t i = 0; i < a.size(); ++i) {
+    ExpectQuaternionNear(Slerp(a[i], b[i], 0.0), a[i], 1e-12);
+    ExpectQuaternionNear(Nlerp(a[i], b[i], 0.0), a[i], 1e-12);
+    for (double t : {0.0, 0.2, 0.5, 0.9, 1.0}) {
+      Quaternion<double> exact = Slerp(a[i], b[i], t);
+      ExpectQuaternionNear(FastSlerp(a[i], b[i], t), exact, 4e-5);
+      EXPECT_NEAR(Length(exact), 1.0, 1e-12);
+      EXPECT_NEAR(Length(Nlerp(a[i], b[i], t)), 1.0, 1e-12);
+
+      // Constant speed: the angle to a grows linearly with t
+      double angle = std::acos(std::min(std::abs(Dot(a[i], b[i])), 1.0));
+      double travelled = std::acos(std::min(std::abs(Dot(a[i], exact)), 1.0));
+      EXPECT_NEAR(travelled, t * angle, 1e-6);
+    }
+    // The shortest arc, b and -b give the same blend
+    Quaternion<double> negated(-b[i][0], -b[i][1], -b[i][2], -b[i][3]);
+    ExpectQuaternionNear(Slerp(a[i], negated, 0.5), Slerp(a[i], b[i], 0.5), 1e-12);
+    ExpectQuaternionNear(Nlerp(a[i], negated, 0.5), Nlerp(a[i], b[i], 0.5), 1e-12);
+  }
+
+  // Equal rotations do not divide by zero
+  ExpectQuaternionNear(Slerp(a[0], a[0], 0.25), a[0], 1e-12);
+  ExpectQuaternionNear(FastSlerp(a[0], a[0], 0.25), a[0], 1e-12);
+}
+
+// Helper function to test batches of rotations and blends against the scalar functions
+template<typename Scalar>
+static void QuaternionBatches(Scalar epsilon)
+{
+  // Sizes around the block size exercise the packet loop and the scalar tail of each block
+  for (size_t count : {0, 7, 64, 150}) {
+    std::vector<Quaternion<Scalar>> a = Rotations<Scalar>(count, Scalar(0.2));
+    std::vector<Quaternion<Scalar>> b = Rotations<Scalar>(count, Scalar(2.9));
+    std::vector<Vector<Scalar, 3>> v(count);
+    for (size_t i = 0; i < count; ++i) {
+      Scalar x = static_cast<Scalar>(i);
+      v[i] = Vector<Scalar, 3>(x, 1 - x, x / 2);
+    }
+
+    std::vector<Vector<Scalar, 3>> rotated(count);
+    std::vector<Vector<Scalar, 3>> shared = v;
+    RotateBatch(a.data(), v.data(), count, rotated.data());
+    Rotate(b.empty() ? Quaternion<Scalar>() : b[0], shared.data(), count, shared.data());
+    for (size_t i = 0; i < count; ++i) {
+      Vector<Scalar, 3> r = Rotate(a[i], v[i]);
+      Vector<Scalar, 3> s = Rotate(b[0], v[i]);
+      for (size_t c = 0; c < 3; ++c) {
+        Scalar scale = 1 + std::abs(v[i][0]);
+        EXPECT_NEAR(rotated[i][c], r[c], epsilon * scale);
+        EXPECT_NEAR(shared[i][c], s[c], epsilon * scale);
+      }
+    }
+
+    std::vector<Quaternion<Scalar>> products(count);
+    std::vector<Quaternion<Scalar>> nlerps(count);
+    std::vector<Quaternion<Scalar>> slerps = a;
+    MulBatch(a.data(), b.data(), count, products.data());
+    NlerpBatch(a.data(), b.data(), Scalar(0.3), count, nlerps.data());
+    SlerpBatch(slerps.data(), b.data(), Scalar(0.3), count, slerps.data());
+    for (size_t i = 0; i < count; ++i) {
+      ExpectQuaternionNear(products[i], a[i] * b[i], epsilon);
+      ExpectQuaternionNear(nlerps[i], Nlerp(a[i], b[i], Scalar(0.3)), epsilon);
+      ExpectQuaternionNear(slerps[i], FastSlerp(a[i], b[i], Scalar(0.3)), epsilon);
+    }
+  }
+
+  // TensorSoA batches in place
+  {
+    TensorSoA<Vector<Scalar, 3>> batch;
+    for (int i = 0; i < 21; ++i) {
+      batch.PushBack(Vector<Scalar, 3>(i, 2 * i, -i));
+    }
+    Quaternion<Scalar> q = Rotations<Scalar>(1, Scalar(0.5))[0];
+    Rotate(q, batch);
+    for (int i = 0; i < 21; ++i) {
+      Vector<Scalar, 3> r = Rotate(q, Vector<Scalar, 3>(i, 2 * i, -i));
+      for (size_t c = 0; c < 3; ++c) {
+        EXPECT_NEAR(batch[i][c], r[c], epsilon * (1 + i));
+      }
+    }
+  }
+}
+
+TEST(Math, Quaternion)
+{
+  QuaternionBasics();
+  QuaternionInterpolation();
+  QuaternionBatches<float>(1e-5f);
+  QuaternionBatches<double>(1e-12);
+}
\ No newline at end of file
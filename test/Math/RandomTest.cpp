@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Random.h"
+#include "Sample.h"
+#include "TensorSoA.h"
+#include "Vector.h"
+
+
+template<typename Engine>
+static std::vector<uint64_t> Draw(Engine& rng, size_t count)
+{
+  std::vector<uint64_t> x(count);
+  for (uint64_t& v : x) {
+    v = rng();
+  }
+  return x;
+}
+
+// Helper function to test seeding, the reference output and stream splitting
+static void RngStreams()
+{
+  static_assert(Rng(7)() == Rng(7)());
+  static_assert(Rng(7)() != Rng(8)());
+  static_assert(Rng(7, 0)() != Rng(7, 1)());
+
+  // Same seed and stream, same numbers; different seeds or streams, different numbers
+  Rng a(42, 3);
+  Rng b(42, 3);
+  EXPECT_EQ(Draw(a, 1000), Draw(b, 1000));
+  Rng c(42, 4);
+  Rng d(43, 3);
+  EXPECT_NE(Draw(a, 16), Draw(c, 16));
+  EXPECT_NE(Draw(b, 16), Draw(d, 16));
+
+  // Split hands out the current stream and jumps past it
+  Rng e(5);
+  Rng f = e;
+  Rng first = e.Split();
+  EXPECT_EQ(first, f);
+  f.Jump();
+  EXPECT_EQ(e, f);
+  Rng second = e.Split();
+  EXPECT_NE(Draw(first, 64), Draw(second, 64));
+  Rng g = e;
+  g.LongJump();
+  EXPECT_NE(e, g);
+
+  // Uniform doubles are in [0, 1) and cover it evenly
+  Rng u(11);
+  std::vector<int> bins(10, 0);
+  for (int i = 0; i < 100000; ++i) {
+    double x = UniformDouble(u);
+    ASSERT_GE(x, 0.0);
+    ASSERT_LT(x, 1.0);
+    ++bins[static_cast<size_t>(x * 10)];
+  }
+  for (int bin : bins) {
+    EXPECT_NEAR(bin / 100000.0, 0.1, 0.01);
+  }
+}
+
+// Helper function to test the engines against the reference implementations and their streams
+static void RandomEngines()
+{
+  // pcg32-demo of the PCG reference, seed 42 and stream 54
+  Pcg32 pcg(42, 54);
+  std::vector<uint64_t> expected = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b};
+  Pcg32 skipped = pcg;
+  EXPECT_EQ(Draw(pcg, 5), expected);
+  skipped.Advance(3);
+  EXPECT_EQ(Draw(skipped, 2), std::vector<uint64_t>(expected.begin() + 3, expected.end()));
+  EXPECT_EQ(Draw(skipped, 100), Draw(pcg, 100));
+
+  // Known answers of Random123
+  static_assert(Philox4x32::Block({0, 0, 0, 0}, {0, 0})[3] == 0x9b00dbd8);
+  EXPECT_EQ(
+    Philox4x32::Block({0, 0, 0, 0}, {0, 0}),
+    (Philox4x32::CounterType{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8})
+  );
+  EXPECT_EQ(
+    Philox4x32::Block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+    (Philox4x32::CounterType{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd})
+  );
+  EXPECT_EQ(
+    Philox4x32::Block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+    (Philox4x32::CounterType{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1})
+  );
+
+  // The engine walks the counters, Seek jumps straight to any of its numbers
+  Philox4x32 philox(0x0123456789abcdef, 7);
+  std::vector<uint64_t> numbers = Draw(philox, 23);
+  Philox4x32::CounterType first = Philox4x32::Block({0, 0, 7, 0}, {0x89abcdef, 0x01234567});
+  EXPECT_EQ(numbers[2], first[2]);
+  for (uint64_t position : {0, 3, 4, 13}) {
+    Philox4x32 seeked(0x0123456789abcdef, 7);
+    seeked.Seek(position);
+    std::vector<uint64_t> rest = Draw(seeked, 23 - position);
+    EXPECT_TRUE(std::equal(rest.begin(), rest.end(), numbers.begin() + position));
+  }
+  Philox4x32 other(0x0123456789abcdef, 8);
+  other.Seek(23);
+  EXPECT_NE(Draw(philox, 4), Draw(other, 4));
+
+  // Unit conversions reach neither 1 nor below 0 from the extreme bit patterns
+  static_assert(ToUnitFloat(0) == 0.0f && ToUnitFloat(0xffffffff) < 1.0f);
+  static_assert(ToUnitDouble(0) == 0.0 && ToUnitDouble(~uint64_t{0}) < 1.0);
+  static_assert(ToUnitFloat(0x80000000) == 0.5f && ToUnitDouble(uint64_t{1} << 63) == 0.5);
+  static_assert(IsRandomEngineV<Rng> && IsRandomEngineV<Pcg32> && IsRandomEngineV<Philox4x32>);
+  static_assert(!IsRandomEngineV<double>);
+
+  // Every engine plugs into the samplers
+  Pcg32 p(1);
+  Philox4x32 q(1);
+  Rng r(1);
+  for (int i = 0; i < 1000; ++i) {
+    float f = UniformFloat(p, -1.0f, 1.0f);
+    EXPECT_TRUE(f >= -1.0f && f < 1.0f);
+    double x = SampleUniform1D(q, 2.0, 3.0);
+    EXPECT_TRUE(x >= 2.0 && x < 3.0);
+    auto [y, z] = SampleUniform2D(r);
+    EXPECT_TRUE(y >= 0.0 && y < 1.0 && z >= 0.0 && z < 1.0);
+  }
+}
+
+// Helper function to test the lanes engine and the bulk fills
+static void RandomFills()
+{
+  // Lane k steps the k-th stream split off the seed
+  Rng split(3, 1);
+  std::vector<Rng> streams;
+  for (int k = 0; k < 4; ++k) {
+    streams.push_back(split.Split());
+  }
+  Xoshiro256PlusPlusLanes<4> lanes(3, 1);
+  for (int i = 0; i < 10; ++i) {
+    uint64_t step[4];
+    lanes.Next(step);
+    for (size_t k = 0; k < 4; ++k) {
+      EXPECT_EQ(step[k], streams[k]());
+    }
+  }
+
+  // Calls hand out the steps lane after lane, the sixth number is the second of lane 1
+  Xoshiro256PlusPlusLanes<4> calls(3, 1);
+  Rng lane1(3, 1);
+  lane1.Jump();
+  lane1();
+  EXPECT_EQ(Draw(calls, 8)[5], lane1());
+
+  // Fills cover [lo, hi) evenly, the tail of a fill is the start of a longer one
+  for (size_t count : {0, 13, 16, 100000}) {
+    std::vector<double> x(count);
+    std::vector<double> longer(count + 16);
+    Xoshiro256PlusPlusLanes<8> a(5);
+    Xoshiro256PlusPlusLanes<8> b(5);
+    FillUniform(x.data(), count, -2.0, 2.0, a);
+    FillUniform(longer.data(), longer.size(), -2.0, 2.0, b);
+    EXPECT_TRUE(std::equal(x.begin(), x.end(), longer.begin()));
+
+    std::vector<float> f(count);
+    Xoshiro256PlusPlusLanes<8> c(5);
+    FillUniform(f.data(), count, 0.0f, 1.0f, c);
+    std::vector<int> bins(8, 0);
+    for (size_t i = 0; i < count; ++i) {
+      ASSERT_TRUE(x[i] >= -2.0 && x[i] < 2.0);
+      ASSERT_TRUE(f[i] >= 0.0f && f[i] < 1.0f);
+      ++bins[static_cast<size_t>((x[i] + 2.0) * 2)];
+      ++bins[static_cast<size_t>(f[i] * 8)];
+    }
+    for (int bin : bins) {
+      if (count == 100000) {
+        EXPECT_NEAR(bin / 200000.0, 0.125, 0.01);
+      }
+    }
+  }
+
+  // Points into the lanes of a batch, with the lanes engine or any other
+  TensorSoA<Vector<double, 3>> points(37);
+  Pcg32 pcg(8);
+  Xoshiro256PlusPlusLanes<2> two(8);
+  FillUniform3D(points.Lane(0), points.Lane(1), points.Lane(2), points.Size(), 1.0, 3.0, pcg);
+  FillUniform2D(points.Lane(0), points.Lane(1), points.Size(), 1.0, 3.0, two);
+  for (size_t i = 0; i < points.Size(); ++i) {
+    for (size_t c = 0; c < 3; ++c) {
+      EXPECT_TRUE(points[i][c] >= 1.0 && points[i][c] < 3.0);
+    }
+  }
+}
+
+// Helper function to test the thread streams and the samplers taking a stream
+static void RngSamplers()
+{
+  // Reseeding restarts the stream of the calling thread
+  SeedThreadRngs(9);
+  std::vector<double> x(8);
+  for (double& v : x) {
+    v = SampleUniform1D(-1.0, 1.0);
+  }
+  SeedThreadRngs(9);
+  for (double v : x) {
+    EXPECT_EQ(SampleUniform1D(-1.0, 1.0), v);
+  }
+
+  // Other threads draw from their own streams
+  std::vector<uint64_t> main = Draw(ThreadRng(), 4);
+  std::vector<uint64_t> other;
+  std::thread thread([&]() { other = Draw(ThreadRng(), 4); });
+  thread.join();
+  EXPECT_NE(main, other);
+
+  // Explicit streams make every sampler reproducible
+  NormalDistribution normal(1.0, 0.5);
+  Rng a(123);
+  Rng b(123);
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(SampleUniform2D(a, 0.0, 2.0), SampleUniform2D(b, 0.0, 2.0));
+    EXPECT_EQ(SampleUniform3D(a), SampleUniform3D(b));
+    double s = Sample1D(a, normal);
+    EXPECT_EQ(s, Sample1D(b, normal));
+    EXPECT_GE(s, normal.domainMin);
+    EXPECT_LE(s, normal.domainMax);
+  }
+  EXPECT_EQ(a, b);
+}
+
+TEST(Math, Random)
+{
+  RngStreams();
+  RandomEngines();
+  RandomFills();
+  RngSamplers();
+}
\ No newline at end of file
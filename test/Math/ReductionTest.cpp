@@ -0,0 +1,103 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <memory>
+
+#include "Matrix.h"
+#include "Reduction.h"
+#include "Tensor.h"
+#include "TensorOperations.h"
+#include "TensorView.h"
+#include "Vector.h"
+
+
+// Helper function to test the reduced dimensions and the operations
+static void Reductions()
+{
+  constexpr Matrix<int, 2, 3> m{3, -1, 4, 1, 5, -9};
+  static_assert(Sum(m) == 3);
+  static_assert(Sum<0>(m) == Vector<int, 3>{4, 4, -5});
+  static_assert(Sum<1>(m) == Vector<int, 2>{6, -3});
+  static_assert(Min(m) == -9 && Max(m) == 5);
+  static_assert(Max<0>(m) == Vector<int, 3>{3, 5, 4});
+  static_assert(ArgMax(m) == 4);
+  static_assert(ArgMax<1>(m) == Tensor<size_t, 2>{2, 1});
+  static_assert(Reduce<1>(m, std::multiplies<>{}) == Vector<int, 2>{-12, -45});
+
+  // Axes need not be adjacent, the others are kept in order
+  Tensor<double, 3, 4, 5> t;
+  for (size_t i = 0; i < 60; ++i) {
+    t[i] = static_cast<double>((i * 7) % 11) - 5.0;
+  }
+  auto outer = Sum<0, 2>(t);
+  auto middle = Max<1>(t);
+  static_assert(std::is_same_v<decltype(outer), Tensor<double, 4>>);
+  static_assert(std::is_same_v<decltype(middle), Tensor<double, 3, 5>>);
+  for (size_t j = 0; j < 4; ++j) {
+    double sum = 0.0;
+    for (size_t i = 0; i < 3; ++i) {
+      for (size_t k = 0; k < 5; ++k) {
+        sum += t(i, j, k);
+      }
+    }
+    EXPECT_EQ(outer[j], sum);
+  }
+  auto argMax = ArgMax<1>(t);
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t k = 0; k < 5; ++k) {
+      double largest = t(i, 0, k);
+      size_t index = 0;
+      for (size_t j = 1; j < 4; ++j) {
+        if (t(i, j, k) > largest) {
+          largest = t(i, j, k);
+          index = j;
+        }
+      }
+      EXPECT_EQ(middle(i, k), largest);
+      EXPECT_EQ(argMax(i, k), index);
+    }
+  }
+  EXPECT_EQ(ArgMax<2>(t)(1, 2), 1u);
+
+  // Mean and Norm of the rows of a matrix, of views and of expressions
+  Matrix<float, 2, 4> a{1, 2, 3, 4, 2, 2, 2, 2};
+  EXPECT_EQ(Mean<1>(a), (Vector<float, 2>{2.5f, 2.0f}));
+  EXPECT_EQ(Mean(a), 2.25f);
+  EXPECT_EQ(Norm<1>(a)[1], 4.0f);
+  EXPECT_FLOAT_EQ(Norm(a), std::sqrt(46.0f));
+  EXPECT_EQ(Sum(Row(a, 0)), 10.0f);
+  EXPECT_EQ(Min(Col(a, 3)), 2.0f);
+  EXPECT_EQ(Sum(a * a), 46.0f);
+}
+
+// Helper function to test the accuracy of pairwise sums over large tensors
+static void PairwiseSums()
+{
+  // A running float sum of a million tenths is off in the fourth digit
+  constexpr size_t n = 1 << 20;
+  auto v = std::make_unique<Tensor<float, n>>();
+  for (size_t i = 0; i < n; ++i) {
+    (*v)[i] = 0.1f;
+  }
+  EXPECT_NEAR(Sum(*v), 0.1 * n, 1e-6 * 0.1 * n);
+  EXPECT_NEAR(Mean(*v), 0.1f, 1e-7);
+
+  // Columns are summed row by row, rows of different parities differ
+  auto image = std::make_unique<Tensor<float, 1000, 37>>();
+  for (size_t i = 0; i < 1000 * 37; ++i) {
+    (*image)[i] = (i / 37) % 2 == 0 ? 0.1f : 0.3f;
+  }
+  auto columns = Sum<0>(*image);
+  for (size_t j = 0; j < 37; ++j) {
+    EXPECT_NEAR(columns[j], 200.0, 1e-5 * 200.0);
+  }
+  auto rows = Max<1>(*image);
+  EXPECT_EQ(rows[0], 0.1f);
+  EXPECT_EQ(rows[999], 0.3f);
+  EXPECT_EQ(ArgMax<0>(*image)[5], 1u);
+}
+
+TEST(Math, Reduction)
+{
+  Reductions();
+  PairwiseSums();
+}
\ No newline at end of file
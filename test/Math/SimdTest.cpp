@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cstdint>
+#include <gtest/gtest.h>
+
+#include "DynamicTensor.h"
+#include "Simd.h"
+#include "Tensor.h"
+#include "TensorOperations.h"
+
+
+template<typename Packet>
+static void PacketArithmetic()
+{
+  using Scalar = typename Packet::ScalarType;
+  Scalar a[Packet::width];
+  Scalar out[Packet::width];
+  for (size_t i = 0; i < Packet::width; ++i) {
+    a[i] = static_cast<Scalar>(i);
+  }
+
+  Packet p = Packet::Load(a) * Packet::Broadcast(2) + Packet::Broadcast(1);
+  p = p / Packet::Broadcast(2) - Packet::Load(a);
+  Sqrt(p * Packet::Broadcast(2)).Store(out);
+  for (size_t i = 0; i < Packet::width; ++i) {
+    EXPECT_EQ(out[i], Scalar{1});
+  }
+
+  Packet mid = Packet::Broadcast(static_cast<Scalar>(Packet::width / 2));
+  Min(Packet::Load(a), mid).Store(out);
+  for (size_t i = 0; i < Packet::width; ++i) {
+    EXPECT_EQ(out[i], std::min(a[i], static_cast<Scalar>(Packet::width / 2)));
+  }
+  Max(Packet::Load(a), mid).Store(out);
+  for (size_t i = 0; i < Packet::width; ++i) {
+    EXPECT_EQ(out[i], std::max(a[i], static_cast<Scalar>(Packet::width / 2)));
+  }
+}
+
+template<typename Packet>
+static void PacketTranspose()
+{
+  using Scalar = typename Packet::ScalarType;
+  constexpr size_t w = Packet::width;
+  Scalar block[w * w];
+  for (size_t i = 0; i < w * w; ++i) {
+    block[i] = static_cast<Scalar>(i);
+  }
+
+  Packet rows[w];
+  for (size_t i = 0; i < w; ++i) {
+    rows[i] = Packet::Load(block + i * w);
+  }
+  Packet::Transpose(rows);
+  for (size_t i = 0; i < w; ++i) {
+    Scalar row[w];
+    rows[i].Store(row);
+    for (size_t j = 0; j < w; ++j) {
+      EXPECT_EQ(row[j], block[j * w + i]);
+    }
+  }
+}
+
+// Helper function to test packet selection and arithmetic
+static void Packets()
+{
+  using namespace gtk::simd;
+
+  // Packets never hold more scalars than the tensor
+  static_assert(PacketForCount<float, 1>::width == 0);
+  static_assert(PacketForCount<float, 3>::width <= 2);
+  static_assert(PacketForCount<float, 7>::width <= 4);
+  static_assert(PacketForCount<double, 1024>::width <= 16);
+
+  // Integer division has no packet instruction
+  static_assert(!IsPacketOpV<std::divides<>, std::int32_t>);
+  static_assert(!IsPacketOpV<std::plus<>, std::int64_t>);
+
+  if constexpr (HasNativePacketV<float>) {
+    PacketArithmetic<NativePacketT<float>>();
+  }
+  if constexpr (HasNativePacketV<double>) {
+    PacketArithmetic<NativePacketT<double>>();
+  }
+
+  // Register transposes, the widest and the 4 wide ones
+  static_assert(TransposePacket<float, 3>::width <= 2);
+  if constexpr (!std::is_void_v<TransposePacketT<float>>) {
+    PacketTranspose<TransposePacketT<float>>();
+  }
+  if constexpr (!std::is_void_v<TransposePacketT<float, 4>>) {
+    PacketTranspose<TransposePacketT<float, 4>>();
+  }
+  if constexpr (!std::is_void_v<TransposePacketT<double>>) {
+    PacketTranspose<TransposePacketT<double>>();
+  }
+  if constexpr (!std::is_void_v<TransposePacketT<std::int32_t>>) {
+    PacketTranspose<TransposePacketT<std::int32_t>>();
+  }
+}
+
+// Helper function to test that packet evaluation matches element by element evaluation
+static void VectorizedEvaluation()
+{
+  // Sizes that are not a multiple of any packet width exercise the narrower tails
+  {
+    Tensor<float, 19> a;
+    Tensor<float, 19> b;
+    for (size_t i = 0; i < 19; ++i) {
+      a[i] = static_cast<float>(i);
+      b[i] = static_cast<float>(19 - i);
+    }
+
+    auto expr = (a * b + a) / 2.0f - b;
+    static_assert(IsVectorizableV<decltype(expr), float> == gtk::simd::HasNativePacketV<float>);
+    Tensor<float, 19> result = expr;
+    for (size_t i = 0; i < 19; ++i) {
+      EXPECT_EQ(result[i], expr[i]);
+    }
+  }
+
+  // Mixed scalar operands are converted before being broadcast to a packet
+  {
+    Tensor<double, 4, 4> m;
+    for (size_t i = 0; i < 16; ++i) {
+      m[i] = 0.5 * static_cast<double>(i);
+    }
+
+    auto expr = m * 2 + 1.0f;
+    static_assert(IsVectorizableV<decltype(expr), double> == gtk::simd::HasNativePacketV<double>);
+    Tensor<double, 4, 4> result = expr;
+    for (size_t i = 0; i < 16; ++i) {
+      EXPECT_EQ(result[i], static_cast<double>(i) + 1.0);
+    }
+  }
+
+  // Integer expressions, division stays on the scalar path
+  {
+    Tensor<int, 3, 5> a;
+    for (size_t i = 0; i < 15; ++i) {
+      a[i] = static_cast<int>(i);
+    }
+
+    Tensor<int, 3, 5> result = a * a - 3;
+    Tensor<int, 3, 5> quotient = a / 2;
+    static_assert(!IsVectorizableV<decltype(a / 2), int>);
+    for (size_t i = 0; i < 15; ++i) {
+      int x = static_cast<int>(i);
+      EXPECT_EQ(result[i], x * x - 3);
+      EXPECT_EQ(quotient[i], x / 2);
+    }
+  }
+
+  // Dynamic tensors vectorize the innermost axis and broadcast rows and columns
+  {
+    DynamicTensor<float> m({37, 21});
+    DynamicTensor<float> col({37, 1});
+    Tensor<float, 21> row;
+    for (size_t i = 0; i < m.Count(); ++i) {
+      m[i] = static_cast<float>(i % 13);
+    }
+    for (size_t i = 0; i < 37; ++i) {
+      col[i] = static_cast<float>(i);
+    }
+    for (size_t j = 0; j < 21; ++j) {
+      row[j] = static_cast<float>(j) * 0.25f;
+    }
+
+    DynamicTensor<float> result = m * row + col;
+    for (size_t i = 0; i < 37; ++i) {
+      for (size_t j = 0; j < 21; ++j) {
+        EXPECT_EQ(result(i, j), m(i, j) * row[j] + col[i]);
+      }
+    }
+
+    DynamicTensor<float> flat = m * m - 1.0f;
+    for (size_t i = 0; i < m.Count(); ++i) {
+      EXPECT_EQ(flat[i], m[i] * m[i] - 1.0f);
+    }
+  }
+}
+
+TEST(Math, Simd)
+{
+  Packets();
+  VectorizedEvaluation();
+}
\ No newline at end of file
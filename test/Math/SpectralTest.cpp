@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "Matrix.h"
+#include "Spectral.h"
+#include "Vector.h"
+
+
+template<typename S, size_t n>
+static Matrix<S, n, n> Transpose(const Matrix<S, n, n>& m)
+{
+  Matrix<S, n, n> t;
+  for (size_t i = 0; i < n; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      t(i, j) = m(j, i);
+    }
+  }
+  return t;
+}
+
+template<typename S, size_t n>
+static Matrix<S, n, n> Diagonal(const Vector<S, n>& d)
+{
+  Matrix<S, n, n> m{};
+  for (size_t i = 0; i < n; ++i) {
+    m(i, i) = d[i];
+  }
+  return m;
+}
+
+template<typename S, size_t n>
+static void ExpectMatrixNear(const Matrix<S, n, n>& a, const Matrix<S, n, n>& b, S epsilon)
+{
+  for (size_t i = 0; i < n * n; ++i) {
+    EXPECT_NEAR(a[i], b[i], epsilon);
+  }
+}
+
+template<typename S, size_t n>
+static void ExpectOrthogonal(const Matrix<S, n, n>& m, S epsilon)
+{
+  Matrix<S, n, n> identity{};
+  for (size_t i = 0; i < n; ++i) {
+    identity(i, i) = 1;
+  }
+  ExpectMatrixNear(Mul(Transpose(m), m), identity, epsilon);
+}
+
+template<typename S, size_t n>
+static void ExpectSvd(const Matrix<S, n, n>& m, S epsilon)
+{
+  auto svd = Svd(m);
+  ExpectOrthogonal(svd.u, epsilon);
+  ExpectOrthogonal(svd.v, epsilon);
+  ExpectMatrixNear(Mul(svd.u, Diagonal(svd.singularValues), Transpose(svd.v)), m, epsilon);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    EXPECT_GE(svd.singularValues[i], svd.singularValues[i + 1]);
+  }
+  EXPECT_GE(svd.singularValues[n - 1], S{0});
+}
+
+// Helper function to test symmetric eigen decompositions
+static void SymmetricEigen()
+{
+  // A covariance like matrix
+  {
+    Matrix<double, 3, 3> m(4.0, 1.0, -2.0, 1.0, 3.0, 0.5, -2.0, 0.5, 5.0);
+    auto eigen = Eigen(m);
+    ExpectOrthogonal(eigen.vectors, 1e-12);
+    auto back = Mul(eigen.vectors, Diagonal(eigen.values), Transpose(eigen.vectors));
+    ExpectMatrixNear(back, m, 1e-12);
+    EXPECT_GE(eigen.values[0], eigen.values[1]);
+    EXPECT_GE(eigen.values[1], eigen.values[2]);
+    EXPECT_NEAR(eigen.values[0] + eigen.values[1] + eigen.values[2], 12.0, 1e-12);
+  }
+
+  // Diagonal and repeated eigenvalues need no rotation
+  {
+    auto eigen = Eigen(Matrix<float, 3, 3>(1.0f, 0.0f, 0.0f, 0.0f, 3.0f, 0.0f, 0.0f, 0.0f, 3.0f));
+    EXPECT_EQ(eigen.values, (Vector<float, 3>(3.0f, 3.0f, 1.0f)));
+    ExpectOrthogonal(eigen.vectors, 0.0f);
+
+    auto zero = Eigen(Matrix<float, 3, 3>{});
+    EXPECT_EQ(zero.values, (Vector<float, 3>(0.0f, 0.0f, 0.0f)));
+  }
+
+  // Batches
+  {
+    std::vector<Matrix<float, 3, 3>> m(20);
+    for (size_t k = 0; k < m.size(); ++k) {
+      float x = static_cast<float>(k);
+      m[k] = Matrix<float, 3, 3>(x, 1.0f, 0.0f, 1.0f, 2.0f, x, 0.0f, x, -x);
+    }
+    std::vector<SymmetricEigen3<float>> out(m.size());
+    EigenBatch(m.data(), m.size(), out.data());
+    for (size_t k = 0; k < m.size(); ++k) {
+      EXPECT_EQ(out[k].values, Eigen(m[k]).values);
+      auto back = Mul(out[k].vectors, Diagonal(out[k].values), Transpose(out[k].vectors));
+      ExpectMatrixNear(back, m[k], 1e-4f * (1.0f + static_cast<float>(k)));
+    }
+  }
+}
+
+// Helper function to test singular value decompositions
+static void SingularValues()
+{
+  ExpectSvd(Matrix<double, 1, 1>(-3.0), 1e-12);
+  ExpectSvd(Matrix<double, 2, 2>(1.0, 2.0, 3.0, 4.0), 1e-12);
+  ExpectSvd(Matrix<double, 3, 3>(2.0, -1.0, 0.5, 0.0, 3.0, 1.0, 4.0, 0.0, -2.0), 1e-12);
+  ExpectSvd(Matrix<double, 4, 4>(1, 2, 3, 4, 0, 1, 0, 1, 5, -1, 2, 0, 3, 3, 3, 1), 1e-12);
+  ExpectSvd(Matrix<float, 3, 3>(1.0f, 0.5f, 0.0f, 0.5f, 2.0f, 1.0f, 0.0f, 1.0f, 3.0f), 1e-5f);
+
+  // Rank deficient matrices still get orthogonal factors
+  {
+    Matrix<double, 3, 3> rankOne(1.0, 2.0, 3.0, 2.0, 4.0, 6.0, -1.0, -2.0, -3.0);
+    ExpectSvd(rankOne, 1e-12);
+    auto svd = Svd(rankOne);
+    EXPECT_NEAR(svd.singularValues[1], 0.0, 1e-12);
+    ExpectSvd(Matrix<double, 4, 4>{}, 1e-12);
+  }
+
+  // Batches
+  {
+    std::vector<Matrix<double, 2, 2>> m = {
+      Matrix<double, 2, 2>(1.0, 2.0, 3.0, 4.0), Matrix<double, 2, 2>(0.0, 1.0, -1.0, 0.0)
+    };
+    std::vector<SingularValueDecomposition<double, 2>> out(2);
+    SvdBatch(m.data(), m.size(), out.data());
+    EXPECT_EQ(out[0].singularValues, Svd(m[0]).singularValues);
+    EXPECT_NEAR(out[1].singularValues[0], 1.0, 1e-15);
+    EXPECT_NEAR(out[1].singularValues[1], 1.0, 1e-15);
+  }
+}
+
+TEST(Math, Spectral)
+{
+  SymmetricEigen();
+  SingularValues();
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include <cmath>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+#include "Random.h"
+#include "Sample.h"
+#include "TabulatedSampler1D.h"
+
+
+// f(x) = x / 2 on [0, 2], its quantiles are 2 sqrt(u)
+struct RampDistribution : public ProbabilityDensityFunction1D {
+  RampDistribution() : ProbabilityDensityFunction1D(0.0, 2.0, 2.0) {}
+
+  double operator()(double x) const override { return x / 2; }
+};
+
+// -1 on the whole domain
+struct NegativeDistribution : public ProbabilityDensityFunction1D {
+  NegativeDistribution() : ProbabilityDensityFunction1D(0.0, 1.0, 0.5) {}
+
+  double operator()(double) const override { return -1.0; }
+};
+
+// Quantile of a NormalDistribution, truncated to its domain, by bisection of the CDF
+static double NormalQuantile(const NormalDistribution& normal, double u)
+{
+  auto cdf = [&](double x) {
+    return 0.5 * std::erfc(-(x - normal.mu) / (normal.sigma * std::sqrt(2.0)));
+  };
+  double lo = normal.domainMin;
+  double hi = normal.domainMax;
+  double target = cdf(lo) + u * (cdf(hi) - cdf(lo));
+  for (int i = 0; i < 100; ++i) {
+    double mid = (lo + hi) / 2;
+    (cdf(mid) < target ? lo : hi) = mid;
+  }
+  return lo;
+}
+
+// Helper function to test the quantiles and the density of the tables against exact ones
+static void TabulatedQuantiles()
+{
+  // Simpson's rule integrates the ramp exactly, the error is the linear interpolation in a bin
+  {
+    TabulatedSampler1D sampler(RampDistribution{}, 1024);
+    EXPECT_EQ(sampler.Resolution(), 1024u);
+    double binWidth = 2.0 / 1024;
+    for (double u = 0.0; u < 1.0; u += 0.01) {
+      EXPECT_NEAR(sampler.Quantile(u), 2 * std::sqrt(u), binWidth);
+    }
+    EXPECT_EQ(sampler.Quantile(0.0), 0.0);
+    EXPECT_EQ(sampler.Pdf(-0.5), 0.0);
+    EXPECT_EQ(sampler.Pdf(2.5), 0.0);
+    EXPECT_NEAR(sampler.Pdf(1.0), 0.5, binWidth);
+  }
+
+  // A narrow peak, finer tables are more accurate
+  NormalDistribution normal(0.5, 0.001);
+  double coarse = 0.0;
+  double fine = 0.0;
+  TabulatedSampler1D coarseSampler(normal, 16);
+  TabulatedSampler1D fineSampler(normal, 4096);
+  for (double u = 0.005; u < 1.0; u += 0.01) {
+    double exact = NormalQuantile(normal, u);
+    coarse = std::max(coarse, std::abs(coarseSampler.Quantile(u) - exact));
+    fine = std::max(fine, std::abs(fineSampler.Quantile(u) - exact));
+  }
+  EXPECT_LT(fine, 1e-6);
+  EXPECT_LT(fine * 100, coarse);
+
+  // The density, constant in every bin, integrates to 1
+  double mass = 0.0;
+  double binWidth = (normal.domainMax - normal.domainMin) / 4096;
+  for (int j = 0; j < 4096; ++j) {
+    mass += fineSampler.Pdf(normal.domainMin + (j + 0.5) * binWidth) * binWidth;
+  }
+  EXPECT_NEAR(mass, 1.0, 1e-9);
+}
+
+// Helper function to test single and batch samples and invalid tables
+static void TabulatedSampling()
+{
+  NormalDistribution normal(2.0, 0.25);
+  TabulatedSampler1D sampler(normal, 256);
+
+  // Batches draw the same points as single samples from the same stream
+  Rng a(6);
+  Rng b(6);
+  std::vector<double> batch(1000);
+  sampler.SampleBatch(batch.data(), batch.size(), a);
+  for (double x : batch) {
+    EXPECT_EQ(x, sampler.Sample(b));
+  }
+
+  // The moments of a large batch from the lanes engine
+  Xoshiro256PlusPlusLanes<8> lanes(6);
+  std::vector<double> x(1000000);
+  sampler.SampleBatch(x.data(), x.size(), lanes);
+  double mean = 0.0;
+  double squares = 0.0;
+  for (double v : x) {
+    ASSERT_TRUE(v >= normal.domainMin && v <= normal.domainMax);
+    mean += v / x.size();
+    squares += v * v / x.size();
+  }
+  // 3 sigma truncation shrinks the standard deviation by 1.4%
+  EXPECT_NEAR(mean, 2.0, 1e-3);
+  EXPECT_NEAR(std::sqrt(squares - mean * mean), 0.25 * 0.9866, 1e-3);
+
+  EXPECT_THROW(TabulatedSampler1D(normal, 0), std::invalid_argument);
+  EXPECT_THROW(TabulatedSampler1D(NegativeDistribution{}), std::invalid_argument);
+}
+
+TEST(Math, TabulatedSampler1D)
+{
+  TabulatedQuantiles();
+  TabulatedSampling();
+}
\ No newline at end of file
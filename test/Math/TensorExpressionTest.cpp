@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include "Tensor.h"
+#include "TensorExpression.h"
+#include "TensorOperations.h"
+
+
+// Helper function to test that operators build nodes and evaluate on assignment
+static void LazyEvaluation()
+{
+  // Operators return expression nodes carrying the broadcast dimension
+  {
+    Tensor<float, 2, 2> a(1.0f, 2.0f, 3.0f, 4.0f);
+    Tensor<float, 2, 2> b(5.0f, 6.0f, 7.0f, 8.0f);
+
+    auto expr = a * b + a;
+    static_assert(IsTensorExprClassV<decltype(expr)>);
+    static_assert(std::is_same_v<decltype(expr)::DimensionType, TDimension<2, 2>>);
+    static_assert(std::is_same_v<decltype(expr)::ScalarType, float>);
+
+    Tensor<float, 2, 2> result = expr;
+    EXPECT_EQ(result, (Tensor<float, 2, 2>(6.0f, 14.0f, 24.0f, 36.0f)));
+  }
+
+  // Expressions are evaluated against the current values of the referenced tensors
+  {
+    Tensor<int, 3> a(1, 2, 3);
+    Tensor<int, 3> b(1, 1, 1);
+    auto expr = a + b;
+    a[0] = 10;
+    EXPECT_EQ(expr[0], 11);
+    EXPECT_EQ(expr.Eval(), (Tensor<int, 3>(11, 3, 4)));
+  }
+
+  // Temporaries are held by value inside the nodes
+  {
+    Tensor<int, 2> a(1, 2);
+    auto expr = a * Tensor<int, 2>(3, 4) - (a + a);
+    Tensor<int, 2> result = expr;
+    EXPECT_EQ(result, (Tensor<int, 2>(1, 4)));
+  }
+
+  // Assignment evaluates in place
+  {
+    Tensor<double, 4> a(1.0, 2.0, 3.0, 4.0);
+    Tensor<double, 4> b(4.0, 3.0, 2.0, 1.0);
+    Tensor<double, 4> c;
+    c = a * b + b * a;
+    EXPECT_EQ(c, (Tensor<double, 4>(8.0, 12.0, 12.0, 8.0)));
+
+    a = a + a;
+    EXPECT_EQ(a, (Tensor<double, 4>(2.0, 4.0, 6.0, 8.0)));
+  }
+}
+
+// Helper function to test broadcasting inside expressions
+static void ExpressionBroadcasting()
+{
+  // Row broadcast against a matrix
+  {
+    Tensor<float, 2, 3> m(1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f);
+    Tensor<float, 1, 3> row(10.0f, 20.0f, 30.0f);
+    Tensor<float, 2, 3> result = m + row;
+    EXPECT_EQ(result, (Tensor<float, 2, 3>(11.0f, 22.0f, 33.0f, 14.0f, 25.0f, 36.0f)));
+  }
+
+  // Lower rank operand broadcast against a higher rank one
+  {
+    Tensor<int, 2, 3> m(1, 2, 3, 4, 5, 6);
+    Tensor<int, 3> v(1, 2, 3);
+    Tensor<int, 2, 3> result = v * m;
+    EXPECT_EQ(result, (Tensor<int, 2, 3>(1, 4, 9, 4, 10, 18)));
+  }
+
+  // Nested expressions of different dimensions
+  {
+    Tensor<int, 2, 2> m(1, 2, 3, 4);
+    Tensor<int, 1, 2> row(1, 2);
+    Tensor<int, 2, 2> result = (row + row) * m + 1;
+    EXPECT_EQ(result, (Tensor<int, 2, 2>(3, 9, 7, 17)));
+  }
+}
+
+static void StaticConstexprExpressions()
+{
+  constexpr Tensor<int, 2, 2> a(1, 2, 3, 4);
+  constexpr Tensor<int, 2, 2> b(4, 3, 2, 1);
+
+  constexpr Tensor<int, 2, 2> sum = a + b;
+  static_assert(sum(0, 0) == 5 && sum(1, 1) == 5);
+
+  constexpr Tensor<int, 2, 2> fused = a * b + a * 2;
+  static_assert(fused[0] == 6 && fused[1] == 10 && fused[2] == 12 && fused[3] == 12);
+
+  constexpr Tensor<int, 2, 2> broadcast = a + Tensor<int, 1, 2>(10, 20);
+  static_assert(broadcast(1, 0) == 13 && broadcast(1, 1) == 24);
+
+  constexpr int scalar = Tensor<int, 1>(3) * 4;
+  static_assert(scalar == 12);
+}
+
+TEST(Math, TensorExpression)
+{
+  LazyEvaluation();
+  ExpressionBroadcasting();
+  StaticConstexprExpressions();
+}
\ No newline at end of file
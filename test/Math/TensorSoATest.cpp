@@ -0,0 +1,199 @@
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "Tensor.h"
+#include "TensorOperations.h"
+#include "TensorSoA.h"
+#include "Vector.h"
+
+
+// Helper function to test storage, growth and proxy references
+static void TensorSoABasics()
+{
+  // Components are stored in separate aligned lanes
+  {
+    TensorSoA<Vector<float, 3>> points(5, Vector<float, 3>(1.0f, 2.0f, 3.0f));
+    EXPECT_EQ(points.Size(), 5);
+    EXPECT_EQ(points.PaddedSize(), 16);
+    for (size_t c = 0; c < 3; ++c) {
+      auto address = reinterpret_cast<std::uintptr_t>(points.Lane(c));
+      EXPECT_EQ(address % dynamicTensorAlignment, 0);
+      for (size_t i = 0; i < 5; ++i) {
+        EXPECT_EQ(points.Lane(c)[i], static_cast<float>(c + 1));
+      }
+    }
+  }
+
+  // Proxies read, write and convert like the tensor
+  {
+    TensorSoA<Tensor<int, 2, 2>> batch(3);
+    batch[1] = Tensor<int, 2, 2>(1, 2, 3, 4);
+    batch[2](1, 0) = 7;
+
+    Tensor<int, 2, 2> second = batch[1];
+    EXPECT_EQ(second, (Tensor<int, 2, 2>(1, 2, 3, 4)));
+    EXPECT_EQ(batch.Lane(2)[2], 7);
+
+    batch[0] = batch[1];
+    batch[1](0, 0) = 10;
+    EXPECT_EQ(batch[0].Eval(), (Tensor<int, 2, 2>(1, 2, 3, 4)));
+
+    // Proxies are tensor operands
+    Tensor<int, 2, 2> sum = batch[0] + batch[1] * 2;
+    EXPECT_EQ(sum, (Tensor<int, 2, 2>(21, 6, 9, 12)));
+    batch[2] = batch[0] + 1;
+    EXPECT_EQ(batch[2].Eval(), (Tensor<int, 2, 2>(2, 3, 4, 5)));
+  }
+
+  // Growth keeps elements, iteration visits proxies
+  {
+    TensorSoA<Vector<double, 2>> batch;
+    for (int i = 0; i < 100; ++i) {
+      batch.PushBack(Vector<double, 2>(i, -i));
+    }
+    EXPECT_EQ(batch.Size(), 100);
+    EXPECT_GE(batch.Capacity(), 100);
+
+    double total = 0.0;
+    for (auto v : batch) {
+      total += v[0] + 2.0 * v[1];
+    }
+    EXPECT_EQ(total, -4950.0);
+
+    TensorSoA<Vector<double, 2>> copy = batch;
+    EXPECT_EQ(copy, batch);
+    copy[99][0] = 0.0;
+    EXPECT_NE(copy, batch);
+  }
+
+  // Whole arrays convert by transposes, padded elements skip their padding
+  {
+    std::vector<Vector<float, 4>> colors(1001);
+    std::vector<BasicTensor<float, PaddedTo<4>, 3>> padded(1001);
+    for (size_t i = 0; i < colors.size(); ++i) {
+      float x = static_cast<float>(i);
+      colors[i] = Vector<float, 4>(x, -x, 2.0f * x, 1.0f);
+      padded[i] = BasicTensor<float, PaddedTo<4>, 3>(x, x + 1.0f, x + 2.0f);
+    }
+
+    TensorSoA<Vector<float, 4>> colorLanes(colors.data(), colors.size());
+    TensorSoA<BasicTensor<float, PaddedTo<4>, 3>> paddedLanes(padded.data(), padded.size());
+    ASSERT_EQ(colorLanes.Size(), 1001);
+    for (size_t i = 0; i < colors.size(); ++i) {
+      EXPECT_EQ(colorLanes[i].Eval(), colors[i]);
+      EXPECT_EQ(paddedLanes[i].Eval(), padded[i]);
+    }
+
+    std::vector<Vector<float, 4>> back(1001);
+    colorLanes.CopyTo(back.data());
+    EXPECT_EQ(back, colors);
+    std::vector<BasicTensor<float, PaddedTo<4>, 3>> paddedBack(1001);
+    paddedLanes.CopyTo(paddedBack.data());
+    EXPECT_EQ(paddedBack, padded);
+
+    TensorSoA<Vector<float, 4>> empty(colors.data(), 0);
+    EXPECT_TRUE(empty.Empty());
+  }
+}
+
+// Helper function to test operations across whole batches
+static void TensorSoAOperations()
+{
+  TensorSoA<Vector<float, 3>> a;
+  TensorSoA<Vector<float, 3>> b;
+  for (int i = 0; i < 37; ++i) {
+    float x = static_cast<float>(i);
+    a.PushBack(Vector<float, 3>(x, 1.0f, 2.0f * x));
+    b.PushBack(Vector<float, 3>(1.0f, x, -x));
+  }
+
+  // Componentwise operators between batches, tensors and scalars
+  {
+    auto sum = a + b;
+    auto scaled = a * 2.0f - Vector<float, 3>(1.0f, 2.0f, 3.0f);
+    auto ratio = 1.0f / (b + 1.0f);
+    static_assert(std::is_same_v<decltype(sum), TensorSoA<Vector<float, 3>>>);
+    for (size_t i = 0; i < 37; ++i) {
+      Vector<float, 3> ai = a[i];
+      Vector<float, 3> bi = b[i];
+      EXPECT_EQ(sum[i].Eval(), (ai + bi).Eval());
+      EXPECT_EQ(scaled[i].Eval(), (ai * 2.0f - Vector<float, 3>(1.0f, 2.0f, 3.0f)).Eval());
+      EXPECT_EQ(ratio[i].Eval(), (1.0f / (bi + 1.0f)).Eval());
+    }
+
+    TensorSoA<Vector<float, 3>> other(36);
+    EXPECT_THROW(a + other, std::invalid_argument);
+  }
+
+  // Single component batches broadcast against every component of the other operand
+  {
+    TensorSoA<Tensor<float, 1>> weights;
+    for (int i = 0; i < 5; ++i) {
+      weights.PushBack(Tensor<float, 1>(static_cast<float>(i)));
+    }
+    Vector<float, 3> v(1.0f, -2.0f, 0.5f);
+    auto scaled = weights * v;
+    auto shifted = TensorSoA<Vector<float, 3>>(5, v) + weights;
+    EXPECT_EQ(scaled.Size(), 5);
+    for (size_t i = 0; i < 5; ++i) {
+      float w = static_cast<float>(i);
+      EXPECT_EQ(scaled[i].Eval(), (Vector<float, 3>(w, -2.0f * w, 0.5f * w)));
+      EXPECT_EQ(shifted[i].Eval(), (Vector<float, 3>(1.0f + w, w - 2.0f, 0.5f + w)));
+    }
+  }
+
+  // Dot and Cross of every element, against a batch or a single vector
+  {
+    auto dots = Dot(a, b);
+    auto cross = Cross(a, b);
+    auto light = Dot(a, Vector<float, 3>(0.0f, 1.0f, 0.0f));
+    EXPECT_EQ(dots.Shape(), (DynamicShape{37}));
+    for (size_t i = 0; i < 37; ++i) {
+      Vector<float, 3> ai = a[i];
+      Vector<float, 3> bi = b[i];
+      EXPECT_EQ(dots[i], Dot(ai, bi));
+      EXPECT_EQ(cross[i].Eval(), Cross(ai, bi));
+      EXPECT_EQ(light[i], 1.0f);
+    }
+  }
+
+  // Lengths and normalization in place
+  {
+    TensorSoA<Vector<float, 3>> v = a + Vector<float, 3>(1.0f, 0.0f, 0.0f);
+    auto lengths = LengthBatch(v);
+    NormalizeBatch(v);
+    for (size_t i = 0; i < 37; ++i) {
+      Vector<float, 3> vi = (a[i] + Vector<float, 3>(1.0f, 0.0f, 0.0f)).Eval();
+      EXPECT_NEAR(lengths[i], Length(vi), 1e-4f);
+      Vector<float, 3> ni = Normalize(vi);
+      for (size_t c = 0; c < 3; ++c) {
+        EXPECT_NEAR(v[i][c], ni[c], 1e-6f);
+      }
+    }
+  }
+
+  // Integer batches
+  {
+    TensorSoA<Vector<int, 3>> v(20, Vector<int, 3>(1, 2, 3));
+    auto doubled = v * 2 + v;
+    auto halved = v / 2;
+    EXPECT_EQ(doubled[19].Eval(), (Vector<int, 3>(3, 6, 9)));
+    EXPECT_EQ(halved[0].Eval(), (Vector<int, 3>(0, 1, 1)));
+    EXPECT_EQ(Dot(v, v)[7], 14);
+
+    // The zero padding of the divisor is never divided by
+    TensorSoA<Vector<int, 3>> a({Vector<int, 3>(7, 8, 9), Vector<int, 3>(-6, 5, 4)});
+    TensorSoA<Vector<int, 3>> b({Vector<int, 3>(2, 4, 3), Vector<int, 3>(3, -5, 2)});
+    auto quotient = a / b;
+    EXPECT_EQ(quotient.Size(), 2);
+    EXPECT_EQ(quotient[0].Eval(), (Vector<int, 3>(3, 2, 3)));
+    EXPECT_EQ(quotient[1].Eval(), (Vector<int, 3>(-2, -1, 2)));
+  }
+}
+
+TEST(Math, TensorSoA)
+{
+  TensorSoABasics();
+  TensorSoAOperations();
+}
\ No newline at end of file
@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <gtest/gtest.h>
 
 #include "Dimension.h"
@@ -405,6 +406,41 @@ static void TensorBroadcasting()
     EXPECT_EQ(rowToMatrix(1, 1), 2);
     EXPECT_EQ(rowToMatrix(1, 2), 3);
   }
+
+  // Broadcasting a lower rank tensor keeps its values along the trailing axes
+  {
+    Tensor<int, 3> vec(1, 2, 3);
+    auto broadcasted = Broadcast<TDimension<2, 3>>(vec);
+    EXPECT_EQ(broadcasted, (Tensor<int, 2, 3>(1, 2, 3, 1, 2, 3)));
+
+    Tensor<int, 2, 1> col(4, 5);
+    auto colToMatrix = Broadcast<TDimension<2, 3>>(col);
+    EXPECT_EQ(colToMatrix, (Tensor<int, 2, 3>(4, 4, 4, 5, 5, 5)));
+  }
+
+  // Broadcast views read the source in place
+  {
+    Tensor<float, 1, 4> row(1.0f, 2.0f, 3.0f, 4.0f);
+    auto view = MakeBroadcastView<TDimension<1024, 4>>(row);
+    static_assert(std::is_same_v<decltype(view)::DimensionType, TDimension<1024, 4>>);
+    static_assert(!decltype(view)::isFlat);
+    EXPECT_EQ(view(0, 0), 1.0f);
+    EXPECT_EQ(view(1023, 3), 4.0f);
+    EXPECT_EQ(view[4 * 517 + 2], 3.0f);
+    EXPECT_EQ(&view(517, 1), &row[1]);
+
+    row[1] = 20.0f;
+    EXPECT_EQ(view(3, 1), 20.0f);
+
+    Tensor<float, 1024, 4> image;
+    for (size_t i = 0; i < decltype(image)::count; ++i) {
+      image[i] = static_cast<float>(i);
+    }
+    Tensor<float, 1024, 4> sum = image + view;
+    EXPECT_EQ(sum(0, 0), 1.0f);
+    EXPECT_EQ(sum(1, 1), 25.0f);
+    EXPECT_EQ(sum(1023, 3), 4095.0f + 4.0f);
+  }
 }
 
 // Helper function to test tensor operations
@@ -504,6 +540,58 @@ static void TensorOperations()
   }
 }
 
+// Helper function to test aligned and padded storage policies
+static void TensorStorage()
+{
+  using Vec3 = BasicTensor<float, PaddedTo<4>, 3>;
+  using AlignedVec3 = BasicTensor<float, Aligned<32>, 3>;
+
+  // Layout changes, logical elements do not
+  static_assert(Vec3::count == 3 && Vec3::storedCount == 4);
+  static_assert(sizeof(Vec3) == 16 && alignof(Vec3) == 16);
+  static_assert(AlignedVec3::storedCount == 3 && alignof(AlignedVec3) == 32);
+  static_assert(BasicTensor<double, PaddedTo<3>, 4>::storedCount == 6);
+  static_assert(alignof(BasicTensor<double, PaddedTo<3>, 4>) == alignof(double));
+  static_assert(sizeof(Tensor<float, 3>) == 12);
+
+  // Iteration and comparisons only see logical elements
+  {
+    Vec3 v(1.0f, 2.0f, 3.0f);
+    EXPECT_EQ(v.data[3], 0.0f);
+    EXPECT_EQ(std::distance(v.begin(), v.end()), 3);
+    EXPECT_EQ(*v.rbegin(), 3.0f);
+
+    v.data[3] = 42.0f;
+    EXPECT_EQ(v, (Vec3(1.0f, 2.0f, 3.0f)));
+    EXPECT_EQ(v, (Tensor<float, 3>(1.0f, 2.0f, 3.0f)));
+    EXPECT_EQ(v, (AlignedVec3(1.0f, 2.0f, 3.0f)));
+
+    AlignedVec3 a = v;
+    auto address = reinterpret_cast<std::uintptr_t>(&a[0]);
+    EXPECT_EQ(address % 32, 0);
+  }
+
+  // Expressions mixing storage policies, padded operands are evaluated a lane at a time
+  {
+    Vec3 a(1.0f, 2.0f, 3.0f);
+    Vec3 b(4.0f, 5.0f, 6.0f);
+    Tensor<float, 3> c(1.0f, 1.0f, 1.0f);
+
+    static_assert(decltype(a * b + a)::laneCount == 4);
+    static_assert(decltype(a * b + c)::laneCount == 3);
+
+    Vec3 lanes = a * b + a * 2.0f;
+    EXPECT_EQ(lanes, (Tensor<float, 3>(6.0f, 14.0f, 24.0f)));
+
+    Tensor<float, 3> packed = a * b - c;
+    EXPECT_EQ(packed, (Tensor<float, 3>(3.0f, 9.0f, 17.0f)));
+
+    constexpr BasicTensor<int, PaddedTo<4>, 2, 3> m(1, 2, 3, 4, 5, 6);
+    constexpr BasicTensor<int, PaddedTo<4>, 2, 3> sum = m + m;
+    static_assert(sum(1, 2) == 12 && sum.data[7] == 0);
+  }
+}
+
 // Helper function to test edge cases and special scenarios
 static void EdgeCases()
 {
@@ -872,6 +960,7 @@ TEST(Math, Tensor)
   ImplicitConversions();
   TensorBroadcasting();
   TensorOperations();
+  TensorStorage();
   EdgeCases();
   
   // Compile-time tests for Tensor utilities
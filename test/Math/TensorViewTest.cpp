@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "Matrix.h"
+#include "Tensor.h"
+#include "TensorOperations.h"
+#include "TensorView.h"
+#include "Vector.h"
+
+
+// Helper function to test row, column and slice views reading and writing in place
+static void Views()
+{
+  // Rows are contiguous, columns are strided, both reference the matrix
+  {
+    Matrix<float, 3, 4> m{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    static_assert(decltype(Row(m, 0))::isContiguous);
+    static_assert(!decltype(Col(m, 0))::isContiguous);
+    static_assert(std::is_same_v<decltype(Col(m, 0))::DimensionType, TDimension<3>>);
+
+    EXPECT_EQ(Row(m, 1).Eval(), (Vector<float, 4>{4, 5, 6, 7}));
+    EXPECT_EQ(Col(m, 2).Eval(), (Vector<float, 3>{2, 6, 10}));
+    EXPECT_EQ(Row(m, 2)[1], 9.0f);
+
+    Col(m, 0)[1] = -4.0f;
+    EXPECT_EQ(m(1, 0), -4.0f);
+
+    // Componentwise operators take views as operands and assign through them
+    Vector<float, 4> sum = Row(m, 0) + Row(m, 2);
+    EXPECT_EQ(sum, (Vector<float, 4>{8, 10, 12, 14}));
+    Row(m, 0) = Row(m, 1) * 2.0f;
+    EXPECT_EQ(Row(m, 0).Eval(), (Vector<float, 4>{-8, 10, 12, 14}));
+    Col(m, 3) = Col(m, 3) - Col(m, 1);
+    EXPECT_EQ(Col(m, 3).Eval(), (Vector<float, 3>{4, 2, 2}));
+
+    // Single elements are broadcast, views of const matrices only read
+    Row(m, 1) = Tensor<float, 1>{0.0f};
+    EXPECT_EQ(Row(m, 1).Eval(), (Vector<float, 4>{}));
+    const Matrix<float, 3, 4>& constant = m;
+    EXPECT_EQ(Col(constant, 1).Eval(), (Vector<float, 3>{10, 0, 9}));
+  }
+
+  // One channel of an image, without copying the other channels
+  {
+    Tensor<float, 2, 3, 4> image;
+    for (size_t i = 0; i < 24; ++i) {
+      image[i] = static_cast<float>(i);
+    }
+    auto alpha = Slice<2>(image, 3);
+    static_assert(std::is_same_v<decltype(alpha)::DimensionType, TDimension<2, 3>>);
+    EXPECT_EQ(alpha(1, 2), 23.0f);
+
+    Tensor<float, 2, 3> opaque = alpha * 0.0f + 1.0f;
+    Slice<2>(image, 0) = Slice<2>(image, 0) * opaque + Slice<2>(image, 1);
+    EXPECT_EQ(image(1, 1, 0), 16.0f + 17.0f);
+    EXPECT_EQ(image(1, 1, 1), 17.0f);
+
+    // Slices along the first axis are contiguous
+    auto plane = Slice<0>(image, 1);
+    static_assert(decltype(plane)::isContiguous);
+    EXPECT_EQ(plane(2, 3), 23.0f);
+  }
+}
+
+// Helper function to test blocks and products of views
+static void SubTensors()
+{
+  Matrix<double, 6, 6> m;
+  for (size_t i = 0; i < 36; ++i) {
+    m[i] = static_cast<double>(i % 7) - 3.0;
+  }
+
+  auto block = SubTensor<2, 3>(m, 1, 2);
+  EXPECT_EQ(block(0, 0), m(1, 2));
+  EXPECT_EQ(block(1, 2), m(2, 4));
+  Matrix<double, 2, 3> expected{m(1, 2), m(1, 3), m(1, 4), m(2, 2), m(2, 3), m(2, 4)};
+  EXPECT_EQ(block.Eval(), expected);
+
+  // Full width blocks are contiguous
+  static_assert(decltype(SubTensor<2, 6>(m, 3, 0))::isContiguous);
+  static_assert(!decltype(SubTensor<2, 3>(m, 1, 2))::isContiguous);
+
+  // Small products read the views in place
+  auto top = SubTensor<2, 3>(m, 0, 0);
+  auto left = SubTensor<3, 2>(m, 0, 0);
+  Matrix<double, 2, 3> topCopy = top;
+  Matrix<double, 3, 2> leftCopy = left;
+  EXPECT_EQ(Mul(top, left), Mul(topCopy, leftCopy));
+  EXPECT_EQ(Mul(top, leftCopy), Mul(topCopy, leftCopy));
+
+  // Larger ones through the blocked product with the row stride of the parent
+  Matrix<float, 24, 24> big;
+  for (size_t i = 0; i < 24 * 24; ++i) {
+    big[i] = static_cast<float>((i * 5) % 9) - 4.0f;
+  }
+  auto a = SubTensor<8, 16>(big, 2, 4);
+  auto b = SubTensor<16, 12>(big, 7, 1);
+  Matrix<float, 8, 16> aCopy = a;
+  Matrix<float, 16, 12> bCopy = b;
+  EXPECT_EQ(Mul(a, b), Mul(aCopy, bCopy));
+
+  // Strided rows are copied first
+  Tensor<float, 8, 8, 2> pairs;
+  for (size_t i = 0; i < 128; ++i) {
+    pairs[i] = static_cast<float>(i % 5);
+  }
+  auto even = Slice<2>(pairs, 0);
+  Matrix<float, 8, 8> evenCopy = even;
+  EXPECT_EQ(Mul(even, evenCopy), Mul(evenCopy, evenCopy));
+}
+
+TEST(Math, TensorView)
+{
+  Views();
+  SubTensors();
+}
\ No newline at end of file
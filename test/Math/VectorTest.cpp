@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <vector>
 
 #include "Vector.h"
 #include "TensorOperations.h"
@@ -242,6 +243,77 @@ static void VectorProperties()
   }
 }
 
+// Helper function to test lengths, normalization and constexpr products
+static void LengthAndNormalize()
+{
+  {
+    Vector<float, 3> v{3.0f, 4.0f, 0.0f};
+    EXPECT_EQ(Length(v), 5.0f);
+    EXPECT_TRUE(AreNearlyEqual(Normalize(v), Vector<float, 3>{0.6f, 0.8f, 0.0f}));
+  }
+
+  // Padded vectors work with the same functions
+  {
+    BasicTensor<double, PaddedTo<4>, 3> v(0.0, 0.0, 2.0);
+    EXPECT_EQ(Length(v), 2.0);
+    EXPECT_EQ(Normalize(v), (Vector<double, 3>{0.0, 0.0, 1.0}));
+    EXPECT_EQ(Dot(v, Vector<double, 3>{1.0, 1.0, 1.0}), 2.0);
+  }
+
+  {
+    constexpr Vector<int, 3> a{1, 2, 3};
+    constexpr Vector<int, 3> b{4, 5, 6};
+    static_assert(Dot(a, b) == 32);
+    static_assert(Cross(a, b) == Vector<int, 3>{-3, 6, -3});
+  }
+}
+
+// Helper function to test batch operations over arrays of vectors
+static void BatchOperations()
+{
+  // Sizes that leave a remainder after the packet blocks
+  constexpr size_t count = 37;
+  std::vector<Vector<float, 3>> a(count);
+  std::vector<Vector<float, 3>> b(count);
+  for (size_t i = 0; i < count; ++i) {
+    float x = static_cast<float>(i);
+    a[i] = Vector<float, 3>{x, 1.0f - x, 0.5f * x};
+    b[i] = Vector<float, 3>{2.0f, x, -1.0f};
+  }
+
+  std::vector<float> dots(count);
+  std::vector<float> lengths(count);
+  std::vector<Vector<float, 3>> cross(count);
+  std::vector<Vector<float, 3>> normalized(count);
+  DotBatch(a.data(), b.data(), count, dots.data());
+  LengthBatch(a.data(), count, lengths.data());
+  CrossBatch(a.data(), b.data(), count, cross.data());
+  NormalizeBatch(a.data(), count, normalized.data());
+
+  for (size_t i = 0; i < count; ++i) {
+    EXPECT_TRUE(AreScalarsNearlyEqual(dots[i], Dot(a[i], b[i]), 1e-4f));
+    EXPECT_TRUE(AreScalarsNearlyEqual(lengths[i], Length(a[i]), 1e-4f));
+    EXPECT_TRUE(AreNearlyEqual(cross[i], Cross(a[i], b[i])));
+    EXPECT_TRUE(AreNearlyEqual(normalized[i], Normalize(a[i])));
+  }
+
+  // In place, on doubles and on integers
+  {
+    std::vector<Vector<double, 2>> v(9, Vector<double, 2>{3.0, 4.0});
+    NormalizeBatch(v.data(), v.size(), v.data());
+    for (const auto& n : v) {
+      EXPECT_TRUE(AreNearlyEqual(n, Vector<double, 2>{0.6, 0.8}));
+    }
+
+    std::vector<Vector<int, 4>> u(11, Vector<int, 4>{1, 2, 3, 4});
+    std::vector<int> products(11);
+    DotBatch(u.data(), u.data(), u.size(), products.data());
+    for (int p : products) {
+      EXPECT_EQ(p, 30);
+    }
+  }
+}
+
 // Helper function to test edge cases and special vectors
 static void EdgeCases()
 {
@@ -399,6 +471,8 @@ TEST(Math, Vector)
   DotProduct();
   CrossProduct();
   VectorProperties();
+  LengthAndNormalize();
+  BatchOperations();
   EdgeCases();
   TypeConversions();
   ComprehensiveOperations();